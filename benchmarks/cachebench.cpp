@@ -0,0 +1,271 @@
+/**
+ * Microbenchmark for the answer cache and the external atoms which access cached answers: measures the lookup of calls and indices
+ * (HexAnswerCache::operator[]) for growing numbers of cache entries, and &answersets, &predicates and &arguments for growing
+ * answer-sets. Additionally measures the creation of the plugin atoms at load time (compared to the former creation of all per-arity
+ * atoms) and the pass of AtomScanner over programs with growing numbers of rules. Reports the time and the number of heap allocations
+ * per operation.
+ *
+ * usage: cachebench [cache sizes] [atoms per answer-set and rules per scanned program] [seconds per measurement]
+ *   e.g. cachebench 10,100,1000,10000,100000 10,1000,100000,1000000 0.2
+ */
+
+#include <HexAnswerCache.h>
+#include <HexExecution.h>
+#include <DynamicAtoms.h>
+#include <Operators.h>
+
+#include <dlvhex2/ProgramCtx.h>
+#include <dlvhex2/Registry.h>
+#include <dlvhex2/Interpretation.h>
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cstdlib>
+#include <new>
+#include <sys/time.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+// every allocation of this process passes here
+static long allocations = 0;
+
+void* operator new(std::size_t size) throw (std::bad_alloc){
+	allocations++;
+	void* p = malloc(size > 0 ? size : 1);
+	if (!p) throw std::bad_alloc();
+	return p;
+}
+
+void* operator new[](std::size_t size) throw (std::bad_alloc){
+	return operator new(size);
+}
+
+void operator delete(void* p) throw (){
+	free(p);
+}
+
+void operator delete[](void* p) throw (){
+	free(p);
+}
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static std::vector<int> parseList(const char* arg){
+	std::vector<int> list;
+	std::stringstream ss(arg);
+	std::string item;
+	while (std::getline(ss, item, ',')) list.push_back(atoi(item.c_str()));
+	return list;
+}
+
+// the operation to measure
+struct Operation{
+	virtual ~Operation(){}
+	virtual void run(int i) = 0;
+};
+
+static void report(const std::string& name, int entries, int atoms, Operation& op, double seconds){
+	// at least one operation; afterwards double the count until the time is reached
+	long count = 0;
+	long batch = 1;
+	long allocated = 0;
+	double time = 0;
+	while (time < seconds){
+		long before = allocations;
+		double start = now();
+		for (long i = 0; i < batch; i++) op.run((int)(count + i));
+		time += now() - start;
+		allocated += allocations - before;
+		count += batch;
+		batch *= 2;
+	}
+
+	std::cout << std::left << std::setw(22) << name << std::right << std::setw(10) << entries << std::setw(10) << atoms
+		  << std::fixed << std::setprecision(1) << std::setw(14) << (time * 1e9 / count) << std::setw(12) << ((double)allocated / count) << std::endl;
+}
+
+// an answer-set with the given number of atoms over 10 unary predicates
+static InterpretationPtr createAnswerSet(RegistryPtr reg, int atoms, std::vector<ID>& predicates){
+	for (int p = predicates.size(); p < 10; p++){
+		std::stringstream name;
+		name << "p" << p;
+		predicates.push_back(reg->storeConstantTerm(name.str()));
+	}
+
+	InterpretationPtr intr(new Interpretation(reg));
+	for (int a = 0; a < atoms; a++){
+		std::stringstream constant;
+		constant << "c" << a;
+		OrdinaryAtom atom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+		atom.tuple.push_back(predicates[a % predicates.size()]);
+		atom.tuple.push_back(reg->storeConstantTerm(constant.str()));
+		std::stringstream text;
+		text << "p" << (a % predicates.size()) << "(" << constant.str() << ")";
+		atom.text = text.str();
+		intr->setFact(reg->storeOrdinaryGAtom(atom).address);
+	}
+	return intr;
+}
+
+static HexCall createCall(RegistryPtr reg, int i){
+	std::stringstream program;
+	program << "a(" << i << ").";
+	return HexCall(HexCall::HexProgram, program.str(), "", InterpretationPtr(new Interpretation(reg)));
+}
+
+// cache with the given number of entries, each with a single small answer-set
+static void populate(HexAnswerCache& cache, RegistryPtr reg, int entries, InterpretationPtr answerset){
+	for (int i = cache.size(); i < entries; i++){
+		HexAnswer* answer = new HexAnswer();
+		answer->push_back(answerset);
+		cache.insert(createCall(reg, i), answer);
+	}
+}
+
+struct LookupCall : public Operation{
+	HexAnswerCache& cache;
+	std::vector<HexCall> calls;
+	LookupCall(HexAnswerCache& c, RegistryPtr reg, int entries) : cache(c){
+		// spread the lookups over the whole cache
+		for (int i = 0; i < 64; i++) calls.push_back(createCall(reg, (int)((long)entries * i / 64)));
+	}
+	void run(int i){ cache[calls[i % calls.size()]]; }
+};
+
+struct LookupIndex : public Operation{
+	HexAnswerCache& cache;
+	int entries;
+	LookupIndex(HexAnswerCache& c, int e) : cache(c), entries(e){}
+	void run(int i){ cache[(int)((long)i * 7919 % entries)]; }
+};
+
+struct AtomQuery : public Operation{
+	PluginAtom& atom;
+	PluginAtom::Query query;
+	long results;
+	AtomQuery(PluginAtom& a, InterpretationConstPtr intr, const Tuple& input) : atom(a), query(intr, input, Tuple()), results(0){}
+	void run(int i){
+		PluginAtom::Answer answer;
+		atom.retrieve(query, answer);
+		results += answer.get().size();
+	}
+};
+
+// the atoms created when the plugin is loaded (see MergingPlugin::createAtoms); eager additionally creates the per-arity atoms up to
+// the limits which were used before they were registered on demand (32 call arities, 5 simulator arities)
+struct CreateAtoms : public Operation{
+	HexAnswerCache& cache;
+	ProgramCtx& ctx;
+	bool eager;
+	CreateAtoms(HexAnswerCache& c, ProgramCtx& x, bool e) : cache(c), ctx(x), eager(e){}
+	void run(int i){
+		std::vector<PluginAtomPtr> atoms;
+		atoms.push_back(PluginAtomPtr(new HexAtom(cache)));
+		atoms.push_back(PluginAtomPtr(new HexFileAtom(cache)));
+		if (eager){
+			for (int ar = 0; ar < 32; ar++){
+				atoms.push_back(PluginAtomPtr(new CallHexAtom(cache, ar)));
+				atoms.push_back(PluginAtomPtr(new CallHexFileAtom(cache, ar)));
+			}
+			for (int in = 0; in <= 5; in++){
+				for (int out = 0; out <= 5; out++) atoms.push_back(PluginAtomPtr(new SimulatorAtom(ctx, in, out)));
+			}
+		}
+		atoms.push_back(PluginAtomPtr(new AnswerSetsAtom(cache)));
+		atoms.push_back(PluginAtomPtr(new PredicatesAtom(cache)));
+		atoms.push_back(PluginAtomPtr(new ArgumentsAtom(cache)));
+		atoms.push_back(PluginAtomPtr(new OperatorAtom(cache)));
+	}
+};
+
+// passes a program through AtomScanner (without inner converter); every tenth rule references one of a few per-arity atoms
+struct ScanProgram : public Operation{
+	AtomScanner scanner;
+	std::string program;
+	ScanProgram(DynamicAtoms& atoms, int rules) : scanner(PluginConverterPtr(), atoms){
+		std::stringstream ss;
+		for (int r = 0; r < rules; r++){
+			if (r % 10 == 0) ss << "q" << r << "(X) :- &callhex" << (r / 10 % 4) << "[\"a.\", p](X)." << std::endl;
+			else ss << "q" << r << "(X) :- p(X), &hex[\"a.\", \"\"](X)." << std::endl;
+		}
+		program = ss.str();
+	}
+	void run(int i){
+		std::istringstream in(program);
+		std::stringstream out;
+		scanner.convert(in, out);
+	}
+};
+
+int main(int argc, char** argv){
+	std::vector<int> cacheSizes = parseList(argc > 1 ? argv[1] : "10,100,1000,10000,100000");
+	std::vector<int> atomCounts = parseList(argc > 2 ? argv[2] : "10,1000,100000,1000000");
+	double seconds = argc > 3 ? atof(argv[3]) : 0.2;
+
+	ProgramCtx ctx;
+	ctx.changeRegistry(RegistryPtr(new Registry()));
+	RegistryPtr reg = ctx.registry();
+	InterpretationPtr empty(new Interpretation(reg));
+
+	std::cout << std::left << std::setw(22) << "operation" << std::right << std::setw(10) << "entries" << std::setw(10) << "atoms"
+		  << std::setw(14) << "ns/op" << std::setw(12) << "allocs/op" << std::endl;
+
+	// lookups for growing caches (the cache grows from one size to the next)
+	std::vector<ID> predicates;
+	InterpretationPtr small = createAnswerSet(reg, 10, predicates);
+	HexAnswerCache cache;
+	cache.setProgramCtx(ctx);
+	for (std::vector<int>::iterator size = cacheSizes.begin(); size != cacheSizes.end(); ++size){
+		populate(cache, reg, *size, small);
+		LookupCall call(cache, reg, *size);
+		report("operator[](HexCall)", *size, 10, call, seconds);
+		LookupIndex index(cache, *size);
+		report("operator[](int)", *size, 10, index, seconds);
+	}
+
+	// atoms for growing answer-sets (in a small cache)
+	HexAnswerCache atomCache;
+	atomCache.setProgramCtx(ctx);
+	AnswerSetsAtom answersetsAtom(atomCache);
+	PredicatesAtom predicatesAtom(atomCache);
+	ArgumentsAtom argumentsAtom(atomCache);
+	for (std::vector<int>::iterator atoms = atomCounts.begin(); atoms != atomCounts.end(); ++atoms){
+		HexAnswer* answer = new HexAnswer();
+		answer->push_back(createAnswerSet(reg, *atoms, predicates));
+		int index = atomCache.insert(createCall(reg, -1 - *atoms), answer);
+
+		Tuple input;
+		input.push_back(ID::termFromInteger(index));
+		AtomQuery answersets(answersetsAtom, empty, input);
+		report("&answersets", atomCache.size(), *atoms, answersets, seconds);
+
+		input.push_back(ID::termFromInteger(0));
+		AtomQuery predicatesQuery(predicatesAtom, empty, input);
+		report("&predicates", atomCache.size(), *atoms, predicatesQuery, seconds);
+
+		input.push_back(predicates[0]);
+		AtomQuery arguments(argumentsAtom, empty, input);
+		report("&arguments", atomCache.size(), *atoms, arguments, seconds);
+	}
+
+	// plugin loading: number of created atoms
+	CreateAtoms onDemand(atomCache, ctx, false);
+	report("createAtoms", atomCache.size(), 6, onDemand, seconds);
+	CreateAtoms eager(atomCache, ctx, true);
+	report("createAtoms (eager)", atomCache.size(), 106, eager, seconds);
+
+	// scanning the input for growing numbers of rules
+	DynamicAtoms dynamicAtoms(atomCache);
+	dynamicAtoms.setProgramCtx(ctx);
+	for (std::vector<int>::iterator rules = atomCounts.begin(); rules != atomCounts.end(); ++rules){
+		ScanProgram scan(dynamicAtoms, *rules);
+		report("AtomScanner", atomCache.size(), *rules, scan, seconds);
+	}
+	return 0;
+}
@@ -0,0 +1,61 @@
+#!/bin/bash
+
+#
+# Regression benchmark for the post-processing of the dalal operator's ASP encoding (removal of non-optimal and duplicate answer-sets).
+# Two belief bases disagree on every atom, thus each of the 2^N decisions is optimal; an ignored atom doubles the models reported by
+# the solver, such that each optimal answer-set occurs twice before duplicate elimination.
+#
+# usage: dalalmodels.sh [number of atoms N (default 14, i.e. 16384 optimal models)] [solver] [additional dlvhex parameters]
+#
+
+N=${1:-14}
+SOLVER=${2:-dlv}
+shift; [ $# -gt 0 ] && shift
+DLVHEX=${DLVHEX:-dlvhex2}
+PARAMS="--silent $*"
+
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+positive=""
+negative=""
+signature=""
+for (( i=0; i<$N; i++ ))
+do
+	positive="$positive a$i."
+	negative="$negative -a$i."
+	signature="${signature}predicate: a$i/0;
+"
+done
+
+cat > $TMPDIR/models.mp <<EOP
+[common signature]
+${signature}predicate: x/0;
+
+[belief base]
+name: bb1;
+mapping: "$positive x.";
+
+[belief base]
+name: bb2;
+mapping: "$negative";
+
+[merging plan]
+{
+	operator: dalal;
+	ignore: "x";
+	solver: "$SOLVER";
+	{bb1};
+	{bb2};
+}
+EOP
+
+now(){
+	date +%s.%N
+}
+
+echo "Merging two belief bases with $N conflicting atoms (solver $SOLVER)"
+start=$(now)
+$DLVHEX $PARAMS --merging $TMPDIR/models.mp > $TMPDIR/models.out || { echo "dlvhex failed"; exit 1; }
+echo "  time:    $(echo "$(now) - $start" | bc) s"
+echo "  answers: $(wc -l < $TMPDIR/models.out) (expected $(( 1 << $N )))"
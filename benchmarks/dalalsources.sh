@@ -0,0 +1,79 @@
+#!/bin/bash
+
+#
+# Compares the solver backends of the dalal operator (see also examples/dalal*.mp):
+#   solver: "native"    computes the result by branch-and-bound without ASP solver
+#   solver: "dlv"       spawns an external dlv process per operator application
+#   solver: "internal"  solves the merging program within dlvhex (internal grounder and solver)
+#
+# usage: dalalsources.sh [numbers of belief bases] [additional dlvhex parameters]
+#   e.g. dalalsources.sh "10 50 100 200"
+# The backends to compare can be selected by SOLVERS (default: "native dlv internal").
+#
+
+COUNTS=${1:-50}
+shift 1
+DLVHEX=${DLVHEX:-dlvhex2}
+SOLVERS=${SOLVERS:-native dlv internal}
+PARAMS="--silent $*"
+
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+# generate a merging plan over N belief bases with conflicting beliefs in the style of the dalal examples
+genplan(){
+	echo "[common signature]"
+	echo "predicate: a/0;"
+	echo "predicate: b/0;"
+	echo "predicate: c/0;"
+	echo "predicate: p/1;"
+	echo ""
+	for (( i=0; i<$1; i++ ))
+	do
+		case $(( $i % 4 )) in
+			0) m="a. p(x).";;
+			1) m="-a. -p(x).";;
+			2) m="b v c. -a.";;
+			3) m="a :- b. c. p(y).";;
+		esac
+		echo "[belief base]"
+		echo "name: bb$i;"
+		echo "mapping: \"$m\";"
+		echo ""
+	done
+	echo "[merging plan]"
+	echo "{"
+	echo "	operator: dalal;"
+	echo "	aggregate: \"sum\";"
+	echo "	solver: \"$2\";"
+	for (( i=0; i<$1; i++ ))
+	do
+		echo "	{bb$i};"
+	done
+	echo "}"
+}
+
+now(){
+	date +%s.%N
+}
+
+for N in $COUNTS
+do
+	echo "Merging $N belief bases with the dalal operator"
+	reference=""
+	for solver in $SOLVERS
+	do
+		genplan $N $solver > $TMPDIR/$solver.mp
+		start=$(now)
+		$DLVHEX $PARAMS --merging $TMPDIR/$solver.mp > $TMPDIR/$solver.out || { echo "dlvhex failed with solver $solver"; exit 1; }
+		printf "  solver %-9s %s s\n" "$solver:" $(echo "$(now) - $start" | bc)
+
+		# all backends must compute the same result
+		if [ "$reference" == "" ]; then
+			reference=$solver
+		elif ! cmp -s <(sort $TMPDIR/$reference.out) <(sort $TMPDIR/$solver.out); then
+			echo "  WARNING: solvers $reference and $solver computed different results"
+			exit 1
+		fi
+	done
+done
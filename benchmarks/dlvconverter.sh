@@ -0,0 +1,45 @@
+#!/bin/bash
+
+#
+# Measures the post-processing of dlv output by the --dlv converter.
+# A fake dlv on the PATH prints synthetic diagnosis output of the given sizes;
+# the time of a dlvhex run therefore consists almost only of the translation.
+#
+# usage: dlvconverter.sh [number of diagnoses ...]    (default: 100000 1000000 10000000)
+#
+
+SIZES=${*:-100000 1000000 10000000}
+DLVHEX=${DLVHEX:-dlvhex2}
+
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+cat > $TMPDIR/dlv <<EOS
+#!/bin/bash
+cat $TMPDIR/output.txt
+EOS
+chmod +x $TMPDIR/dlv
+echo "a." > $TMPDIR/input.dl
+
+now(){
+	date +%s.%N
+}
+
+for n in $SIZES
+do
+	# every diagnosis consists of three abnormal components, every tenth line is meta output
+	awk -v n=$n 'BEGIN {
+		for (i = 0; i < n; i++){
+			if (i % 10 == 0) print "Cost ([Weight:Level]): <" i ":1>";
+			print "Diagnosis: ab(c" i ") ab(d" i ") ab(e" i ")";
+		}
+	}' > $TMPDIR/output.txt
+	mb=$(( $(stat -c %s $TMPDIR/output.txt) / 1048576 ))
+
+	start=$(now)
+	PATH=$TMPDIR:$PATH $DLVHEX --silent --dlv $TMPDIR/input.dl > $TMPDIR/result.txt || { echo "dlvhex failed"; exit 1; }
+	time=$(echo "$(now) - $start" | bc)
+	lines=$(wc -l < $TMPDIR/result.txt)
+
+	echo "$n diagnoses ($mb MB): $time s, $lines answer-sets"
+done
@@ -0,0 +1,73 @@
+/**
+ * Microbenchmark for the DistanceKernel: checks that all implementations supported by this CPU compute the same counts and reports
+ * their throughput in GB/s (bytes of the four input bitsets per second).
+ *
+ * usage: kernelbench [number of atoms] [iterations]
+ */
+
+#include <DistanceKernel.h>
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cstring>
+#include <sys/time.h>
+
+using namespace dlvhex::merging::plugin;
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static void randomAnswerSet(int atomCount, DistanceKernel::Bitset& pos, DistanceKernel::Bitset& neg){
+	pos.assign(DistanceKernel::blockCount(atomCount), 0);
+	neg.assign(DistanceKernel::blockCount(atomCount), 0);
+	for (int atom = 0; atom < atomCount; atom++){
+		switch (rand() % 3){
+			case 0: DistanceKernel::set(pos, atom); break;
+			case 1: DistanceKernel::set(neg, atom); break;
+		}
+	}
+}
+
+int main(int argc, char** argv){
+	int atomCount = argc > 1 ? atoi(argv[1]) : 100000;
+	int iterations = argc > 2 ? atoi(argv[2]) : 10000;
+	int blocks = DistanceKernel::blockCount(atomCount);
+
+	srand(42);
+	DistanceKernel::Bitset p, n, gp, gn;
+	randomAnswerSet(atomCount, p, n);
+	randomAnswerSet(atomCount, gp, gn);
+
+	DistanceKernel::setImplementation("generic");
+	int reference[4][4];
+	DistanceKernel::countDifferences(&p[0], &n[0], &gp[0], &gn[0], blocks, atomCount, reference);
+
+	std::cout << atomCount << " atoms, " << iterations << " iterations" << std::endl;
+	std::vector<std::string> implementations = DistanceKernel::getImplementations();
+	int ret = 0;
+	for (int i = 0; i < implementations.size(); i++){
+		DistanceKernel::setImplementation(implementations[i]);
+
+		int counts[4][4];
+		DistanceKernel::countDifferences(&p[0], &n[0], &gp[0], &gn[0], blocks, atomCount, counts);
+		bool correct = memcmp(counts, reference, sizeof(counts)) == 0;
+		if (!correct) ret = 1;
+
+		double start = now();
+		long checksum = 0;
+		for (int it = 0; it < iterations; it++){
+			DistanceKernel::countDifferences(&p[0], &n[0], &gp[0], &gn[0], blocks, atomCount, counts);
+			checksum += counts[0][0];
+		}
+		double time = now() - start;
+		double gbytes = 4.0 * blocks * sizeof(DistanceKernel::Block) * iterations / 1e9;
+
+		std::cout << "  " << std::setw(8) << std::left << implementations[i] << std::right << std::fixed << std::setprecision(2) << std::setw(8) << (gbytes / time) << " GB/s"
+			  << (correct ? "" : "  WRONG RESULT") << (checksum < 0 ? " " : "") << std::endl;
+	}
+	return ret;
+}
@@ -0,0 +1,212 @@
+#!/bin/bash
+
+#
+# Scaling benchmark for the built-in merging operators on synthetic belief bases.
+# For each combination of the generator parameters and each operator, a merging plan is generated and evaluated twice with the
+# same persistent operator cache (see --operatorcache): once cold (empty cache) and once warm. Each run is recorded as one
+# JSON object per line:
+#   {"operator": ..., "sources": ..., "answersets": ..., "atoms": ..., "predicates": ..., "overlap": ...,
+#    "cache": "cold"|"warm", "status": "ok"|"failed", "seconds": ..., "maxrss_kb": ..., "answers": ...}
+# maxrss_kb is null if GNU time is not available.
+# Operators which are not registered in the plugin under test are not run; they are reported once with "status": "skipped".
+# If the cold run fails, the warm run is not recorded since it would fail for the same reason.
+#
+# usage: mergebench.sh [report file] [additional dlvhex parameters]
+#   e.g. SOURCES="2 4 8 16" OPERATORS="union dalal" mergebench.sh report.json
+# Generator parameters (each may be a list; all combinations are run):
+#   SOURCES     number of belief bases (default: "2 4 8")
+#   ANSWERSETS  answer-sets per belief base (default: 2)
+#   ATOMS       atoms per answer-set; for relationmerging: rows per source (default: 20)
+#   PREDICATES  number of unary predicates the atoms are distributed over (default: 4)
+#   OVERLAP     ratio of atoms which occur in all belief bases (default: 0.5); every 5th of them is negated in some
+#               belief bases, such that the sources are conflicting
+# OPERATORS selects the operators (default: "union setminus intersection majorityselection dalal dbo relationmerging").
+#
+
+REPORT=${1:-/dev/stdout}
+shift 1
+DLVHEX=${DLVHEX:-dlvhex2}
+SOURCES=${SOURCES:-2 4 8}
+ANSWERSETS=${ANSWERSETS:-2}
+ATOMS=${ATOMS:-20}
+PREDICATES=${PREDICATES:-4}
+OVERLAP=${OVERLAP:-0.5}
+OPERATORS=${OPERATORS:-union setminus intersection majorityselection dalal dbo relationmerging}
+PARAMS="--silent $*"
+
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+# mapping of belief base $1: $2 answer-sets (selected by a disjunction over s/1) of $3 atoms over $4 predicates,
+# the first $5 * $3 atoms of each answer-set are shared by all belief bases
+genmapping(){
+	awk -v bb=$1 -v sets=$2 -v atoms=$3 -v preds=$4 -v overlap=$5 'BEGIN {
+		shared = int(overlap * atoms + 0.5)
+		if (sets > 1){
+			for (k = 0; k < sets; k++) printf "%ss(%d)", (k > 0 ? " v " : ""), k
+			printf ". "
+		}
+		for (k = 0; k < sets; k++){
+			for (j = 0; j < atoms; j++){
+				if (j < shared){
+					atom = sprintf("p%d(c%d_%d)", j % preds, k, j)
+					if ((bb + j) % 5 == 0) atom = "-" atom
+				}else{
+					atom = sprintf("p%d(u%d_%d_%d)", j % preds, bb, k, j)
+				}
+				printf "%s%s ", atom, (sets > 1 ? sprintf(" :- s(%d).", k) : ".")
+			}
+		}
+	}'
+}
+
+# relation of source $1 with $2 rows: the first $3 * $2 keys occur in all sources, every 5th shared value of v0 is contradicting
+genrelation(){
+	awk -v src=$1 -v rows=$2 -v overlap=$3 'BEGIN {
+		shared = int(overlap * rows + 0.5)
+		printf "schema(id, v0, v%d). ", src + 1
+		for (r = 0; r < rows; r++){
+			if (r < shared){
+				printf "data(k%d, %d, %d). ", r, (r % 5 == 0 ? src : 0), r * 7 + src
+			}else{
+				printf "data(k%d_%d, %d, %d). ", src, r, 0, r * 7 + src
+			}
+		}
+	}'
+}
+
+# merging plan for operator $1 over $2 belief bases
+genplan(){
+	op=$1
+	n=$2
+	echo "[common signature]"
+	if [ "$op" == "relationmerging" ]; then
+		echo "predicate: schema/$(( $n + 2 ));"
+		echo "predicate: data/$(( $n + 2 ));"
+	else
+		echo "predicate: s/1;"
+		for (( p=0; p<$PREDS; p++ ))
+		do
+			echo "predicate: p$p/1;"
+		done
+	fi
+	echo ""
+	for (( i=0; i<$n; i++ ))
+	do
+		echo "[belief base]"
+		echo "name: bb$i;"
+		if [ "$op" == "relationmerging" ]; then
+			echo "mapping: \"$(genrelation $i $NATOMS $OVL)\";"
+		else
+			echo "mapping: \"$(genmapping $i $NSETS $NATOMS $PREDS $OVL)\";"
+		fi
+		echo ""
+	done
+
+	# setminus takes two arguments, majorityselection one (the union of all sources)
+	args=$n
+	[ "$op" == "setminus" ] && args=2
+	echo "[merging plan]"
+	echo "{"
+	echo "	operator: $op;"
+	case $op in
+		majorityselection)
+			for (( p=0; p<$PREDS; p++ ))
+			do
+				echo "	majorityOf: \"p$p\";"
+			done
+			echo "	{"
+			echo "		operator: union;"
+			for (( i=0; i<$n; i++ ))
+			do
+				echo "		{bb$i};"
+			done
+			echo "	};"
+			args=0
+			;;
+		dalal|dbo)
+			echo "	aggregate: \"sum\";"
+			;;
+		relationmerging)
+			schema="id"
+			for (( i=0; i<=$n; i++ ))
+			do
+				schema="$schema,v$i"
+			done
+			echo "	schema: \"$schema\";"
+			echo "	key: \"id\";"
+			;;
+	esac
+	for (( i=0; i<$args; i++ ))
+	do
+		echo "	{bb$i};"
+	done
+	echo "}"
+}
+
+now(){
+	date +%s.%N
+}
+
+# succeeds if the operator $1 is registered (built-in or found in the operator path)
+registered(){
+	echo "a." > $TMPDIR/registered.hex
+	$DLVHEX $PARAMS --operatorinfo=$1 $TMPDIR/registered.hex > /dev/null 2>&1
+}
+
+# runs the plan $1 with the cache directory $2 and prints: status seconds maxrss answers
+run(){
+	if /usr/bin/time -f "%e %M" -o $TMPDIR/time true 2> /dev/null; then
+		/usr/bin/time -f "%e %M" -o $TMPDIR/time $DLVHEX $PARAMS --operatorcache=$2 --merging $1 > $TMPDIR/out 2> $TMPDIR/err
+		status=$?
+		read seconds rss < <(tail -n 1 $TMPDIR/time)
+	else
+		start=$(now)
+		$DLVHEX $PARAMS --operatorcache=$2 --merging $1 > $TMPDIR/out 2> $TMPDIR/err
+		status=$?
+		seconds=$(awk -v start=$start -v end=$(now) 'BEGIN { printf "%.3f", end - start }')
+		rss=null
+	fi
+	[ $status -eq 0 ] && status=ok || status=failed
+	echo "$status $seconds $rss $(grep -c '^{' $TMPDIR/out)"
+}
+
+AVAILABLE=""
+for op in $OPERATORS
+do
+	if registered $op; then
+		AVAILABLE="$AVAILABLE $op"
+	else
+		echo "skipping operator $op: not registered" >&2
+		printf '{"operator": "%s", "status": "skipped"}\n' $op >> $REPORT
+	fi
+done
+
+for NSRC in $SOURCES
+do
+	for NSETS in $ANSWERSETS
+	do
+		for NATOMS in $ATOMS
+		do
+			for PREDS in $PREDICATES
+			do
+				for OVL in $OVERLAP
+				do
+					for op in $AVAILABLE
+					do
+						[ "$op" == "setminus" ] && [ $NSRC -lt 2 ] && continue
+						genplan $op $NSRC > $TMPDIR/plan.mp
+						rm -rf $TMPDIR/cache
+						for cache in cold warm
+						do
+							read status seconds rss answers < <(run $TMPDIR/plan.mp $TMPDIR/cache)
+							printf '{"operator": "%s", "sources": %d, "answersets": %d, "atoms": %d, "predicates": %d, "overlap": %s, "cache": "%s", "status": "%s", "seconds": %s, "maxrss_kb": %s, "answers": %d}\n' \
+								$op $NSRC $NSETS $NATOMS $PREDS $OVL $cache $status $seconds $rss $answers >> $REPORT
+							[ "$status" == "failed" ] && break
+						done
+					done
+				done
+			done
+		done
+	done
+done
@@ -0,0 +1,95 @@
+#!/bin/bash
+
+#
+# Compares the evaluation paths of the relationmerging operator (see also examples/relationmerging*.mp):
+#   native  joins the sources by a hash table on the key (used if no "rule" parameter is passed)
+#   asp     solves the merging program; enforced by passing a rule which does not derive any attribute values
+#
+# usage: relationmerging.sh [numbers of rows per source] [additional dlvhex parameters]
+#   e.g. relationmerging.sh "1000 10000 1000000"
+# The number of sources is given by SOURCES (default: 5), the paths to compare by PATHS (default: "native asp").
+#
+
+ROWS=${1:-1000000}
+shift 1
+DLVHEX=${DLVHEX:-dlvhex2}
+SOURCES=${SOURCES:-5}
+PATHS=${PATHS:-native asp}
+PARAMS="--silent $*"
+
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+# generate a source with N rows: all sources share the key "id" and the attribute "v0" (every 1000th value is contradicting),
+# source i > 0 additionally provides the attribute "vi"
+gensource(){
+	if [ $1 -eq 0 ]; then
+		echo "schema(id, v0)."
+		awk -v n=$2 'BEGIN { for (r = 0; r < n; r++) printf "data(%d, %d).\n", r, (r % 1000 == 0 ? 1 : 0) }'
+	else
+		echo "schema(id, v0, v$1)."
+		awk -v n=$2 -v s=$1 'BEGIN { for (r = 0; r < n; r++) printf "data(%d, %d, %d).\n", r, (r % 1000 == 0 ? s + 1 : 0), r * 7 + s }'
+	fi
+}
+
+genplan(){
+	schema="id"
+	for (( i=0; i<$SOURCES; i++ ))
+	do
+		schema="$schema,v$i"
+	done
+	echo "[common signature]"
+	echo "predicate: schema/$(( $SOURCES + 1 ));"
+	echo "predicate: data/$(( $SOURCES + 1 ));"
+	echo ""
+	for (( i=0; i<$SOURCES; i++ ))
+	do
+		echo "[belief base]"
+		echo "name: source$i;"
+		echo "source: \"$TMPDIR/source$i.hex\";"
+		echo ""
+	done
+	echo "[merging plan]"
+	echo "{"
+	echo "	operator: relationmerging;"
+	echo "	schema: \"$schema\";"
+	echo "	key: \"id\";"
+	if [ "$1" == "asp" ]; then
+		echo "	rule: \"v0(merged, K, V) :- v0(merged, K, V), v0(0, K, V).\";"
+	fi
+	for (( i=0; i<$SOURCES; i++ ))
+	do
+		echo "	{source$i};"
+	done
+	echo "}"
+}
+
+now(){
+	date +%s.%N
+}
+
+for N in $ROWS
+do
+	echo "Merging $SOURCES relations with $N rows each"
+	for (( i=0; i<$SOURCES; i++ ))
+	do
+		gensource $i $N > $TMPDIR/source$i.hex
+	done
+
+	reference=""
+	for path in $PATHS
+	do
+		genplan $path > $TMPDIR/$path.mp
+		start=$(now)
+		$DLVHEX $PARAMS --merging $TMPDIR/$path.mp > $TMPDIR/$path.out || { echo "dlvhex failed with path $path"; exit 1; }
+		printf "  path %-7s %s s\n" "$path:" $(echo "$(now) - $start" | bc)
+
+		# both paths must compute the same result
+		if [ "$reference" == "" ]; then
+			reference=$path
+		elif ! cmp -s <(sort $TMPDIR/$reference.out) <(sort $TMPDIR/$path.out); then
+			echo "  WARNING: paths $reference and $path computed different results"
+			exit 1
+		fi
+	done
+done
@@ -0,0 +1,36 @@
+#!/bin/bash
+
+#
+# Measures the throughput of the input rewriter pipeline (--irw): programs of the given sizes
+# are passed through cat, and it is checked that they arrive unchanged.
+# The program consists of comment lines and a single fact at the very end.
+#
+# usage: rewriter.sh [sizes in MB ...]    (default: 100 500)
+#
+
+SIZES=${*:-100 500}
+DLVHEX=${DLVHEX:-dlvhex2}
+
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+now(){
+	date +%s.%N
+}
+
+for size in $SIZES
+do
+	yes "% this line is just padding for the rewriter benchmark, it does not contain any rules" | head -c ${size}M > $TMPDIR/program.hex
+	echo "" >> $TMPDIR/program.hex
+	echo "a." >> $TMPDIR/program.hex
+
+	start=$(now)
+	$DLVHEX --silent --irw=cat $TMPDIR/program.hex > $TMPDIR/result.txt || { echo "dlvhex failed"; exit 1; }
+	time=$(echo "$(now) - $start" | bc)
+	if [ "$(cat $TMPDIR/result.txt)" != "{a}" ]; then
+		echo "$size MB: wrong result"
+		exit 1
+	fi
+
+	echo "$size MB: $time s, $(echo "$size / $time" | bc) MB/s"
+done
@@ -0,0 +1,57 @@
+#!/bin/bash
+
+#
+# Compares the evaluation of many tiny subprograms
+#   (1) by spawning a fresh dlvhex process for each of them and
+#   (2) by calling them as nested programs from a single dlvhex instance
+#       which evaluates them in a pool of solver processes (--workerpool)
+#
+# usage: subprogramsolving.sh [number of programs] [pool size] [additional dlvhex parameters]
+#
+
+N=${1:-1000}
+POOLSIZE=${2:-4}
+shift; [ $# -gt 0 ] && shift
+DLVHEX=${DLVHEX:-dlvhex2}
+PARAMS="--silent $*"
+
+TMPDIR=$(mktemp -d)
+trap "rm -rf $TMPDIR" EXIT
+
+# generate the subprograms: each one is distinct (such that the answer cache does not hit) but trivial
+for (( i=0; i<$N; i++ ))
+do
+	echo "p($i). q(X) :- p(X). r($i) v s($i)." > $TMPDIR/prog$i.hex
+done
+
+# generate a program calling all subprograms
+for (( i=0; i<$N; i++ ))
+do
+	echo "call$i(A) :- &hexfile[\"$TMPDIR/prog$i.hex\", \"\"](A)."
+done > $TMPDIR/caller.hex
+
+now(){
+	date +%s.%N
+}
+
+echo "Solving $N subprograms"
+
+start=$(now)
+for (( i=0; i<$N; i++ ))
+do
+	$DLVHEX $PARAMS $TMPDIR/prog$i.hex > /dev/null || { echo "dlvhex failed on prog$i.hex"; exit 1; }
+done
+spawntime=$(echo "$(now) - $start" | bc)
+echo "  fresh processes:          $spawntime s"
+
+start=$(now)
+$DLVHEX $PARAMS $TMPDIR/caller.hex > /dev/null || { echo "dlvhex failed on caller.hex"; exit 1; }
+inprocesstime=$(echo "$(now) - $start" | bc)
+echo "  nested, in-process:       $inprocesstime s"
+
+start=$(now)
+$DLVHEX $PARAMS --workerpool=$POOLSIZE $TMPDIR/caller.hex > /dev/null || { echo "dlvhex failed on caller.hex"; exit 1; }
+pooltime=$(echo "$(now) - $start" | bc)
+echo "  nested, $POOLSIZE pooled workers: $pooltime s"
+
+echo "  speedup (fresh / pool):   $(echo "scale=2; $spawntime / $pooltime" | bc)"
@@ -372,6 +372,18 @@ function checkMPCompiler {
 	fi
 }
 
+# evaluates the merging plan $1 and prints its answer-sets; further arguments are passed to dlvhex
+# if DLVHEXPARAMETERS contains --merging, dlvhex translates the plan itself, otherwise it is compiled by the mpcompiler first
+function runMergingPlan {
+	plan=$1
+	shift
+	if [[ " $DLVHEXPARAMETERS " == *" --merging "* ]]; then
+		$DLVHEX --silent $DLVHEXPARAMETERS "$@" $plan
+	else
+		$MPCOMPILER < $plan | $DLVHEX --silent $DLVHEXPARAMETERS "$@" --
+	fi
+}
+
 function compare {
 
 	# default values
@@ -546,7 +558,7 @@ function compare {
 			fi
 			case "$nonerrextension" in
 				"mp")
-					$MPCOMPILER < $nonerrfile | $DLVHEX --silent $DLVHEXPARAMETERS -- > $TMPFILE_AS1
+					runMergingPlan $nonerrfile > $TMPFILE_AS1
 					let rv=rv+$?
 					;;
 				"hex")
@@ -569,7 +581,7 @@ function compare {
 			case "$extension1/$extension2" in
 				"mp/hex")	filter=$($MPCOMPILER < $1 | tail -1 | sed "s/.*filter=\([^ ]*\)[ ].*/\1/")
 						let rv=rv+$?
-						$MPCOMPILER < $1 | $DLVHEX --silent $DLVHEXPARAMETERS --filter=$filter -- > $TMPFILE_AS1
+						runMergingPlan $1 --filter=$filter > $TMPFILE_AS1
 						let rv=rv+$?
 						$DLVHEX --silent $DLVHEXPARAMETERS $2 > $TMPFILE_AS2
 						let rv=rv+$?
@@ -579,25 +591,25 @@ function compare {
 						let rv=rv+$?
 						$DLVHEX --silent $DLVHEXPARAMETERS $1 > $TMPFILE_AS1
 						let rv=rv+$?
-						$MPCOMPILER < $2 | $DLVHEX --silent $DLVHEXPARAMETERS --filter=$filter -- > $TMPFILE_AS2
+						runMergingPlan $2 --filter=$filter > $TMPFILE_AS2
 						let rv=rv+$?
 						extension="as"
 						;;
 				"mp/as")	filter=$($MPCOMPILER < $1 | tail -1 | sed "s/.*filter=\([^ ]*\)[ ].*/\1/")
 						let rv=rv+$?
-						$MPCOMPILER < $1 | $DLVHEX $DLVHEXPARAMETERS --silent --filter=$filter -- > $TMPFILE_AS1
+						runMergingPlan $1 --filter=$filter > $TMPFILE_AS1
 						let rv=rv+$?
 						cp $2 $TMPFILE_AS2
 						extension="as"
 						;;
 				"as/mp")	cp $1 $TMPFILE_AS1
-						$MPCOMPILER < $2 | $DLVHEX --silent $DLVHEXPARAMETERS -- > $TMPFILE_AS2
+						runMergingPlan $2 > $TMPFILE_AS2
 						let rv=rv+$?
 						extension="as"
 						;;
 				"mp/dot")	filter=$($MPCOMPILER < $1 | tail -1 | sed "s/.*filter=\([^ ]*\)[ ].*/\1/")
 						let rv=rv+$?
-						$MPCOMPILER < $1 | $DLVHEX --silent $DLVHEXPARAMETERS --filter=$filter -- | $GRAPHCONVERTER as dot > $TMPFILE_DOT1
+						runMergingPlan $1 --filter=$filter | $GRAPHCONVERTER as dot > $TMPFILE_DOT1
 						let rv=rv+$?
 						cp $2 $TMPFILE_DOT2
 						extension="dot"
@@ -605,7 +617,7 @@ function compare {
 				"dot/mp")	filter=$($MPCOMPILER < $1 | tail -1 | sed "s/.*filter=\([^ ]*\)[ ].*/\1/")
 						let rv=rv+$?
 						cp $1 $TMPFILE_DOT1
-						$MPCOMPILER < $2 | $DLVHEX --silent $DLVHEXPARAMETERS --filter=$filter -- | $GRAPHCONVERTER as dot > $TMPFILE_DOT2
+						runMergingPlan $2 --filter=$filter | $GRAPHCONVERTER as dot > $TMPFILE_DOT2
 						let rv=rv+$?
 						extension="dot"
 						;;
@@ -654,9 +666,9 @@ function compare {
 			# derived cases
 			case "$extension1" in
 				"mp")
-					$MPCOMPILER < $1 | $DLVHEX --silent $DLVHEXPARAMETERS -- > $TMPFILE_AS1
+					runMergingPlan $1 > $TMPFILE_AS1
 					let rv=rv+$?
-					$MPCOMPILER < $2 | $DLVHEX --silent $DLVHEXPARAMETERS -- > $TMPFILE_AS2
+					runMergingPlan $2 > $TMPFILE_AS2
 					let rv=rv+$?
 					extension="as"
 					;;
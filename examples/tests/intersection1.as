@@ -0,0 +1,2 @@
+{a}
+{a,b}
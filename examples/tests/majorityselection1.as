@@ -0,0 +1 @@
+{y,a(1),a(2),-b}
@@ -0,0 +1 @@
+{data(marge,simpson,0,female,unknown), data(homer,simpson,0,male,38), data(carl,carlson,0,unknown,37), data(monty,burns,0,unknown,unknown), schema(firstname,lastname,salary,sex,age)}
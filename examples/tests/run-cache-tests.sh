@@ -0,0 +1,110 @@
+#!/bin/bash
+
+#
+# Checks that results of pure operators are reused across runs by the
+# persistent operator cache (--operatorcache) as long as the files they
+# depend on keep their contents:
+#   1. the first run computes and stores the result of dalal
+#   2. after touching the constraint file (same contents), the result is loaded from the cache
+#   3. after editing the constraint file, the result is recomputed
+#   4. plans translated by dlvhex itself (--merging) yield the same result and share the cache whether
+#      the plan is evaluated sequentially (--planthreads=0) or concurrently (--planthreads=4)
+# Hits are recognized by the "(persistent)" suffix in the profile (--mergingprofile). The application
+# of dalal must be labeled with its identifier in the plan whether the plan is compiled by the mpcompiler
+# or translated and scheduled by dlvhex itself.
+#
+
+if [ "$DLVHEX" = "" ]; then
+	DLVHEX="dlvhex2"
+fi
+
+echo ============ cache tests start ============
+
+TMPDIR=$(mktemp -d -t tmp.XXXXXXXXXX)
+trap "rm -rf $TMPDIR" EXIT
+CACHEDIR=$TMPDIR/cache
+CONSTRAINTS=$TMPDIR/constraints.hex
+PLAN=$TMPDIR/plan.mp
+PROFILE=$TMPDIR/profile.txt
+
+cat > $PLAN <<EOF
+[common signature]
+predicate: a/0;
+predicate: p/1;
+
+[belief base]
+name: bb1;
+mapping: "a. p(x).";
+
+[belief base]
+name: bb2;
+mapping: "-a. -p(x).";
+
+[belief base]
+name: bb3;
+mapping: "-a.";
+
+[merging plan]
+{
+	operator: dalal;
+	constraintfile: "$CONSTRAINTS";
+	aggregate: "sum";
+	weights: "1,1,1";
+	{bb1};
+	{bb2};
+	{bb3};
+}
+EOF
+
+failed=0
+OLDDLVHEXPARAMETERS=$DLVHEXPARAMETERS
+CACHEPARAMETERS="$DLVHEXPARAMETERS --operatorcache=$CACHEDIR --mergingprofile=$PROFILE"
+
+# runs the plan and checks its result and if it was loaded from the cache
+# usage: check [description] [expected answer-sets] [expected hit: true or false] [additional dlvhex parameters]
+check(){
+	echo "$2" > $TMPDIR/ref.as
+	rm -f $PROFILE
+	DLVHEXPARAMETERS="$CACHEPARAMETERS $4"
+	export DLVHEXPARAMETERS
+	if ! $CMPSCRIPT $PLAN $TMPDIR/ref.as; then
+		echo "FAIL: $1 (wrong result)"
+		let failed++
+	elif [ "$3" = "true" ] && ! grep -q "dalal (persistent)" $PROFILE; then
+		echo "FAIL: $1 (expected a cache hit)"
+		let failed++
+	elif [ "$3" = "false" ] && grep -q "dalal (persistent)" $PROFILE; then
+		echo "FAIL: $1 (expected a cache miss)"
+		let failed++
+	elif ! grep -q "^result_dalal" $PROFILE; then
+		echo "FAIL: $1 (dalal is not labeled in the profile)"
+		let failed++
+	else
+		echo "PASS: $1"
+	fi
+}
+
+echo "% no constraints" > $CONSTRAINTS
+check "first run computes the result" "$(printf '{}\n{p(x)}')" false
+
+sleep 1
+touch $CONSTRAINTS
+check "touched constraint file hits the cache" "$(printf '{}\n{p(x)}')" true
+
+echo ":- p(x)." > $CONSTRAINTS
+check "edited constraint file misses the cache" "{}" false
+
+rm -rf $CACHEDIR
+check "concurrent evaluation computes the result" "{}" false "--merging --planthreads=4"
+check "sequential evaluation hits the cache" "{}" true "--merging --planthreads=0"
+
+rm -rf $CACHEDIR
+check "sequential evaluation computes the result" "{}" false "--merging --planthreads=0"
+check "concurrent evaluation hits the cache" "{}" true "--merging --planthreads=4"
+
+DLVHEXPARAMETERS=$OLDDLVHEXPARAMETERS
+export DLVHEXPARAMETERS
+
+echo ============= cache tests end =============
+
+exit $failed
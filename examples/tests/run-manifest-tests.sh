@@ -0,0 +1,62 @@
+#!/bin/bash
+
+#
+# Checks that the operators of a library are found through the operator
+# manifest (--operatormanifest) and that outdated entries are noticed:
+#   1. the first run opens the library and writes the manifest
+#   2. the second run opens the library only when its operator is used
+#   3. after touching the library, it is opened again and the manifest is updated
+#   4. after replacing the library by a new file, its operators are still found
+# The library of the test operators is copied such that it can be modified.
+#
+
+if [ "$DLVHEX" = "" ]; then
+	DLVHEX="dlvhex2"
+fi
+TESTOPERATORS=${TESTOPERATORS:-./testoperators/src/.libs/libdlvhextestoperators.so}
+
+echo ============ manifest tests start ============
+
+TMPDIR=$(mktemp -d -t tmp.XXXXXXXXXX)
+trap "rm -rf $TMPDIR" EXIT
+LIBRARY=$TMPDIR/libdlvhextestoperators.so
+MANIFEST=$TMPDIR/mergingplugin.manifest
+cp $TESTOPERATORS $LIBRARY
+
+failed=0
+OLDDLVHEXPARAMETERS=$DLVHEXPARAMETERS
+DLVHEXPARAMETERS="$DLVHEXPARAMETERS --operatormanifest=$MANIFEST --operatorpath=$LIBRARY --filter=result"
+export DLVHEXPARAMETERS
+
+# runs a program which applies a test operator and checks its result and the manifest entry of the library
+# usage: check [description]
+check(){
+	if ! $CMPSCRIPT $TESTDIR/../operators1.hex $TESTDIR/operators1.as; then
+		echo "FAIL: $1 (wrong result)"
+		let failed++
+	elif ! grep -q "^$(readlink -f $LIBRARY)	$(stat -c %Y $LIBRARY)	$(stat -c %s $LIBRARY)	.*testop1" $MANIFEST; then
+		echo "FAIL: $1 (library is not listed in the manifest with its current modification time and size)"
+		let failed++
+	else
+		echo "PASS: $1"
+	fi
+}
+
+check "first run writes the manifest"
+check "second run opens the library on first use"
+
+sleep 1
+touch $LIBRARY
+check "touched library is opened again"
+
+sleep 1
+cp $TESTOPERATORS $TMPDIR/replacement.so
+mv $TMPDIR/replacement.so $LIBRARY
+check "replaced library is opened again"
+
+DLVHEXPARAMETERS=$OLDDLVHEXPARAMETERS
+export DLVHEXPARAMETERS
+
+echo ============= manifest tests end =============
+
+exit $failed
@@ -0,0 +1,79 @@
+#!/bin/bash
+
+#
+# Passes a very large program through an input rewriter (cat) and checks
+# that it arrives unchanged, i.e. that the rewriter pipeline neither
+# deadlocks nor truncates the program.
+#
+# The size of the program (in MB) can be set with REWRITERTESTSIZE (default: 4,
+# which exceeds both the pipe buffers and the chunks of the filter many times).
+# Throughput on large programs is measured by benchmarks/rewriter.sh.
+#
+# Additionally, the peak memory of dlvhex is measured for programs of SIZE and
+# 4 * SIZE MB (if GNU time is available): each additional MB of program may cost
+# at most REWRITERMEMFACTOR MB (default: 4), i.e. the rewriter pipeline must not
+# keep several copies of the program.
+#
+
+SIZE=${REWRITERTESTSIZE:-4}
+MEMFACTOR=${REWRITERMEMFACTOR:-4}
+if [ "$DLVHEX" = "" ]; then
+	DLVHEX="dlvhex2"
+fi
+
+echo ============ rewriter tests start ============
+
+PROGRAM=$(mktemp -t tmp.XXXXXXXXXX)
+OUTPUT=$(mktemp -t tmp.XXXXXXXXXX)
+REFOUTPUT=$(mktemp -t tmp.XXXXXXXXXX)
+MEMORY=$(mktemp -t tmp.XXXXXXXXXX)
+trap "rm -f $PROGRAM $OUTPUT $REFOUTPUT $MEMORY" EXIT
+
+# writes a program of the given size (in MB) which consists of comments and a single fact at the very end
+# usage: makeprogram [size]
+makeprogram(){
+	yes "% this line is just padding for the rewriter test, it does not contain any rules" | head -c ${1}M > $PROGRAM
+	echo "" >> $PROGRAM
+	echo "a." >> $PROGRAM
+}
+
+# prints the peak memory (in KB) of dlvhex on a program of the given size (in MB)
+# usage: peakmemory [size]
+peakmemory(){
+	makeprogram $1
+	/usr/bin/time -f %M -o $MEMORY $DLVHEX --silent $DLVHEXPARAMETERS --irw=cat $PROGRAM > /dev/null
+	tail -n 1 $MEMORY
+}
+
+makeprogram $SIZE
+echo "{a}" > $REFOUTPUT
+
+$DLVHEX --silent $DLVHEXPARAMETERS --irw=cat $PROGRAM > $OUTPUT
+if [ $? = 0 ] && $CMPSCRIPT $OUTPUT $REFOUTPUT as as;
+then
+	echo "PASS: ${SIZE} MB program through --irw=cat"
+	failed=0
+else
+	echo "FAIL: ${SIZE} MB program through --irw=cat"
+	failed=1
+fi
+
+if /usr/bin/time -f %M -o $MEMORY true 2> /dev/null;
+then
+	small=$(peakmemory $SIZE)
+	large=$(peakmemory $((4 * SIZE)))
+	growth=$(( (large - small) / 1024 ))
+	if [ $growth -le $((3 * SIZE * MEMFACTOR)) ];
+	then
+		echo "PASS: memory grows by $growth MB from ${SIZE} MB to $((4 * SIZE)) MB programs"
+	else
+		echo "FAIL: memory grows by $growth MB from ${SIZE} MB to $((4 * SIZE)) MB programs (at most $((3 * SIZE * MEMFACTOR)) MB expected)"
+		failed=1
+	fi
+else
+	echo "WARN: GNU time not found, memory of the rewriter pipeline is not checked"
+fi
+
+echo ============= rewriter tests end =============
+
+exit $failed
@@ -0,0 +1,3 @@
+{a}
+{a,b}
+{a,c}
@@ -0,0 +1 @@
+{result(0), result(1), result(2)}
@@ -0,0 +1,56 @@
+#ifndef __ANSWERFORMAT_H_
+#define __ANSWERFORMAT_H_
+
+#include <PublicTypes.h>
+#include <dlvhex2/Registry.h>
+
+#include <ostream>
+#include <string>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Writes atoms and answer-sets in the textual format of dlvhex (which is also understood by the dlv result parsers), and computes
+			 * content hashes of answer-sets for duplicate detection.
+			 */
+			class AnswerFormat{
+			public:
+				static bool printAtom(RegistryPtr reg, std::ostream& o, ID ogid);
+				static std::string formatAnswerSet(InterpretationConstPtr answerset);
+				static std::string formatFacts(InterpretationConstPtr facts);
+				static std::size_t hashAnswerSet(InterpretationConstPtr answerset);
+			};
+
+			/*! \fn bool AnswerFormat::printAtom(RegistryPtr reg, std::ostream& o, ID ogid)
+			 * \brief Prints a ground atom in user syntax. Auxiliary atoms are skipped except for strongly negated ones, which are printed as "-p(...)".
+			 * \param reg The registry the atom is stored in
+			 * \param o The stream to print to
+			 * \param ogid The ID of the ground atom
+			 * \return bool True if the atom was printed, false if it is an internal auxiliary atom
+			 */
+
+			/*! \fn std::string AnswerFormat::formatAnswerSet(InterpretationConstPtr answerset)
+			 * \brief Formats an answer-set as "{a,b,...}"
+			 * \param answerset The answer-set to format
+			 * \return std::string The textual representation of the answer-set
+			 */
+
+			/*! \fn std::string AnswerFormat::formatFacts(InterpretationConstPtr facts)
+			 * \brief Formats an interpretation as list of facts (one per line); may be a null pointer
+			 * \param facts The facts to format
+			 * \return std::string The facts as program source code
+			 */
+
+			/*! \fn std::size_t AnswerFormat::hashAnswerSet(InterpretationConstPtr answerset)
+			 * \brief Computes a hash value of the atoms of an answer-set (i.e. of its storage bits); equal answer-sets over the same registry yield equal values
+			 * \param answerset The answer-set
+			 * \return std::size_t The hash value
+			 */
+		}
+	}
+}
+
+#endif
@@ -5,6 +5,7 @@
 #include <dlvhex2/DLVProcess.h>
 
 #include <stdio.h>
+#include <iostream>
 
 DLVHEX_NAMESPACE_USE
 
@@ -63,8 +64,20 @@ public:
 		setupStreams();
 		proc.open(commandline());
 	}
+
+	int filter(std::istream& in, std::ostream& out);
 };
 
+/*! \fn int ArbProcess::filter(std::istream& in, std::ostream& out)
+ * \brief Runs the process on its own (without spawn()), passes in to its standard input and writes its standard output to out.
+ * Both directions are served concurrently in large chunks, i.e. neither the input nor the output is buffered as a whole and
+ * processes which start writing before they have read all of their input cannot block.
+ * \param in The stream to pass to the process
+ * \param out The stream to write the output of the process to
+ * \return int The exit code of the process (-1 if it was terminated abnormally)
+ * \throw PluginError If the process cannot be started
+ */
+
 }
 }
 }
@@ -0,0 +1,105 @@
+#ifndef __BINARYANSWER_H_
+#define __BINARYANSWER_H_
+
+#include <PublicTypes.h>
+#include <dlvhex2/Registry.h>
+
+#include <string>
+#include <vector>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Compact binary encoding of hex answers for the exchange between processes.
+			 * All numbers are 32 bit unsigned integers in native byte order (writer and reader run on the same host):
+			 *	magic "HXA1"
+			 *	number of terms T, followed by T entries (length L, followed by L bytes of the constant symbol)
+			 *	number of answer-sets A, followed by A entries
+			 *		number of atoms N, followed by N entries
+			 *			arity+1 (highest bit set for strongly negated atoms), followed by the predicate and the arguments as indices
+			 *			into the term table (indices with the highest bit set are integer terms with the value in the remaining bits)
+			 * Auxiliary atoms are not written, except for strongly negated atoms which are written over their positive predicate.
+			 */
+			class BinaryAnswerWriter{
+			private:
+				RegistryPtr reg;
+				std::vector<uint32_t> termIndex;	// index in the term table by term address (plus 1; 0 = not in table yet)
+				std::string terms;
+				std::string answersets;
+				uint32_t termCount;
+				uint32_t answersetCount;
+
+				uint32_t encodeTerm(ID term);
+			public:
+				BinaryAnswerWriter(RegistryPtr reg);
+				void add(InterpretationConstPtr answerset);
+				void add(const HexAnswer& answer);
+				void write(std::string& out);
+			};
+
+			/*! \fn BinaryAnswerWriter::BinaryAnswerWriter(RegistryPtr reg)
+			 * \brief Constructs a writer for answer-sets over the given registry
+			 * \param reg The registry the answer-sets refer to
+			 */
+
+			/*! \fn void BinaryAnswerWriter::add(InterpretationConstPtr answerset)
+			 * \brief Appends an answer-set to the encoded answer
+			 * \param answerset The answer-set to append
+			 */
+
+			/*! \fn void BinaryAnswerWriter::add(const HexAnswer& answer)
+			 * \brief Appends all answer-sets of an answer
+			 * \param answer The answer-sets to append
+			 */
+
+			/*! \fn void BinaryAnswerWriter::write(std::string& out)
+			 * \brief Appends the encoding of all answer-sets added so far to out
+			 * \param out The buffer to write to
+			 */
+
+			/**
+			 * Decodes answers in the format of BinaryAnswerWriter.
+			 * The reader works directly on the given buffer: constant symbols are looked up once per term table entry, atoms are
+			 * decoded into a reused tuple and only new atoms are stored in the registry.
+			 */
+			class BinaryAnswerReader{
+			private:
+				const char* pos;
+				const char* end;
+
+				uint32_t readInt();
+			public:
+				BinaryAnswerReader(const char* data, size_t size);
+				BinaryAnswerReader(const std::string& data);
+				void read(RegistryPtr reg, HexAnswer& answer) throw (PluginError);
+
+				static bool isBinaryAnswer(const char* data, size_t size);
+			};
+
+			/*! \fn BinaryAnswerReader::BinaryAnswerReader(const char* data, size_t size)
+			 * \brief Constructs a reader for an encoded answer; the buffer must stay valid while the reader is used
+			 * \param data Pointer to the encoded answer
+			 * \param size Size of the encoded answer in bytes
+			 */
+
+			/*! \fn void BinaryAnswerReader::read(RegistryPtr reg, HexAnswer& answer)
+			 * \brief Decodes the answer and appends its answer-sets
+			 * \param reg The registry to store the decoded atoms in
+			 * \param answer The answer to append the answer-sets to
+			 * \throw PluginError If the buffer does not contain a valid encoding
+			 */
+
+			/*! \fn bool BinaryAnswerReader::isBinaryAnswer(const char* data, size_t size)
+			 * \brief Checks if a buffer starts with the magic number of the binary format
+			 * \param data Pointer to the buffer
+			 * \param size Size of the buffer in bytes
+			 * \return bool True if the buffer contains a binary answer, false if it is something else (e.g. a textual answer)
+			 */
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef __CONSTRAINTCACHE_H_
+#define __CONSTRAINTCACHE_H_
+
+#include "IOperator.h"
+
+#include <dlvhex2/Registry.h>
+#include <dlvhex2/Interpretation.h>
+
+#include <boost/unordered_map.hpp>
+
+#include <sys/types.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Process-wide cache of parsed side constraints of the distance-based operators (parameters "constraint" and "constraintfile").
+			 * Merging plans often pass the same constraints (e.g. a system description and observations) to many operator applications;
+			 * each constraint string and each file is parsed only once and the resulting rules are added to the programs of all further applications.
+			 * Constraint strings are looked up by their value, files by their path and are parsed again if their modification time or size changes.
+			 * The rules and facts are stored in the registry of the running dlvhex instance, thus their IDs stay valid as long as this
+			 * registry is used (entries of another registry are parsed again).
+			 */
+			class ConstraintCache{
+			public:
+				/**
+				 * Side constraints of an operator application: the source code (for external solvers) and the parsed rules and facts (for the
+				 * internal solver)
+				 */
+				struct Constraints{
+					std::string source;
+					std::vector<ID> rules;
+					InterpretationPtr facts;
+				};
+			private:
+				struct Entry{
+					RegistryPtr reg;
+					std::string source;
+					std::vector<ID> rules;
+					InterpretationPtr facts;
+					time_t mtime;
+					off_t size;
+					double parseTime;
+				};
+
+				static boost::unordered_map<std::string, Entry> constraints;
+				static boost::unordered_map<std::string, Entry> files;
+
+				static void parse(RegistryPtr reg, const std::string& source, Entry& entry);
+				static void splice(const Entry& entry, Constraints& target);
+			public:
+				static double addConstraint(RegistryPtr reg, const std::string& constraint, Constraints& target) throw (IOperator::OperatorException);
+				static double addConstraintFile(RegistryPtr reg, const std::string& filename, Constraints& target) throw (IOperator::OperatorException);
+				static void clear();
+			};
+
+			/*! \fn double ConstraintCache::addConstraint(RegistryPtr reg, const std::string& constraint, Constraints& target)
+			 * \brief Adds the rules and facts of a constraint string to the constraints of an application; the string is parsed only if it was not seen before
+			 * \param reg The registry the rules and facts are stored in
+			 * \param constraint The constraint(s) in hex syntax
+			 * \param target The constraints where the source code, the rules and the facts are added
+			 * \return double The parse time in seconds that was saved by the cache (0 if the string was parsed)
+			 * \throw IOperator::OperatorException If the string cannot be parsed
+			 */
+
+			/*! \fn double ConstraintCache::addConstraintFile(RegistryPtr reg, const std::string& filename, Constraints& target)
+			 * \brief Like addConstraint, but reads the constraints from a file; the file is parsed again if it was modified since it was cached
+			 * \param filename The path to the file (a file which cannot be read is treated as empty, as before)
+			 * \throw IOperator::OperatorException If the file cannot be parsed
+			 */
+
+			/*! \fn void ConstraintCache::clear()
+			 * \brief Drops all cached constraints
+			 */
+		}
+	}
+}
+
+#endif
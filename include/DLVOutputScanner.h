@@ -0,0 +1,52 @@
+#ifndef __DLVOUTPUTSCANNER_H_
+#define __DLVOUTPUTSCANNER_H_
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Translates the output of dlv into dlvhex' output format while it is produced.
+			 * Answer-sets ({...}) are copied, diagnoses (lines "Diagnosis: a b c") are translated into answer-sets ({a,b,c}), all other output
+			 * (costs, meta information) is dropped. The scanner is a stream buffer, i.e. the output of dlv can be written into an std::ostream
+			 * using this buffer; it processes each chunk in a single pass and keeps no more state than its current position in the grammar.
+			 */
+			class DLVOutputScanner : public std::streambuf{
+			private:
+				enum State{
+					LineStart,	// matching the diagnosis prefix at the beginning of a line
+					Skip,		// skipping meta information
+					AnswerSet,	// copying an answer-set
+					Diagnosis,	// translating a diagnosis
+				};
+
+				std::ostream& out;
+				State state;
+				int prefixMatched;
+
+				void scan(const char* data, std::streamsize len);
+			protected:
+				virtual int_type overflow(int_type c);
+				virtual std::streamsize xsputn(const char* s, std::streamsize n);
+				virtual int sync();
+			public:
+				DLVOutputScanner(std::ostream& out);
+				void finish();
+			};
+
+			/*! \fn DLVOutputScanner::DLVOutputScanner(std::ostream& out)
+			 * \brief Constructs a scanner which writes the translated output to out
+			 * \param out The stream to write the answer-sets to (one per line)
+			 */
+
+			/*! \fn void DLVOutputScanner::finish()
+			 * \brief Completes an answer-set or diagnosis which is not terminated at the end of the output and flushes the target stream
+			 */
+		}
+	}
+}
+
+#endif
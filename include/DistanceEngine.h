@@ -0,0 +1,137 @@
+#ifndef __DISTANCEENGINE_H_
+#define __DISTANCEENGINE_H_
+
+#include <DistanceKernel.h>
+
+#include <vector>
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Computes distance-minimal group decisions (as the dalal operator does) without an ASP solver.
+			 * The group decision assigns each atom either to true or to strongly false. The distance of a source to a decision is the minimum
+			 * over the source's answer-sets of the weighted penalties for each atom (according to the 4x4 penalize matrix of the operator). The
+			 * distances of the sources are aggregated by sum or max, and all decisions with minimal aggregated distance are computed.
+			 * The atoms are assigned by depth-first branch-and-bound: for each answer-set, the costs of the assigned atoms plus the cheapest
+			 * possible costs of the remaining atoms yield a lower bound which is aggregated like the final costs. The search starts with the
+			 * best of the sources' own answer-sets as upper bound (evaluated by the DistanceKernel).
+			 * With a timeout, the search is interrupted when the time is up and the best decisions found so far are returned (at least the
+			 * best decisions taken by the sources themselves).
+			 */
+			class DistanceEngine{
+			public:
+				/**
+				 * Aggregation of the distances of the individual sources
+				 */
+				enum Aggregation{
+					Sum,
+					Max,
+				};
+
+				/**
+				 * Receives the decisions which improve the best aggregated distance so far, as they are found
+				 */
+				class Listener{
+				public:
+					virtual ~Listener(){}
+					virtual void improved(const std::vector<bool>& decision, int cost) = 0;
+				};
+
+			private:
+				struct Source{
+					int weight;
+					int cost[4][4];					// penalize matrix multiplied with the weight
+					std::vector<DistanceKernel::Bitset> positive;	// positive atoms of each answer-set
+					std::vector<DistanceKernel::Bitset> negative;	// strongly negated atoms of each answer-set
+				};
+
+				int atomCount;
+				float penalize[4][4];
+				Aggregation aggregation;
+				std::vector<Source> sources;
+
+				// search state; answer-sets of all sources are numbered consecutively
+				std::vector<int> firstAnswerSet;	// index of the first answer-set of each source (plus end marker)
+				std::vector<int> costTrue;		// costTrue[answer-set * atomCount + atom]: costs if the atom is true in the decision
+				std::vector<int> costFalse;		// the same if the atom is strongly false in the decision
+				std::vector<int> remaining;		// remaining[answer-set * (atomCount + 1) + atom]: minimal costs of the atoms from this one on
+				std::vector<int> partial;		// costs of the assigned atoms for each answer-set
+				std::vector<bool> decision;
+				int bestCost;
+				std::vector<std::vector<bool> >* optimal;
+				std::vector<std::vector<bool> > seeds;	// best decisions taken by the sources themselves
+
+				// time budget
+				int timeout;				// milliseconds, 0 = unlimited
+				double deadline;
+				int nodes;
+				bool interrupted;
+
+				Listener* listener;
+
+				void prepare();
+				int evaluate(const DistanceKernel::Bitset& decision);
+				int bound(int atom);
+				void search(int atom);
+				bool timeUp();
+			public:
+				DistanceEngine(int atomCount, const float penalize[4][4], Aggregation aggregation);
+
+				void addSource(int weight);
+				void addAnswerSet(const std::vector<bool>& positive, const std::vector<bool>& negative);
+
+				void setTimeout(int milliseconds);
+				void setListener(Listener* listener);
+				int solve(std::vector<std::vector<bool> >& optimal);
+				bool isComplete();
+			};
+
+			/*! \fn DistanceEngine::DistanceEngine(int atomCount, const float penalize[4][4], Aggregation aggregation)
+			 * \brief Constructs an engine for decisions over a fixed number of atoms
+			 * \param atomCount The number of (positive) atoms occurring in any source
+			 * \param penalize The cost model (first dimension: individual, second dimension: group decision; 0=+, 1=not, 2=-, 3=not-)
+			 * \param aggregation The aggregation function for the distances of the sources
+			 */
+
+			/*! \fn void DistanceEngine::addSource(int weight)
+			 * \brief Adds a source without answer-sets; subsequent calls of addAnswerSet refer to this source
+			 * \param weight The weight of the source (penalties are multiplied with it)
+			 */
+
+			/*! \fn void DistanceEngine::addAnswerSet(const std::vector<bool>& positive, const std::vector<bool>& negative)
+			 * \brief Adds an answer-set to the source that was added last
+			 * \param positive positive[i] is true iff the answer-set contains atom i
+			 * \param negative negative[i] is true iff the answer-set contains the strongly negated atom i
+			 */
+
+			/*! \fn void DistanceEngine::setTimeout(int milliseconds)
+			 * \brief Limits the time of subsequent calls of solve
+			 * \param milliseconds The time budget in milliseconds (0 = unlimited)
+			 */
+
+			/*! \fn void DistanceEngine::setListener(Listener* listener)
+			 * \brief Sets the listener which is informed about improving decisions during subsequent calls of solve
+			 * \param listener The listener (NULL = none)
+			 */
+
+			/*! \fn void DistanceEngine::Listener::improved(const std::vector<bool>& decision, int cost)
+			 * \brief Called for each decision whose aggregated distance is below the ones found before
+			 * \param decision Element i is true iff atom i is true in the decision
+			 * \param cost The aggregated distance of the decision
+			 */
+
+			/*! \fn int DistanceEngine::solve(std::vector<std::vector<bool> >& optimal)
+			 * \brief Computes all decisions with minimal aggregated distance
+			 * \param optimal Vector where the optimal decisions are appended (element i is true iff atom i is true in the decision, otherwise it is strongly false)
+			 * \return int The minimal aggregated distance or -1 if there is no decision (i.e. some source has no answer-set)
+			 */
+
+			/*! \fn bool DistanceEngine::isComplete()
+			 * \brief Returns false if the last call of solve was interrupted by the timeout, i.e. the result is not proven to be optimal
+			 */
+		}
+	}
+}
+
+#endif
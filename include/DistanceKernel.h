@@ -0,0 +1,68 @@
+#ifndef __DISTANCEKERNEL_H_
+#define __DISTANCEKERNEL_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Counts the differences between two answer-sets over the same atoms in all combinations of the literal classes used by the
+			 * distance-based operators (0 = +, 1 = not, 2 = -, 3 = not-), i.e. the number of atoms for which a literal of class i holds in the
+			 * individual's answer-set and a literal of class j holds in the group decision.
+			 * Answer-sets are bitsets over the atoms (one for the positive and one for the strongly negated atoms; bits beyond the atom count
+			 * must be 0). All 16 counts are derived from 8 population counts which are computed in a single pass over the blocks.
+			 * The implementation is selected at runtime: AVX-512 popcount, AVX2 or the popcnt instruction if the CPU supports them, otherwise
+			 * a portable version.
+			 */
+			class DistanceKernel{
+			public:
+				typedef uint64_t Block;
+				typedef std::vector<Block> Bitset;
+
+				static int blockCount(int atomCount);
+				static void set(Bitset& bitset, int atom);
+				static bool get(const Bitset& bitset, int atom);
+
+				static void countDifferences(const Block* individualPos, const Block* individualNeg, const Block* groupPos, const Block* groupNeg, int blocks, int atomCount, int counts[4][4]);
+
+				static std::string getImplementation();
+				static std::vector<std::string> getImplementations();
+				static bool setImplementation(const std::string& name);
+			};
+
+			/*! \fn int DistanceKernel::blockCount(int atomCount)
+			 * \brief Returns the number of blocks of a bitset over the given number of atoms
+			 */
+
+			/*! \fn void DistanceKernel::countDifferences(const Block* individualPos, const Block* individualNeg, const Block* groupPos, const Block* groupNeg, int blocks, int atomCount, int counts[4][4])
+			 * \brief Computes the 4x4 difference-count matrix of an individual's answer-set and a group decision
+			 * \param individualPos Positive atoms of the individual's answer-set
+			 * \param individualNeg Strongly negated atoms of the individual's answer-set
+			 * \param groupPos Positive atoms of the group decision
+			 * \param groupNeg Strongly negated atoms of the group decision
+			 * \param blocks The number of blocks of each bitset
+			 * \param atomCount The number of atoms (needed for the default-negated classes)
+			 * \param counts counts[i][j] is set to the number of atoms with a literal of class i in the individual's and class j in the group's answer-set
+			 */
+
+			/*! \fn std::string DistanceKernel::getImplementation()
+			 * \brief Returns the name of the implementation in use ("avx512", "avx2", "popcnt" or "generic")
+			 */
+
+			/*! \fn std::vector<std::string> DistanceKernel::getImplementations()
+			 * \brief Returns the names of all implementations supported by this CPU
+			 */
+
+			/*! \fn bool DistanceKernel::setImplementation(const std::string& name)
+			 * \brief Overrides the automatic selection of the implementation (e.g. for benchmarks)
+			 * \param name The name of the implementation
+			 * \return bool False if the implementation is unknown or not supported by this CPU
+			 */
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,244 @@
+#ifndef __DISTANCEOPERATOR_H_
+#define __DISTANCEOPERATOR_H_
+
+#include "IOperatorV2.h"
+#include "ConstraintCache.h"
+
+#include <dlvhex2/Registry.h>
+#include <dlvhex2/Interpretation.h>
+
+#include <boost/unordered_map.hpp>
+
+#include <map>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Common implementation of the distance-based operators (dalal, dbo). The group decision assigns each atom occurring in any source
+			 * either to true or to strongly false; the decisions whose aggregated distance to the sources is minimal are computed, either
+			 * directly (see DistanceEngine) or by solving a merging program with an ASP solver (see solveProgram).
+			 * The operator is ParallelSafe: when the application runs concurrently with others (see EncodedAnswerSink), the result is computed in a
+			 * child process and passed to the cache in binary answer format, since building the merging program adds atoms to the registry.
+			 * Derived classes only differ in their name, their documentation and the name of the parameter which sets the cost model.
+			 */
+			class DistanceOperator : public IOperatorV2{
+			private:
+				// helper methods
+				std::string findUniqueAtomName(const std::string prefix, std::set<std::string>& usedPredNames);
+
+				// preprocessing
+				void parseParameters(RegistryPtr reg, int arity, const OperatorArguments& parameters, std::vector<int>& weights, int& maxint, std::set<std::string>& ignoredPredicates, ConstraintCache::Constraints& constraints, std::string& aggregation, float penalize[4][4], std::string& solver, int& portfolio, int& timeout, bool& anytime, double& parseTimeSaved);
+				void parsePenalize(const std::string& rule, float penalize[4][4]);
+				void createAtomList(RegistryPtr reg, const std::vector<const HexAnswer*>& arguments, std::vector<Tuple>& sourceAtoms, boost::unordered_map<Tuple, int>& atomIndex);
+
+				// subprogram generation
+				void buildAggregateFunction(const int arity, const std::string aggregation, const std::string optAtom, const std::string costSum, std::ostream& program);
+				void writeAtomSelectionRules(RegistryPtr reg, const std::vector<Tuple>& sourceAtoms, std::ostream& program);
+				void renameSourceAtoms(RegistryPtr reg, const std::vector<Tuple>& sourceAtoms, std::set<std::string>& usedPredNames, std::map<ID, std::string>& localAtoms);
+				void writeAnswerSetSelectionRules(RegistryPtr reg, const HexAnswer* source, const std::map<ID, std::string>& localAtomMapping, const std::set<std::string>& ignoredPredicates, std::set<std::string>& usedPredNames, std::ostream& program);
+				void writeCostComputationRules(RegistryPtr reg, const int sourceNr, const std::map<ID, std::string>& localAtomMapping, const std::vector<Tuple>& sourceAtoms, const std::string costAtom, const std::string costAccAtom, const std::string costSumAtom, const int weight, const float penalize[4][4], int& maxint, std::ostream& program);
+
+				// native computation
+				void solveNative(bool debug, RegistryPtr reg, const std::vector<const HexAnswer*>& arguments, const std::vector<Tuple>& sourceAtoms, const boost::unordered_map<Tuple, int>& atomIndex, const std::vector<bool>& relevant, const std::vector<int>& weights, const float penalize[4][4], const std::string& aggregation, const std::string& optAtom, int timeout, bool& complete, HexAnswer& result);
+
+				// solving
+				void solveProgram(bool debug, RegistryPtr reg, const std::string& backend, const std::string& program, const ConstraintCache::Constraints& constraints, int maxint, const std::set<std::string>& filter, const std::string& optAtom, int timeout, bool& complete, HexAnswer& result);
+				void solveDLV(RegistryPtr reg, const std::string& program, int maxint, const std::set<std::string>& filter, HexAnswer& result);
+
+				// postprocessing
+				void optimize(HexAnswer& result, std::string optAtom);
+				void markIncomplete(RegistryPtr reg, bool complete, bool anytime, HexAnswer& result);
+
+				void compute(bool debug, const std::vector<const HexAnswer*>& arguments, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException);
+			protected:
+				virtual std::string getPenalizeParameter() = 0;
+				virtual bool isAberration(const std::string& rule);
+			public:
+				virtual std::set<std::string> getRecognizedParameters();
+				virtual int getCapabilities(const OperatorArguments& parameters);
+				virtual std::vector<std::string> getDependencies(const OperatorArguments& parameters);
+				virtual void evaluate(bool debug, const std::vector<const HexAnswer*>& answers, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException);
+			};
+		}
+	}
+}
+
+
+/*! \fn std::string DistanceOperator::findUniqueAtomName(const std::string prefix, std::set<std::string>& usedPredNames)
+ * Finds an predicate name that was not used yet and appends it to the list of used predicate names
+ * \param prefix The desired prefix of the predicate
+ * \param usedPredNames Reference to the list of predicate names used so far
+ */
+
+/*! \fn void DistanceOperator::parseParameters(RegistryPtr reg, int arity, const OperatorArguments& parameters, std::vector<int>& weights, int& maxint, std::set<std::string>& ignoredPredicates, ConstraintCache::Constraints& constraints, std::string& aggregation, float penalize[4][4], std::string& solver, int& portfolio, int& timeout, bool& anytime, double& parseTimeSaved)
+ * Parses the following parameters:
+ * 	-) constraint: "some constraint"
+ * 	-) constraintfile: "some filename"
+ * 	-) weights: "w1,...,wn"
+ * 	-) penalize (or the name returned by getPenalizeParameter) "individual,aggregated,factor"
+ * 	-) maxint: "integer"
+ * 	-) ignore: "pred1,...,predn"
+ * 	-) solver: "native", "dlv" or "internal"
+ * 	-) portfolio: "integer"
+ * 	-) timeout: "integer"
+ * 	-) anytime: "true" or "false"
+ * \param reg The registry the side constraints are parsed into
+ * \param arity The number of answer arguments
+ * \param weights Reference to the vector where the weights shall be written to
+ * \param maxint Reference to the integer where the maximum int value shall be written to
+ * \param ignoredPredicates Reference to the set where the ignored predicates shall be written to
+ * \param constraints Reference to the side constraints where the constraints shall be appended
+ * \param aggregation Reference to the string where the aggregation function shall be written to
+ * \param penalize The cost model (set to the default if no penalize parameter is given)
+ * \param solver Reference to the string where the selected solver backend ("native", "dlv" or "internal") shall be written to
+ * \param portfolio Reference to the integer where the number of backends to run in parallel shall be written to
+ * \param timeout Reference to the integer where the time budget in milliseconds shall be written to
+ * \param anytime Reference to the boolean where the anytime flag shall be written to
+ * \param parseTimeSaved Reference to the double where the parse time (in seconds) saved by reusing cached constraints shall be written to
+ */
+
+/*! \fn void DistanceOperator::parsePenalize(const std::string& rule, float penalize[4][4])
+ * Parses a penalize rule.
+ * \param rule Some rule (either shortcuts "ignoring", "unfounded", "aberration" (see isAberration) or triples of kind "{+,not,-,not-},{+,not,-,not-},int")
+ * \param penalize Pointer to a 4x4 float matrix where the new rule is added (where only elements that are explicitly reset will be overwritten)
+ */
+
+/*! \fn void DistanceOperator::createAtomList(RegistryPtr reg, const std::vector<const HexAnswer*>& arguments, std::vector<Tuple>& sourceAtoms, boost::unordered_map<Tuple, int>& atomIndex)
+ * Extracts all atoms from the sources; an atom and its strongly negated counterpart are identified by the tuple of the positive atom.
+ * \param arguments The vector of answers passed to the operator
+ * \param sourceAtoms A reference to the list where the atoms (in order of their first occurrence) shall be written to
+ * \param atomIndex A reference to the map where the position of each atom in sourceAtoms shall be written to
+ */
+
+/*! \fn void DistanceOperator::buildAggregateFunction(const int arity, const std::string aggregation, const std::string optAtom, const std::string costSum, std::ostream& program)
+ * Writes code for computing the aggregation function
+ * Either the computation rule is directly passed in argument "std::string aggregation", or a (supported) shortcut like "sum" or "max" is used; in the latter case
+ * the function will generate the appropriate code automatically
+ * \param aggregation Either user-defined rules of one of the strings "sum", "max"
+ * \param optAtom The name of the atom upon which to minimize
+ * \param costSum The name of the atom where sourcewise costs are sumed up
+ * \param program Reference to the program where rules shall be added
+ */
+
+/*! \fn void DistanceOperator::writeAtomSelectionRules(RegistryPtr reg, const std::vector<Tuple>& sourceAtoms, std::ostream& program)
+ * Writes a disjunctive rule of kind "a v -a." for each atom, such that the group decision either accepts or denies it
+ * \param sourceAtoms The (positive) atoms occurring in any source
+ * \param program A reference to the program to append the rules
+ */
+
+/*! \fn void DistanceOperator::renameSourceAtoms(RegistryPtr reg, const std::vector<Tuple>& sourceAtoms, std::set<std::string>& usedPredNames, std::map<ID, std::string>& localAtoms)
+ * Renames the predicates of a given source such that they are unique within the program
+ * \param sourceAtoms Vector of ALL atoms in ANY source (not only those that occur in this one); we even need unique names for atoms that never occur in this source for cost model "unfounded"
+ * \param usedPredNames Reference to the set of already used predicate names (is expanded by this method)
+ * \param localAtoms A reference to a map where the mapping of each predicate occurring in the source atoms onto a unique name shall be added
+ */
+
+/*! \fn void DistanceOperator::writeAnswerSetSelectionRules(RegistryPtr reg, const HexAnswer* source, const std::map<ID, std::string>& localAtomMapping, const std::set<std::string>& ignoredPredicates, std::set<std::string>& usedPredNames, std::ostream& program)
+ * Writes rules that select exactly one of a certain source's answer-sets and derive all the atoms in this set in case that it is selected.
+ * i.e. if the source has answer-sets {a},{b}, it will generate the rules:
+ *   as0 v as1.
+ *   a :- as0.
+ *   b :- as1.
+ * \param source A pointer to the source
+ * \param localAtomMapping A reference to the mapping of global predicates onto the source's
+ * \param ignoredPredicates A reference to the set of irrelevant predicate names
+ * \param usedPredNames Reference to the set of already used predicate names (is expanded by this method)
+ * \param program Reference to the program where rules shall be appended
+ */
+
+/*! \fn void DistanceOperator::writeCostComputationRules(RegistryPtr reg, const int sourceNr, const std::map<ID, std::string>& localAtomMapping, const std::vector<Tuple>& sourceAtoms, const std::string costAtom, const std::string costAccAtom, const std::string costSumAtom, const int weight, const float penalize[4][4], int& maxint, std::ostream& program)
+ * Given a certain source. This method writes all the rules that compute the costs for derivations of the aggregated decision from this individual's one.
+ * Each combination of an atom and a kind of difference with positive costs yields a rule of kind
+ *	cost(SRC, K, c) :- -a123, not -a.
+ * where K is a unique index within the source and c the penalty multiplied with the weight (0 if the rule is not applicable). The costs are
+ * summed up along K without aggregate atoms (which the internal grounder does not support):
+ *	costAcc(SRC, K, S) :- costAcc(SRC, K-1, S0), cost(SRC, K, C), S=S0+C.
+ *	costSum(SRC, S) :- costAcc(SRC, last K, S).
+ * \param sourceNr The unique number of the source
+ * \param localAtomMapping A reference to the mapping of global predicates onto the source's
+ * \param sourceAtoms The atoms occurring in any of the sources
+ * \param costAtom The name of the atom where costs of individual constraint violations are derived
+ * \param costAccAtom The name of the atom where costs of individual constraint violations are accumulated
+ * \param costSumAtom The name of the atom where costs of individuals are summed up
+ * \param weight Weight of this source
+ * \param penalize The cost model
+ * \param maxint Reference to the maximum integer value occurring in the program or in an intermediate result (will be raised by this function if necessary)
+ * \param program Reference to the program where rules shall be appended
+ */
+
+/*! \fn void DistanceOperator::solveNative(bool debug, RegistryPtr reg, const std::vector<const HexAnswer*>& arguments, const std::vector<Tuple>& sourceAtoms, const boost::unordered_map<Tuple, int>& atomIndex, const std::vector<bool>& relevant, const std::vector<int>& weights, const float penalize[4][4], const std::string& aggregation, const std::string& optAtom, int timeout, bool& complete, HexAnswer& result)
+ * Computes the result without ASP solver (see DistanceEngine); only applicable if there are no side constraints and the aggregate function is built-in.
+ * The answer-sets consist of the decision on all relevant source atoms and the optimization atom with the costs (like the output of the ASP encoding).
+ * \param debug If true, the improving decisions are printed to stderr as they are found
+ * \param arguments The answers passed to the operator
+ * \param sourceAtoms The atoms occurring in any source
+ * \param atomIndex The position of each atom in sourceAtoms
+ * \param relevant relevant[i] is false iff atom i is over an ignored predicate
+ * \param weights The weights of the sources
+ * \param penalize The cost model
+ * \param aggregation The aggregate function ("sum" or "max")
+ * \param optAtom The name of the optimization atom
+ * \param timeout Time budget in milliseconds (0 = unlimited)
+ * \param complete Reference to the boolean where false is written to if the search was interrupted by the timeout
+ * \param result Reference to the answer where the optimal answer-sets shall be appended
+ */
+
+/*! \fn void DistanceOperator::solveProgram(bool debug, RegistryPtr reg, const std::string& backend, const std::string& program, const ConstraintCache::Constraints& constraints, int maxint, const std::set<std::string>& filter, const std::string& optAtom, int timeout, bool& complete, HexAnswer& result)
+ * Solves the merging program with an ASP solver and keeps only the answer-sets of minimal costs
+ * \param debug If true, the models of the internal solver are printed to stderr as they are found
+ * \param backend "dlv" for an external dlv process or "internal" for the internal grounder and solver
+ * \param program The merging program (without side constraints)
+ * \param constraints The side constraints (the source code is passed to dlv, the parsed rules to the internal solver)
+ * \param maxint The maximum integer needed by the program
+ * \param filter The predicates in the output
+ * \param optAtom The name of the optimization atom
+ * \param timeout Time budget in milliseconds (0 = unlimited; only supported by the internal solver)
+ * \param complete Reference to the boolean where false is written to if the solver was interrupted by the timeout
+ * \param result Reference to the answer where the optimal answer-sets shall be appended
+ */
+
+/*! \fn void DistanceOperator::solveDLV(RegistryPtr reg, const std::string& program, int maxint, const std::set<std::string>& filter, HexAnswer& result)
+ * Runs dlv on a program and appends all answer-sets it prints (with weak constraints, these are the improving models)
+ * \param program The program
+ * \param maxint The maximum integer needed by the program
+ * \param filter The predicates in the output
+ * \param result Reference to the answer where the answer-sets shall be appended
+ */
+
+/*! \fn void DistanceOperator::optimize(HexAnswer& result, std::string optAtom)
+ * Keeps only the minimum-costs answer-sets in "result" and removes the others and duplicates
+ * \param optAtom Tells the function upon which (unary) predicate to minimize
+ */
+
+/*! \fn void DistanceOperator::markIncomplete(RegistryPtr reg, bool complete, bool anytime, HexAnswer& result)
+ * Handles results which are not proven to be optimal because the time budget was exceeded: in anytime mode, the atom "nonoptimal" is added to each
+ * answer-set, otherwise an exception is thrown.
+ * \param complete False if the result is not proven to be optimal
+ * \param anytime True if the best answer-sets found so far are acceptable
+ * \param result The answer-sets computed so far
+ */
+
+/*! \fn void DistanceOperator::compute(bool debug, const std::vector<const HexAnswer*>& arguments, const OperatorArguments& parameters, AnswerSink& result)
+ * Computes the result of the operator in the current process (see evaluate, which forks if the application runs concurrently)
+ * \param arguments The answers passed to the operator
+ * \param parameters The operator parameters
+ * \param result The sink where the optimal answer-sets are added
+ * \throw OperatorException If the operator fails
+ */
+
+/*! \fn std::string DistanceOperator::getPenalizeParameter()
+ * Returns the name of the parameter which sets the cost model (e.g. "penalize")
+ */
+
+/*! \fn bool DistanceOperator::isAberration(const std::string& rule)
+ * Returns true if the penalize rule is a shortcut for penaltizing both ignoring and unfounded beliefs (default: "aberration")
+ */
+
+#endif
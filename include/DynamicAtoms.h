@@ -0,0 +1,87 @@
+#ifndef __DYNAMICATOMS_H_
+#define __DYNAMICATOMS_H_
+
+#include <HexAnswerCache.h>
+#include <dlvhex2/PluginInterface.h>
+#include <dlvhex2/ProgramCtx.h>
+
+#include <set>
+#include <string>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Registers the external atoms which exist in one instance per arity (&callhexN, &callhexfileN and &simulatorI_O) on demand.
+			 * Programs are scanned for references to such atoms before they are evaluated: the main program by AtomScanner, nested
+			 * programs by the answer cache and the worker pool. Only the referenced arities are instantiated and added to the program context.
+			 */
+			class DynamicAtoms{
+			public:
+				static const int MAX_ARITY = 1024;	// guards against typos which would create atoms with huge input lists
+
+			private:
+				ProgramCtx* ctx;
+				HexAnswerCache& resultsetCache;
+				std::set<std::string> registered;
+			public:
+				DynamicAtoms(HexAnswerCache& rsCache);
+				void setProgramCtx(ProgramCtx& ctx);
+				void add(const std::string& name);
+				void require(const std::string& program);
+				void requireFile(const std::string& filename);
+			};
+
+			/*! \fn DynamicAtoms::DynamicAtoms(HexAnswerCache& rsCache)
+			 * \brief Constructs a registry for the atoms of the given answer cache
+			 * \param rsCache The cache used by the created &callhexN and &callhexfileN atoms
+			 */
+
+			/*! \fn void DynamicAtoms::setProgramCtx(ProgramCtx& ctx)
+			 * \brief Sets the program context which the atoms are added to (must be called before require)
+			 * \param ctx The program context of the running dlvhex instance
+			 */
+
+			/*! \fn void DynamicAtoms::add(const std::string& name)
+			 * \brief Adds the atom with the given name (without the leading &) if it is one of the atoms with one instance per arity and was not added yet
+			 * \param name The name of the referenced atom; other names are ignored
+			 * \throw PluginError If an arity exceeds MAX_ARITY
+			 */
+
+			/*! \fn void DynamicAtoms::require(const std::string& program)
+			 * \brief Adds the atoms which are referenced in a program (including nested programs given as string literals) and were not added yet
+			 * \param program The source code of the program
+			 * \throw PluginError If an arity exceeds MAX_ARITY
+			 */
+
+			/*! \fn void DynamicAtoms::requireFile(const std::string& filename)
+			 * \brief Like require, but for a program stored in a file; files which cannot be read are ignored (the evaluation will report the error)
+			 * \param filename Path to the program
+			 */
+
+			/**
+			 * Converter which passes the input through another converter (if any) and registers the atoms referenced by the result
+			 * before the program is parsed.
+			 * The result is scanned while it is forwarded to the output, thus the program is not buffered by the scanner.
+			 */
+			class AtomScanner : public PluginConverter{
+			private:
+				PluginConverterPtr inner;
+				DynamicAtoms& atoms;
+			public:
+				AtomScanner(PluginConverterPtr inner, DynamicAtoms& atoms);
+				virtual void convert(std::istream& i, std::ostream& o);
+			};
+
+			/*! \fn AtomScanner::AtomScanner(PluginConverterPtr inner, DynamicAtoms& atoms)
+			 * \brief Constructs a scanning converter
+			 * \param inner The converter to apply first (e.g. the merging plan compiler); may be a null pointer
+			 * \param atoms The registry to add the referenced atoms to
+			 */
+		}
+	}
+}
+
+#endif
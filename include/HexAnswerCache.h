@@ -3,6 +3,11 @@
 
 #include <PublicTypes.h>
 #include <IOperator.h>
+#include <WorkerPool.h>
+#include <LazyAnswer.h>
+#include <PersistentCache.h>
+#include <OperatorAdapter.h>
+#include <Profiler.h>
 #include <dlvhex2/Registry.h>
 
 DLVHEX_NAMESPACE_USE
@@ -10,6 +15,9 @@ DLVHEX_NAMESPACE_USE
 namespace dlvhex{
 	namespace merging{
 		namespace plugin{
+			class DynamicAtoms;
+			class PlanScheduler;
+
 			/**
 			 * Unique identification of a certain hex or operator call
 			 */
@@ -35,12 +43,18 @@ namespace dlvhex{
 
 				std::vector<int> asParams;
 				OperatorArguments kvParams;
+				OperatorArguments sortedKvParams;	// canonical order for comparisons
+				std::size_t kvDigest;
 				IOperator* operatorImpl;
+				std::string operatorVersion;
+				std::vector<std::string> dependencies;
+				std::string dependencyStamp;	// modification times and sizes of the dependencies
+				std::string label;		// identifier in the merging plan (not part of the identification)
 				bool debug;
 				bool silent;
 			public:
 				HexCall(CallType ct, std::string prog, std::string args, InterpretationConstPtr facts);
-				HexCall(CallType ct, IOperator* op, bool debug, bool silent, std::vector<int> as, OperatorArguments kv);
+				HexCall(CallType ct, IOperator* op, bool debug, bool silent, std::vector<int> as, OperatorArguments kv, std::string version);
 				const bool operator==(const HexCall &other) const;
 
 				const CallType getType() const;
@@ -51,9 +65,13 @@ namespace dlvhex{
 				const std::vector<int> getAsParams() const;
 				const OperatorArguments getKvParams() const;
 				IOperator* getOperator() const;
+				const std::string getOperatorVersion() const;
+				const std::vector<std::string> getDependencies() const;
 				const std::string getHashCode() const;
 				const bool getDebug() const;
 				const bool getSilent() const;
+				void setLabel(const std::string& label);
+				const std::string getLabel() const;
 			};
 
 			/*! \fn HexCall::HexCall(CallType ct, std::string prog, std::string args)
@@ -63,7 +81,7 @@ namespace dlvhex{
 			 * \param args The command line arguments for the program
 			 */
 
-			/*! \fn HexCall::HexCall(CallType ct, IOperator* op, bool debug, bool silent, std::vector<int> as, OperatorArguments kv)
+			/*! \fn HexCall::HexCall(CallType ct, IOperator* op, bool debug, bool silent, std::vector<int> as, OperatorArguments kv, std::string version)
 			 * \brief Constructs a new hash call identifier
 			 * \param ct The type of the call: must be either OperatorCall; for HexProgram or HexFile use the overloaded constructor.
 			 * \param op A pointer to the operator in use
@@ -71,6 +89,9 @@ namespace dlvhex{
 			 * \param silent Tells the operator if dlvhex is called in silent mode
 			 * \param as The indices of answers passed to the operator
 			 * \param kv The list of key-value pairs passed to the operator
+			 * \param version The version of the operator's implementation (the library and its modification time, or PersistentCache::BUILTIN_VERSION)
+			 * The versions (modification time and size) of the files the operator declares as dependencies (see IOperatorV2::getDependencies)
+			 * are part of the identification; the files are not read.
 			 */
 
 			/*! \fn bool HexCall::operator==(const HexCall &other)
@@ -114,6 +135,16 @@ namespace dlvhex{
 			 * \param IOperator* A pointer to the called operator
 			 */
 
+			/*! \fn const std::string HexCall::getOperatorVersion() const
+			 * \brief Returns the version of the operator's implementation (only use this method for calls of type OperatorCall!)
+			 * \param std::string The version
+			 */
+
+			/*! \fn const std::vector<std::string> HexCall::getDependencies() const
+			 * \brief Returns the files the operator declares as dependencies (only use this method for calls of type OperatorCall!)
+			 * \param std::vector<std::string> The paths of the files (empty if the operator declares no dependencies)
+			 */
+
 			/*! \fn std::string OperatorArguments HexCall::getHashCode() const
 			 * \brief Returns the hash value for this call (only use this method for calls of type HexProgram or HexFile!)
 			 * \param std::string The hash value for this call
@@ -129,9 +160,87 @@ namespace dlvhex{
 			 * \param bool
 			 */
 
+			/*! \fn void HexCall::setLabel(const std::string& label)
+			 * \brief Sets the identifier of the call in the merging plan (e.g. result_dalal_bb1_bb2), which labels its measurements in the profile
+			 * \param label The identifier; calls which only differ in their labels are equivalent
+			 */
+
+			/*! \fn const std::string HexCall::getLabel() const
+			 * \brief Returns the identifier of the call in the merging plan (empty if unknown)
+			 * \return std::string The identifier
+			 */
+
+
+			/**
+			 * Sink of an operator application evaluated by the answer cache. Besides answer-sets, it accepts answers in binary answer format
+			 * (see BinaryAnswerWriter), which are decoded by the cache in the main thread. This allows ParallelSafe operators which need to
+			 * add atoms to the registry to compute their result in a child process while the application runs concurrently with others.
+			 */
+			class EncodedAnswerSink : public HexAnswerSink{
+			private:
+				std::vector<std::string>& encoded;
+				bool concurrent;
+			public:
+				EncodedAnswerSink(HexAnswer& target, std::vector<std::string>& encoded, bool concurrent) : HexAnswerSink(target), encoded(encoded), concurrent(concurrent){}
+				bool isConcurrent(){ return concurrent; }
+				void addEncoded(const std::string& answer){ encoded.push_back(answer); }
+			};
+
+			/*! \fn bool EncodedAnswerSink::isConcurrent()
+			 * \brief Returns true if other operator applications may run at the same time, i.e. the registry must not be modified
+			 */
+
+			/*! \fn void EncodedAnswerSink::addEncoded(const std::string& answer)
+			 * \brief Adds the answer-sets of an answer in binary format; they are appended to the result after the answer-sets added directly
+			 * \param answer The encoded answer
+			 */
+
+			/**
+			 * A single operator application which is evaluated in two phases: HexAnswerCache::prepare collects the arguments
+			 * (and looks up persistent results), evaluate computes the result, and HexAnswerCache::finish stores it in the cache.
+			 * Only evaluate may be called outside of the main thread, which allows independent applications of ParallelSafe operators
+			 * to run concurrently (see PlanScheduler).
+			 */
+			class OperatorApplication{
+			private:
+				friend class HexAnswerCache;
+
+				HexCall call;
+				OperatorAdapter adapter;
+				OperatorArguments parameters;
+				std::vector<HexAnswer*> answers;
+				std::vector<int> locked;
+				HexAnswer* result;
+				std::vector<std::string> encoded;	// answers added in binary format, decoded by the cache
+				std::string key;
+				bool evaluated;
+				bool stored;
+				ProfileRecord profile;
+
+				OperatorApplication(const OperatorApplication&);
+				OperatorApplication& operator=(const OperatorApplication&);
+			public:
+				OperatorApplication(const HexCall& call);
+				~OperatorApplication();
+				void evaluate(bool concurrent = false);
+			};
+
+			/*! \fn OperatorApplication::OperatorApplication(const HexCall& call)
+			 * \brief Constructs an application of the operator of an operator call
+			 * \param call The operator call (must be of type OperatorCall)
+			 */
+
+			/*! \fn void OperatorApplication::evaluate(bool concurrent)
+			 * \brief Computes the result of the application (does nothing if it was found in the persistent cache); must be called between HexAnswerCache::prepare and HexAnswerCache::finish
+			 * \param concurrent True if other applications may be evaluated at the same time (see EncodedAnswerSink::isConcurrent)
+			 * \throw IOperator::OperatorException If the operator fails
+			 */
 
 			/**
 			 * Manages the internal cache of hex answers. Removes old entries from the cache and reloads them in case of cache misses.
+			 * Results of operators which implement LazyOperator are stored as LazyAnswer; they are only materialized if they are passed to
+			 * another operator, while the access to single answer-sets (getAnswerSetCount, getAnswerSet) works directly on the view.
+			 * Results of pure operators can additionally be kept across runs in a PersistentCache.
 			 */
 			class HexAnswerCache{
 			private:
@@ -139,18 +248,31 @@ namespace dlvhex{
 				RegistryPtr reg;
 				typedef std::pair<HexCall, HexAnswer* > HexAnswerCacheEntry;
 				std::vector<HexAnswerCacheEntry> cache;
+				std::vector<LazyAnswerPtr> views;	// lazily evaluated answers (instead of the materialized one in cache)
 				std::vector<int> locks;
 				std::vector<long> accessCounter;
 				int elementsInCache;
 				int maxCacheEntries;
+				WorkerPool* pool;
+				PersistentCache* persistent;
+				DynamicAtoms* atoms;
+				PlanScheduler* scheduler;
+				Profiler* profiler;
+				std::map<int, ProfileRecord> jobs;	// measurements of submitted calls by worker slot
 
 				void load(const int index);
 				void access(const int index);
 				void reduceCache();
+				bool loaded(const int index);
+				HexAnswer* materialized(const int index);
 
-				HexAnswer* loadHexProgram(const HexCall& call);
-				HexAnswer* loadHexFile(const HexCall& call);
-				HexAnswer* loadOperatorCall(const HexCall& call);
+				bool profiling();
+				HexAnswer* loadHexProgram(const HexCall& call, ProfileRecord& record);
+				HexAnswer* loadHexFile(const HexCall& call, ProfileRecord& record);
+				HexAnswer* loadOperatorCall(const HexCall& call, LazyAnswerPtr& view, ProfileRecord& record);
+				void prepare(OperatorApplication& app, bool lookup);
+				void decode(OperatorApplication& app);
+				void release(OperatorApplication& app);
 			public:
 				class SubprogramAnswerSetCallback : public ModelCallback{
 				public:
@@ -163,8 +285,24 @@ namespace dlvhex{
 				~HexAnswerCache();
 				const int operator[](const HexCall call);
 				HexAnswer& operator[](const int);
+				int getAnswerSetCount(const int index);
+				InterpretationPtr getAnswerSet(const int index, const int answerset);
 				const int size();
 				void setProgramCtx(ProgramCtx& ctx);
+				void setWorkerPool(WorkerPool* pool);
+				void setPersistentCache(PersistentCache* persistent);
+				void setDynamicAtoms(DynamicAtoms* atoms);
+				void setPlanScheduler(PlanScheduler* scheduler);
+				void setProfiler(Profiler* profiler);
+
+				int find(const HexCall& call);
+				int insert(const HexCall& call, HexAnswer* result);
+				void prepare(OperatorApplication& app);
+				int finish(OperatorApplication& app);
+				void abort(OperatorApplication& app);
+				int submit(const HexCall& call);
+				bool ready(int slot, int timeout);
+				int collect(const HexCall& call, int slot);
 			};
 
 			/*! \fn HexAnswerCache::HexAnswerCache()
@@ -192,10 +330,99 @@ namespace dlvhex{
 			 * \param HexAnswer* A pointer to the answer of the hex call with the given index
 			 */
 
+			/*! \fn int HexAnswerCache::getAnswerSetCount(const int index)
+			 * \brief Returns the number of distinct answer-sets of a call without materializing lazily evaluated answers
+			 * \param index The index of the hex call
+			 * \return int The number of answer-sets
+			 */
+
+			/*! \fn InterpretationPtr HexAnswerCache::getAnswerSet(const int index, const int answerset)
+			 * \brief Returns a single answer-set of a call; for lazily evaluated answers, only this answer-set is computed
+			 * \param index The index of the hex call
+			 * \param answerset The 0-based index of the answer-set (must be less than getAnswerSetCount(index))
+			 * \return InterpretationPtr The answer-set
+			 */
+
 			/*! \fn const int size()
 			 * \brief Returns the current size of the cache
 			 * \param int The current size of the cache (including both elements that are actually in the cache and those that are currently outsourced but managed by the cache)
 			 */
+
+			/*! \fn void HexAnswerCache::setWorkerPool(WorkerPool* pool)
+			 * \brief Lets the cache evaluate nested hex programs and files in the given pool of solver processes instead of within this process
+			 * \param pool The worker pool to use; NULL (default) evaluates subprograms in-process
+			 */
+
+			/*! \fn void HexAnswerCache::setPersistentCache(PersistentCache* persistent)
+			 * \brief Lets the cache look up and store the results of pure operator applications (see IOperatorV2::Pure) in a persistent cache
+			 * \param persistent The persistent cache to use; NULL (default) computes all operator results
+			 */
+
+			/*! \fn void HexAnswerCache::setDynamicAtoms(DynamicAtoms* atoms)
+			 * \brief Lets the cache register the per-arity atoms referenced by nested programs before they are evaluated
+			 * \param atoms The registry of per-arity atoms
+			 */
+
+			/*! \fn void HexAnswerCache::setPlanScheduler(PlanScheduler* scheduler)
+			 * \brief Lets the cache evaluate the merging plan of the scheduler (if any) as soon as the first call is looked up
+			 * \param scheduler The scheduler to use; NULL (default) evaluates each call when it is looked up
+			 */
+
+			/*! \fn void HexAnswerCache::setProfiler(Profiler* profiler)
+			 * \brief Lets the cache measure each evaluation of an entry (wall and CPU time, memory, sizes of inputs and outputs)
+			 * \param profiler The profiler which collects the measurements; NULL (default) disables the measurements
+			 */
+
+			/*! \fn int HexAnswerCache::find(const HexCall& call)
+			 * \brief Retrieves the index of a call without adding it
+			 * \param call The hex call to look for
+			 * \return int 0-based index to the entry or -1 if the call is not in the cache
+			 */
+
+			/*! \fn int HexAnswerCache::insert(const HexCall& call, HexAnswer* result)
+			 * \brief Adds the result of a call which was computed outside of the cache; the cache takes the ownership of the result
+			 * (it is deleted if the call has already been loaded in the meantime)
+			 * \param call The computed hex call
+			 * \param result The answer of the call
+			 * \return int 0-based index to the entry
+			 */
+
+			/*! \fn void HexAnswerCache::prepare(OperatorApplication& app)
+			 * \brief Loads the arguments of an operator application and locks them in the cache until finish or abort is called
+			 * \param app The operator application
+			 * \throw IOperator::OperatorException If the operator does not recognize a passed parameter (the arguments are unlocked in this case)
+			 */
+
+			/*! \fn int HexAnswerCache::finish(OperatorApplication& app)
+			 * \brief Stores the result of an evaluated operator application in the cache and unlocks its arguments; answers which the operator
+			 *        added in binary format are decoded here (see EncodedAnswerSink)
+			 * \param app The operator application
+			 * \return int 0-based index to the entry
+			 * \throw PluginError If an encoded answer is corrupt (the arguments are unlocked anyway)
+			 */
+
+			/*! \fn void HexAnswerCache::abort(OperatorApplication& app)
+			 * \brief Unlocks the arguments of an operator application which failed
+			 * \param app The operator application
+			 */
+
+			/*! \fn int HexAnswerCache::submit(const HexCall& call)
+			 * \brief Sends a hex program or file call to the worker pool without waiting for the result
+			 * \param call The hex call (of type HexProgram or HexFile)
+			 * \return int The worker slot (pass it to ready and collect), or -1 if no worker pool is used or all workers are busy
+			 */
+
+			/*! \fn bool HexAnswerCache::ready(int slot, int timeout)
+			 * \brief Checks if the result of a submitted call has arrived (see WorkerPool::ready)
+			 */
+
+			/*! \fn int HexAnswerCache::collect(const HexCall& call, int slot)
+			 * \brief Waits for the result of a submitted call and adds it to the cache
+			 * \param call The submitted hex call
+			 * \param slot The worker slot returned by submit
+			 * \return int 0-based index to the entry
+			 * \throw PluginError If the worker fails
+			 */
 		}
 	}
 }
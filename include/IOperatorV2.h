@@ -0,0 +1,119 @@
+#ifndef __IOPERATORV2_H_
+#define __IOPERATORV2_H_
+
+#include "IOperator.h"
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Receives the answer-sets computed by an operator. The plugin passes a sink which writes directly into the storage of its answer cache.
+			 */
+			class AnswerSink{
+			public:
+				virtual ~AnswerSink(){}
+				virtual void reserve(int count){}
+				virtual void add(InterpretationPtr answerset) = 0;
+				virtual void addAll(HexAnswer& answer){
+					for (HexAnswer::iterator it = answer.begin(); it != answer.end(); ++it) add(*it);
+					answer.clear();
+				}
+			};
+
+			/**
+			 * Sink which appends the answer-sets to a HexAnswer.
+			 */
+			class HexAnswerSink : public AnswerSink{
+			private:
+				HexAnswer& target;
+			public:
+				HexAnswerSink(HexAnswer& t) : target(t){}
+				virtual void reserve(int count){ target.reserve(target.size() + count); }
+				virtual void add(InterpretationPtr answerset){ target.push_back(answerset); }
+				virtual void addAll(HexAnswer& answer){
+					if (target.size() == 0) target.swap(answer);
+					else{
+						target.insert(target.end(), answer.begin(), answer.end());
+						answer.clear();
+					}
+				}
+			};
+
+			/**
+			 * Second generation of the operator interface. Operators read their arguments through const views and write their result into a sink
+			 * instead of returning it by value, and they declare what the plugin may assume about them.
+			 * Since IOperatorV2 is an IOperator, such operators can be delivered by OPERATORIMPORTFUNCTION like any other operator; the plugin
+			 * recognizes them at run-time (operators which implement only IOperator are called through an adapter).
+			 */
+			class IOperatorV2 : public IOperator{
+			public:
+				/**
+				 * Properties of an operator (combined by bitwise or)
+				 */
+				enum Capability{
+					Pure = 1,		// the result depends only on the arguments, the parameters and the files declared by getDependencies (e.g. no clocks are read)
+					Streaming = 2,		// answer-sets are added to the sink one by one as they are computed
+					ParallelSafe = 4,	// evaluate may be called concurrently by several threads
+					SharesInputs = 8,	// the result may contain the interpretations of the arguments (rather than copies)
+				};
+
+				virtual int getCapabilities(const OperatorArguments& parameters){ return 0; }
+				virtual std::vector<std::string> getDependencies(const OperatorArguments& parameters){ return std::vector<std::string>(); }
+				virtual void evaluate(bool debug, const std::vector<const HexAnswer*>& answers, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException) = 0;
+
+				virtual HexAnswer apply(bool debug, int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters) throw (OperatorException){
+					std::vector<const HexAnswer*> args(answers.begin(), answers.end());
+					HexAnswer answer;
+					HexAnswerSink sink(answer);
+					evaluate(debug, args, parameters, sink);
+					return answer;
+				}
+			};
+		}
+	}
+}
+#endif
+
+
+/*! \fn void dlvhex::merging::plugin::AnswerSink::reserve(int count)
+ *  \brief Optional. Announces that (about) count answer-sets will be added
+ *  \param count The expected number of answer-sets
+ */
+
+/*! \fn void dlvhex::merging::plugin::AnswerSink::add(InterpretationPtr answerset)
+ *  \brief Adds one answer-set to the result
+ *  \param answerset The answer-set; it must not be modified afterwards
+ */
+
+/*! \fn void dlvhex::merging::plugin::AnswerSink::addAll(HexAnswer& answer)
+ *  \brief Adds all answer-sets of an answer to the result; the answer is left empty (its storage may be taken over by the sink)
+ *  \param answer The answer-sets to add
+ */
+
+/*! \fn int dlvhex::merging::plugin::IOperatorV2::getCapabilities(const OperatorArguments& parameters)
+ *  \brief Optional. Declares the properties of this operator
+ *  \param parameters The parameters of the application (e.g. an operator which is pure unless a timeout is given)
+ *  \return int Bitwise or of IOperatorV2::Capability values (default: none)
+ */
+
+/*! \fn std::vector<std::string> dlvhex::merging::plugin::IOperatorV2::getDependencies(const OperatorArguments& parameters)
+ *  \brief Optional. Lists the files which are read by an application of this operator; results of pure operators are cached by the
+ *         contents of these files, i.e. a result is recomputed whenever one of them has changed
+ *  \param parameters The parameters of the application
+ *  \return std::vector<std::string> Paths of the files (default: none)
+ */
+
+/*! \fn void dlvhex::merging::plugin::IOperatorV2::evaluate(bool debug, const std::vector<const HexAnswer*>& answers, const OperatorArguments& parameters, AnswerSink& result)
+ *  \brief Is called when an operator is applied.
+ *  \param debug Tells the operator if it is called in debug mode or not
+ *  \param answers A vector of pointers to the answers which represent the arguments passed to the operator (arity = answers.size())
+ *  \param parameters A vector of key-value tuples representing the parameters of the operator; the same key can occur arbitrary many times
+ *  \param result The sink where the answer-sets of the result are added
+ *  \throw OperatorException If the operator cannot be applied
+ */
+
+/*! \fn HexAnswer dlvhex::merging::plugin::IOperatorV2::apply(bool debug, int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters)
+ *  \brief Implements the first generation interface by collecting the answer-sets of evaluate
+ */
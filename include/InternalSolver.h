@@ -0,0 +1,87 @@
+#ifndef __INTERNALSOLVER_H_
+#define __INTERNALSOLVER_H_
+
+#include <PublicTypes.h>
+#include <dlvhex2/ProgramCtx.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Solves optimization programs generated by operators within the running dlvhex process, using the internal grounder and solver
+			 * (like SimulatorAtom does) instead of an external dlv process.
+			 * Weak constraints are not supported (programs containing them are rejected); instead the cost of each model is computed from the atoms
+			 * over a given optimization predicate (sum of their last arguments) while the models are enumerated, and only the models of minimum cost are kept.
+			 * Whenever a model improves the best cost so far, nogoods forbid all ground cost atoms above it, such that the solver prunes
+			 * the models which cannot be optimal (branch-and-bound).
+			 * With a time budget, the models are enumerated in a child process which streams each model that is not worse than the ones before;
+			 * the child is killed when the budget is exceeded (even while the solver searches for the next model) and the best models received
+			 * so far are delivered.
+			 */
+			class InternalSolver{
+			public:
+				/**
+				 * Receives the models of an enumeration as they are found
+				 */
+				class Listener{
+				public:
+					virtual ~Listener(){}
+					virtual void model(InterpretationPtr model, long cost) = 0;
+				};
+			private:
+				static ProgramCtx* ctx;
+
+				static void enumerate(const std::string& program, const std::vector<ID>& rules, InterpretationConstPtr facts, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, Listener& listener) throw (PluginError);
+				static bool enumerateForked(const std::string& program, const std::vector<ID>& rules, InterpretationConstPtr facts, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, Listener& listener, int timeout) throw (PluginError);
+			public:
+				static void setProgramCtx(ProgramCtx& ctx);
+				static bool available();
+				static bool solve(const std::string& program, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, HexAnswer& result, int timeout = 0) throw (PluginError);
+				static bool solve(const std::string& program, const std::vector<ID>& rules, InterpretationConstPtr facts, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, HexAnswer& result, int timeout = 0, Listener* listener = NULL) throw (PluginError);
+			};
+
+			/*! \fn void InternalSolver::Listener::model(InterpretationPtr model, long cost)
+			 * \brief Called for each model (projected to the filter predicates) whose costs are not above the costs of the models found before
+			 * \param model The model
+			 * \param cost The costs of the model
+			 */
+
+			/*! \fn void InternalSolver::setProgramCtx(ProgramCtx& ctx)
+			 * \brief Sets the program context whose registry is used for solving
+			 * \param ctx The program context of the running dlvhex instance
+			 */
+
+			/*! \fn bool InternalSolver::available()
+			 * \brief Returns true if a program context was set, i.e. the solver can be used
+			 * \return bool True if programs can be solved
+			 */
+
+			/*! \fn bool InternalSolver::solve(const std::string& program, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, HexAnswer& result, int timeout)
+			 * \brief Computes the optimal answer-sets of a program
+			 * \param program The program source code
+			 * \param maxint The maximum integer used for grounding
+			 * \param optPredicate The predicate whose atoms carry the costs of a model in their last argument; models of minimum total costs are optimal
+			 * \param filter The predicates to keep in the answer-sets (all if empty); answer-sets that coincide on these predicates are reported only once
+			 * \param result The answer where the optimal answer-sets are appended
+			 * \param timeout Time budget for the enumeration in milliseconds (0 = unlimited)
+			 * \return bool False if the enumeration was stopped by the timeout, i.e. the answer-sets are the best ones found so far but not proven to be optimal
+			 * \throw PluginError If the program cannot be parsed or solved, or if it contains weak constraints
+			 */
+
+			/*! \fn bool InternalSolver::solve(const std::string& program, const std::vector<ID>& rules, InterpretationConstPtr facts, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, HexAnswer& result, int timeout, Listener* listener)
+			 * \brief Like solve, but adds rules and facts which were already parsed into the registry of the program context (e.g. cached side constraints)
+			 * \param rules Additional rules
+			 * \param facts Additional facts (may be NULL)
+			 * \param listener Is informed about the models as they are found (may be NULL)
+			 */
+		}
+	}
+}
+
+#endif
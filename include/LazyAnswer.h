@@ -0,0 +1,132 @@
+#ifndef __LAZYANSWER_H_
+#define __LAZYANSWER_H_
+
+#include <PublicTypes.h>
+#include <IOperator.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			class LazyAnswer;
+			typedef boost::shared_ptr<LazyAnswer> LazyAnswerPtr;
+
+			/**
+			 * Answer which consists of the combinations of one answer-set from each of several answers (e.g. their unions), where the
+			 * operation is applied from left to right, i.e. A1 op A2 op ... op An.
+			 * The combined answer-sets are computed only when they are accessed (and memoized if desired) instead of materializing
+			 * the whole cross product. Answer-sets which occur multiple times in an operand are considered only once since they
+			 * would only produce duplicate combinations.
+			 * Materialization computes the combinations in bands of consecutive indices; each band is split into tiles which are
+			 * processed by a set of threads (each thread takes the next unprocessed tile), then the unique ones are kept. Within a tile,
+			 * the combination of all but the last operand is computed only once per change.
+			 * Different combinations may still coincide; the distinct ones are accessed through an index of their first occurrences, which
+			 * is built on the first access by hashing each combination without keeping it.
+			 */
+			class LazyAnswer{
+			public:
+				enum Operation{
+					Union,
+					Intersection,
+					Setminus,
+				};
+
+			private:
+				Operation operation;
+				std::vector<HexAnswer> operands;	// without duplicates
+				int count;
+				bool memoize;
+				boost::unordered_map<int, InterpretationPtr> computed;
+				bool materialized;
+				HexAnswer result;
+				bool indexed;
+				std::vector<int> distinct;	// index of the first occurrence of each distinct combination
+
+				struct Band;
+				static int threads;
+
+				void apply(InterpretationPtr set, InterpretationConstPtr operand) const;
+				InterpretationPtr combine(int index, int operandCount) const;
+				static void* combineTiles(void* band);
+				void buildIndex();
+			public:
+				LazyAnswer(Operation op, const std::vector<HexAnswer*>& operands, bool memoize = true) throw (IOperator::OperatorException);
+				int size() const;
+				InterpretationPtr get(int index);
+				int distinctSize();
+				InterpretationPtr getDistinct(int index);
+				HexAnswer& materialize();
+
+				static LazyAnswerPtr fromParameters(Operation op, const std::vector<HexAnswer*>& operands, OperatorArguments& parameters) throw (IOperator::OperatorException);
+				static void setThreads(int threads);
+			};
+
+			/*! \fn LazyAnswer::LazyAnswer(Operation op, const std::vector<HexAnswer*>& operands, bool memoize)
+			 * \brief Constructs a view of the combinations of several answers
+			 * \param op The operation applied to the answer-sets of each combination
+			 * \param operands The answers to combine (at least one; copied, i.e. the answers may be freed afterwards)
+			 * \param memoize If true, combined answer-sets are stored when they are accessed for the first time
+			 * \throw IOperator::OperatorException If the number of combinations exceeds the range of answer-set indices
+			 */
+
+			/*! \fn int LazyAnswer::size() const
+			 * \brief Returns the number of combinations (without computing them)
+			 */
+
+			/*! \fn InterpretationPtr LazyAnswer::get(int index)
+			 * \brief Computes (or looks up) a single combination
+			 * \param index 0-based index of the combination
+			 * \return InterpretationPtr The combined answer-set
+			 */
+
+			/*! \fn int LazyAnswer::distinctSize()
+			 * \brief Returns the number of distinct combinations (builds the index of distinct combinations if necessary)
+			 */
+
+			/*! \fn InterpretationPtr LazyAnswer::getDistinct(int index)
+			 * \brief Returns a single distinct combination
+			 * \param index 0-based index of the distinct combination (must be less than distinctSize())
+			 * \return InterpretationPtr The combined answer-set
+			 */
+
+			/*! \fn HexAnswer& LazyAnswer::materialize()
+			 * \brief Computes all combinations (once) and returns them without duplicates; the order is not related to the indices of get
+			 * \return HexAnswer& Reference to the answer-sets, which stay valid as long as the view exists
+			 */
+
+			/*! \fn LazyAnswerPtr LazyAnswer::fromParameters(Operation op, const std::vector<HexAnswer*>& operands, OperatorArguments& parameters)
+			 * \brief Constructs a view for an operator application; recognizes the operator parameter "memoize" ("true" or "false")
+			 * \param op The operation applied to the answer-sets of each combination
+			 * \param operands The answers passed to the operator
+			 * \param parameters The parameters passed to the operator
+			 * \throw IOperator::OperatorException If a parameter value is invalid or there are too many combinations
+			 */
+
+			/*! \fn void LazyAnswer::setThreads(int threads)
+			 * \brief Sets the number of threads used for materialization
+			 * \param threads The number of threads; 0 (default) uses one thread per online processor
+			 */
+
+			/**
+			 * Implemented by operators which can deliver their result as LazyAnswer. The answer cache prefers this method over
+			 * IOperator::apply such that large results are not materialized unless they are actually needed.
+			 */
+			class LazyOperator{
+			public:
+				virtual ~LazyOperator(){}
+				virtual LazyAnswerPtr applyLazy(int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters) throw (IOperator::OperatorException) = 0;
+			};
+
+			/*! \fn LazyAnswerPtr LazyOperator::applyLazy(int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters)
+			 * \brief Like IOperator::apply, but returns a view which computes the answer-sets on access
+			 * \throw IOperator::OperatorException If the operator cannot be applied
+			 */
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef __OPINTERSECTION_H_
+#define __OPINTERSECTION_H_
+
+#include "IOperator.h"
+#include "LazyAnswer.h"
+
+DLVHEX_NAMESPACE_USE
+
+using namespace dlvhex::merging;
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * This class implements the intersection operator. It merges the answer-sets by computing the intersection of one answer-set of each
+			 * argument.
+			 * Usage:
+			 * &operator["intersection", A, K](A)
+			 *	A(H1), ..., A(Hn)	... handles to n >= 2 answers
+			 *	K(memoize, b)		... If b is "true" (default), combined answer-sets are stored when they are accessed for the first time
+			 *	A			... answer to the operator result
+			 * The result is delivered as LazyAnswer, i.e. the answer-sets are only combined when they are accessed.
+			 */
+			class OpIntersection : public IOperator, public LazyOperator{
+			public:
+				virtual std::string getName();
+				virtual std::string getInfo();
+				virtual std::set<std::string> getRecognizedParameters();
+				virtual LazyAnswerPtr applyLazy(int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters) throw (OperatorException);
+				virtual HexAnswer apply(int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters) throw (OperatorException);
+			};
+		}
+	}
+}
+
+#endif
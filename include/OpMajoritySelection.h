@@ -1,10 +1,7 @@
 #ifndef __OPMAJORITYSELECTION_H_
 #define __OPMAJORITYSELECTION_H_
 
-#include "IOperator.h"
-
-#include <dlvhex2/Program.h>
-#include <dlvhex2/AtomSet.h>
+#include "IOperatorV2.h"
 
 DLVHEX_NAMESPACE_USE
 
@@ -15,19 +12,23 @@ namespace dlvhex{
 		namespace plugin{
 			/**
 			 * This class implements the majority selection operator. It expects one set of answer-sets and will keep only those answer-sets, that
-			 * build the majority concerning the acceptance or denial of a propositional predicate p.
+			 * build the majority concerning the acceptance or denial of the ground atoms over some predicates.
 			 * Usage:
 			 * &operator["majorityselection", A, K](A)
 			 *	A(H)			... handle to one answer
-			 *	K(majorityOf, p)	... p is the name of a propositional predicate; the operator will keep the answer-sets that build the majority concerning p
-			 *                                  (Note: Only the first occurrence of "majorityOf" is recognized!)
+			 *	K(majorityOf, p)	... p is the name of a predicate (of arbitrary arity); the operator will keep the answer-sets that build the majority
+			 *                                  concerning each ground atom over p (can be passed multiple times)
+			 * The votes are counted in one pass over the answer-sets, where the atoms over the selected predicates are resolved only once; of each
+			 * answer-set, only the atoms in the intersection with these atoms are visited.
+			 * The selected answer-sets are passed on without copying them.
 			 */
-			class OpMajoritySelection : public IOperator{
+			class OpMajoritySelection : public IOperatorV2{
 			public:
 				virtual std::string getName();
 				virtual std::string getInfo();
 				virtual std::set<std::string> getRecognizedParameters();
-				virtual HexAnswer apply(int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters) throw (OperatorException);
+				virtual int getCapabilities(const OperatorArguments& parameters);
+				virtual void evaluate(bool debug, const std::vector<const HexAnswer*>& answers, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException);
 			};
 		}
 	}
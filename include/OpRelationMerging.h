@@ -1,10 +1,7 @@
 #ifndef __OPRELATIONMERGING_H_
 #define __OPRELATIONMERGING_H_
 
-#include "IOperator.h"
-
-#include <dlvhex2/Program.h>
-#include <dlvhex2/AtomSet.h>
+#include "IOperatorV2.h"
 
 DLVHEX_NAMESPACE_USE
 
@@ -35,14 +32,16 @@ namespace dlvhex{
 			 *				    all sources agree upon it's value
 			 *				    that defines the key attributes in the merged schema (they must also be contained in each source)
 			 *	A			... answer to the operator result
+			 * If no rule is passed, the result is computed natively: the tuples of all sources are joined in a hash table on the key, and the
+			 * built-in rule and the default values are applied directly on the IDs of the values. Otherwise a merging program is solved by dlv.
 			 */
-			class OpRelationMerging : public IOperator{
-			private:
+			class OpRelationMerging : public IOperatorV2{
 			public:
 				virtual std::string getName();
 				virtual std::string getInfo();
 				virtual std::set<std::string> getRecognizedParameters();
-				virtual HexAnswer apply(int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters) throw (OperatorException);
+				virtual int getCapabilities(const OperatorArguments& parameters);
+				virtual void evaluate(bool debug, const std::vector<const HexAnswer*>& answers, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException);
 			};
 		}
 	}
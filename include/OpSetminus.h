@@ -2,6 +2,7 @@
 #define __OPSETMINUS_H_
 
 #include "IOperator.h"
+#include "LazyAnswer.h"
 
 DLVHEX_NAMESPACE_USE
 
@@ -11,17 +12,21 @@ namespace dlvhex{
 	namespace merging{
 		namespace plugin{
 			/**
-			 * This class implements the setminus operator. It computes the pairwise differences between answer sets.
+			 * This class implements the setminus operator. It computes the differences between answer sets, where the answer-sets of
+			 * all further arguments are subtracted from one of the first argument (from left to right).
 			 * Usage:
 			 * &operator["setminus", A,  K](A)
-			 *	A(H1), A(H2)		... handles to exactly 2 answers
+			 *	A(H1), ..., A(Hn)	... handles to n >= 2 answers
+			 *	K(memoize, b)		... If b is "true" (default), combined answer-sets are stored when they are accessed for the first time
 			 *	A			... answer to the operator result
+			 * The result is delivered as LazyAnswer, i.e. the answer-sets are only combined when they are accessed.
 			 */
-			class OpSetminus : public IOperator{
+			class OpSetminus : public IOperator, public LazyOperator{
 			public:
 				virtual std::string getName();
 				virtual std::string getInfo();
 				virtual std::set<std::string> getRecognizedParameters();
+				virtual LazyAnswerPtr applyLazy(int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters) throw (OperatorException);
 				virtual HexAnswer apply(int arity, std::vector<HexAnswer*>& answers, OperatorArguments& parameters) throw (OperatorException);
 			};
 		}
@@ -0,0 +1,43 @@
+#ifndef __OPERATORADAPTER_H_
+#define __OPERATORADAPTER_H_
+
+#include <IOperatorV2.h>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Makes an operator which implements only the first generation interface (IOperator) usable as IOperatorV2.
+			 * The result of apply is handed over to the sink without copying; no capabilities are declared since nothing is known about the operator.
+			 */
+			class OperatorAdapter : public IOperatorV2{
+			private:
+				IOperator* op;
+			public:
+				OperatorAdapter(IOperator* op);
+				static IOperatorV2* get(IOperator* op, OperatorAdapter& adapter);
+
+				virtual std::string getName();
+				virtual std::string getInfo();
+				virtual std::set<std::string> getRecognizedParameters();
+				virtual void evaluate(bool debug, const std::vector<const HexAnswer*>& answers, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException);
+			};
+
+			/*! \fn OperatorAdapter::OperatorAdapter(IOperator* op)
+			 * \brief Constructs an adapter for an operator
+			 * \param op The adapted operator
+			 */
+
+			/*! \fn static IOperatorV2* OperatorAdapter::get(IOperator* op, OperatorAdapter& adapter)
+			 * \brief Returns the second generation interface of an operator
+			 * \param op Some operator
+			 * \param adapter An adapter for op, which is returned if op does not implement IOperatorV2 itself
+			 * \return IOperatorV2* Either op or adapter
+			 */
+		}
+	}
+}
+
+#endif
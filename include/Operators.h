@@ -4,17 +4,18 @@
 #include <HexAnswerCache.h>
 #include <dlvhex2/ComfortPluginInterface.h>
 #include <stdlib.h>
+#include <sys/types.h>
+#include <map>
 #include <vector>
 #include <IOperator.h>
 
 #include "OpUnion.h"
 #include "OpSetminus.h"
-/*
+#include "OpIntersection.h"
+#include "OpMajoritySelection.h"
 #include "OpDalal.h"
 #include "OpDBO.h"
-#include "OpMajoritySelection.h"
 #include "OpRelationMerging.h"
-*/
 
 namespace dlvhex {
 	namespace merging {
@@ -27,6 +28,8 @@ namespace dlvhex {
 			 *	Op		... path to an operator library
 			 *	Params		... name of a unary predicate containing all the result indices which shall be passed to the operator
 			 *	R		... handle to the answer of the operator applicatoin
+			 * Operator libraries are opened when they are added, unless they are listed in the manifest file with their current modification
+			 * time and size; such libraries are only opened when one of their operators is requested for the first time.
 			 */
 			typedef std::vector<IOperator*> (*t_operatorImportFunction)();
 			class OperatorAtom : public PluginAtom
@@ -36,24 +39,69 @@ namespace dlvhex {
 				HexAnswerCache& resultsetCache;
 
 				std::map<std::string, IOperator*> operators;
+				std::map<std::string, std::string> versions;	// library and its modification time of each external operator
+
+				// libraries known from previous runs (path -> modification time, size and operator names)
+				struct ManifestEntry{
+					time_t mtime;
+					off_t size;
+					std::vector<std::string> operators;
+				};
+				std::string manifestFile;
+				std::map<std::string, ManifestEntry> manifest;
+				bool manifestChanged;
+				std::map<std::string, std::string> deferred;	// operators of libraries which are not opened yet (operator name -> library)
 
 				OpUnion _union;
 				OpSetminus _setminus;
-/*
+				OpIntersection _intersection;
+				OpMajoritySelection _majorityselection;
 				OpDalal _dalal;
 				OpDBO _dbo;
-				OpMajoritySelection _majorityselection;
 				OpRelationMerging _relationmerging;
-*/
 				void registerBuiltInOperators();
+				void checkUnique(std::string opname, std::string lib);
+				bool loadLibrary(std::string lib, std::vector<std::string>& names);
 			public:
 				OperatorAtom(HexAnswerCache &rsCache);
 				virtual ~OperatorAtom();
 				virtual void retrieve(const Query& query, Answer& answer) throw (PluginError);
 				void setMode(bool silentMode, bool debugMode);
+				void setManifest(std::string file);
+				void saveManifest();
 				void addOperators(std::string lib);
 				IOperator* getOperator(std::string opname);
+				HexCall makeCall(std::string opname, std::vector<int> arguments, OperatorArguments parameters);
 			};
+
+			/*! \fn void OperatorAtom::setManifest(std::string file)
+			 * \brief Reads the manifest which maps operator libraries to the names of their operators; must be called before addOperators
+			 * \param file Path to the manifest (it need not exist yet); an empty string opens all libraries when they are added
+			 */
+
+			/*! \fn void OperatorAtom::saveManifest()
+			 * \brief Writes the manifest if libraries were opened which were not listed (or outdated); write errors are ignored
+			 */
+
+			/*! \fn void OperatorAtom::addOperators(std::string lib)
+			 * \brief Adds the operators of a library or of all libraries (*.so) in a directory
+			 * \param lib Path to a library or directory
+			 * \throw PluginError If an operator name is not unique
+			 */
+
+			/*! \fn IOperator* OperatorAtom::getOperator(std::string opname)
+			 * \brief Returns an operator; opens its library if this was deferred
+			 * \param opname The name of the operator
+			 * \throw IOperator::OperatorException If no operator with this name was loaded
+			 */
+
+			/*! \fn HexCall OperatorAtom::makeCall(std::string opname, std::vector<int> arguments, OperatorArguments parameters)
+			 * \brief Returns the identifier of an operator application exactly as &operator constructs it
+			 * \param opname The name of the operator
+			 * \param arguments The cache indices of the answers passed to the operator
+			 * \param parameters The key-value pairs passed to the operator
+			 * \throw IOperator::OperatorException If no operator with this name was loaded
+			 */
 		}
 	}
 }
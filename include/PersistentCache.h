@@ -0,0 +1,118 @@
+#ifndef __PERSISTENTCACHE_H_
+#define __PERSISTENTCACHE_H_
+
+#include <PublicTypes.h>
+#include <IOperator.h>
+#include <dlvhex2/Registry.h>
+
+#include <boost/unordered_map.hpp>
+
+#include <sys/types.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Stores the results of pure operator applications in a directory such that they survive the dlvhex process
+			 * (e.g. a dalal revision over the same sources and constraint files in consecutive runs).
+			 * An entry is identified by a key which covers everything the result depends on: the operator and its version, its parameters,
+			 * the contents of the files it declares as dependencies and the contents of its arguments. The key is computed
+			 * from the contents (rather than from names or handles), thus it is stable across runs.
+			 * Entries are written in the binary answer format (see BinaryAnswerWriter).
+			 * The fingerprints of dependency files are remembered by path and only computed again if the modification time or size changes.
+			 */
+			class PersistentCache{
+			private:
+				struct FileFingerprint{
+					time_t mtime;
+					off_t size;
+					std::string fingerprint;
+				};
+
+				std::string directory;
+				static boost::unordered_map<std::string, FileFingerprint> files;
+
+				std::string path(const std::string& key) const;
+			public:
+				static const char* const BUILTIN_VERSION;	// version of all built-in operators in the keys
+
+				PersistentCache();
+				void setDirectory(std::string directory);
+				bool enabled() const;
+
+				std::string key(const std::string& operatorName, const std::string& operatorVersion, const OperatorArguments& parameters, const std::vector<std::string>& dependencies, const std::vector<const HexAnswer*>& answers, RegistryPtr reg) const;
+				bool load(const std::string& key, RegistryPtr reg, HexAnswer& answer) const;
+				void store(const std::string& key, RegistryPtr reg, const HexAnswer& answer) const;
+
+				static std::string fingerprint(const std::string& data);
+				static std::string fingerprintFile(const std::string& filename);
+				static std::string stampFile(const std::string& filename);
+				static std::string fingerprintAnswer(RegistryPtr reg, const HexAnswer& answer);
+			};
+
+			/*! \fn PersistentCache::PersistentCache()
+			 * \brief Constructs a disabled cache
+			 */
+
+			/*! \fn void PersistentCache::setDirectory(std::string directory)
+			 * \brief Sets the directory where the entries are stored; it is created if it does not exist. An empty string disables the cache.
+			 * \param directory Path to the cache directory
+			 * \throw PluginError If the directory cannot be created
+			 */
+
+			/*! \fn bool PersistentCache::enabled() const
+			 * \brief Returns true if a cache directory is set
+			 */
+
+			/*! \fn std::string PersistentCache::key(const std::string& operatorName, const OperatorArguments& parameters, const std::vector<std::string>& dependencies, const std::vector<const HexAnswer*>& answers, RegistryPtr reg) const
+			 * \brief Computes the key of an operator application
+			 * \param operatorName The name of the applied operator
+			 * \param operatorVersion The version of the operator's implementation (see HexCall::getOperatorVersion)
+			 * \param parameters The key-value parameters (their order does not matter)
+			 * \param dependencies The files the operator depends on (see HexCall::getDependencies); their contents are part of the key
+			 * \param answers The arguments of the operator (in order)
+			 * \param reg The registry the atoms of the arguments are stored in
+			 * \return std::string The key
+			 */
+
+			/*! \fn bool PersistentCache::load(const std::string& key, RegistryPtr reg, HexAnswer& answer) const
+			 * \brief Looks up an entry
+			 * \param key The key of the operator application
+			 * \param reg The registry to store the atoms of the entry in
+			 * \param answer The answer where the answer-sets are appended
+			 * \return bool True if the entry was found; false if it does not exist or is unreadable (the answer is left unchanged in this case)
+			 */
+
+			/*! \fn void PersistentCache::store(const std::string& key, RegistryPtr reg, const HexAnswer& answer) const
+			 * \brief Writes an entry; the file is replaced atomically such that concurrent runs never read partial entries. Write errors are ignored.
+			 * \param key The key of the operator application
+			 * \param reg The registry the atoms of the answer are stored in
+			 * \param answer The result of the operator application
+			 */
+
+			/*! \fn std::string PersistentCache::fingerprint(const std::string& data)
+			 * \brief Computes a stable 128 bit hash value (as hex string) of a string; it is not meant to be secure against deliberate collisions
+			 */
+
+			/*! \fn std::string PersistentCache::fingerprintFile(const std::string& filename)
+			 * \brief Computes the fingerprint of the contents of a file; missing files have a fingerprint of their own.
+			 * The file is only read if it was not fingerprinted before or if its modification time or size changed since then.
+			 */
+
+			/*! \fn std::string PersistentCache::stampFile(const std::string& filename)
+			 * \brief Returns the modification time and size of a file (without reading it), which identify its version within a run
+			 */
+
+			/*! \fn std::string PersistentCache::fingerprintAnswer(RegistryPtr reg, const HexAnswer& answer)
+			 * \brief Computes the fingerprint of an answer, which does not depend on the order of answer-sets and atoms, nor on the IDs of the atoms
+			 */
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,90 @@
+#ifndef __PLANSCHEDULER_H_
+#define __PLANSCHEDULER_H_
+
+#include <HexAnswerCache.h>
+#include <CodeGenerator.h>
+#include <Profiler.h>
+#include <dlvhex2/ProgramCtx.h>
+
+#include <vector>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			class OperatorAtom;
+
+			/**
+			 * Evaluates the belief bases and operator applications of a compiled merging plan before dlvhex evaluates the translated program.
+			 * The plan is a DAG (each node lists the nodes it takes as arguments), thus independent nodes can be computed concurrently:
+			 * belief bases are sent to the worker pool (if enabled) and applications of ParallelSafe operators (see IOperatorV2) run in threads.
+			 * All other nodes are evaluated one by one in the main thread. The results are stored in the answer cache under the same
+			 * identifiers which the external atoms of the translated program construct, such that their evaluation becomes a cache lookup.
+			 * Nodes which fail are skipped (together with the nodes depending on them); the error is reported by the regular evaluation.
+			 */
+			class PlanScheduler{
+			private:
+				ProgramCtx* ctx;
+				OperatorAtom* operatorAtom;
+				Profiler* profiler;
+				int threads;
+				bool debug;
+				std::vector<dlvhex::merging::tools::mpcompiler::PlanNode> plan;
+
+				HexCall makeCall(const dlvhex::merging::tools::mpcompiler::PlanNode& node, const std::vector<int>& arguments);
+			public:
+				PlanScheduler();
+				void setProgramCtx(ProgramCtx& ctx);
+				void setOperatorAtom(OperatorAtom* operatorAtom);
+				void setThreads(int threads);
+				void setProfiler(Profiler* profiler);
+				void setDebug(bool debug);
+
+				void setPlan(const std::vector<dlvhex::merging::tools::mpcompiler::PlanNode>& plan);
+				bool hasPlan();
+				void run(HexAnswerCache& cache);
+			};
+
+			/*! \fn PlanScheduler::PlanScheduler()
+			 * \brief Constructs a scheduler without a plan which uses one thread per online processor
+			 */
+
+			/*! \fn void PlanScheduler::setProgramCtx(ProgramCtx& ctx)
+			 * \brief Sets the program context whose registry the belief bases are evaluated in (must be called before run)
+			 */
+
+			/*! \fn void PlanScheduler::setOperatorAtom(OperatorAtom* operatorAtom)
+			 * \brief Sets the atom which provides the operators (must be called before run)
+			 */
+
+			/*! \fn void PlanScheduler::setThreads(int threads)
+			 * \brief Sets the maximum number of operator applications which are evaluated concurrently; 0 disables the scheduler
+			 */
+
+			/*! \fn void PlanScheduler::setProfiler(Profiler* profiler)
+			 * \brief Lets the scheduler label the measurements of the evaluated nodes with their result identifiers (e.g. result_dalal_bb1_bb2)
+			 */
+
+			/*! \fn void PlanScheduler::setDebug(bool debug)
+			 * \brief Enables the report of the total work, the critical path and the elapsed time of each plan (written to standard error)
+			 */
+
+			/*! \fn void PlanScheduler::setPlan(const std::vector<dlvhex::merging::tools::mpcompiler::PlanNode>& plan)
+			 * \brief Sets the plan to evaluate (ignored if the scheduler is disabled)
+			 * \param plan The nodes of the plan as generated by CodeGenerator (arguments precede the nodes using them)
+			 */
+
+			/*! \fn bool PlanScheduler::hasPlan()
+			 * \brief Returns true if a plan was set which was not evaluated yet
+			 */
+
+			/*! \fn void PlanScheduler::run(HexAnswerCache& cache)
+			 * \brief Evaluates the plan and stores all results in the cache; afterwards the plan is removed
+			 * \param cache The answer cache used by the external atoms
+			 */
+		}
+	}
+}
+
+#endif
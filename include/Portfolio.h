@@ -0,0 +1,84 @@
+#ifndef __PORTFOLIO_H_
+#define __PORTFOLIO_H_
+
+#include <PublicTypes.h>
+
+#include <sys/types.h>
+#include <string>
+#include <vector>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Runs alternative computations of the same result in parallel processes and takes the result of the one that finishes first.
+			 * Usage (similar to fork):
+			 *	Portfolio portfolio;
+			 *	if (portfolio.start("configuration 1")){
+			 *		// child process: compute the result and deliver it (never returns)
+			 *		portfolio.deliver(result);
+			 *	}
+			 *	...
+			 *	int winner = portfolio.wait(result);
+			 * Each member runs in its own process group such that processes spawned by a member (e.g. external solvers) are terminated together
+			 * with the member.
+			 */
+			class Portfolio{
+			private:
+				struct Member{
+					std::string name;
+					pid_t pid;
+					int fd;
+					std::string output;
+				};
+
+				std::vector<Member> members;
+				int channel;		// write end of the pipe in a child process, -1 in the parent
+
+				void terminate(int member);
+			public:
+				Portfolio();
+				~Portfolio();
+
+				bool start(const std::string& name) throw (PluginError);
+				void deliver(const std::string& result);
+				void fail(const std::string& message);
+
+				int wait(std::string& result) throw (PluginError);
+				std::string getName(int member);
+			};
+
+			/*! \fn bool Portfolio::start(const std::string& name)
+			 * \brief Forks a new member
+			 * \param name The name of the member (for reporting)
+			 * \return bool True in the child process, which must end by calling deliver or fail; false in the parent process
+			 * \throw PluginError If the process could not be created
+			 */
+
+			/*! \fn void Portfolio::deliver(const std::string& result)
+			 * \brief Sends the result of a member to the parent process and terminates the member (must only be called in a child process)
+			 * \param result The result computed by the member
+			 */
+
+			/*! \fn void Portfolio::fail(const std::string& message)
+			 * \brief Reports an error to the parent process and terminates the member (must only be called in a child process)
+			 * \param message The error message
+			 */
+
+			/*! \fn int Portfolio::wait(std::string& result)
+			 * \brief Waits until the first member delivers its result and terminates all other members.
+			 * \param result Reference to the string where the result of the winning member is written to
+			 * \return int The index of the winning member (in the order of start)
+			 * \throw PluginError If all members failed
+			 */
+
+			/*! \fn std::string Portfolio::getName(int member)
+			 * \brief Returns the name of a member
+			 */
+		}
+	}
+}
+
+#endif
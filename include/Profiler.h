@@ -0,0 +1,139 @@
+#ifndef __PROFILER_H_
+#define __PROFILER_H_
+
+#include <PublicTypes.h>
+#include <dlvhex2/Interpretation.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			/**
+			 * Measurement of a single evaluation of a cache entry (operator application, nested program or program file).
+			 * Values which cannot be measured (e.g. the CPU time of a program evaluated by a worker process) are -1.
+			 */
+			struct ProfileRecord{
+				bool active;			// begin and end only measure if set
+				std::string name;		// operator name, "program" or the path of the program file
+				std::string label;		// identifier in the merging plan (see HexCall::getLabel; empty if unknown)
+				int index;			// cache index of the result
+				int thread;			// lane in the trace (see Profiler::MainThread)
+				double start;			// seconds since the epoch
+				double wall;			// seconds
+				double cpu;			// CPU seconds of the evaluating thread
+				long memory;			// growth of the peak resident set size of this process in KB
+				int answersetsIn, answersetsOut;
+				long atomsIn, atomsOut;
+
+				ProfileRecord(bool active = false);
+				void begin();
+				void end();
+				void addInputs(const std::vector<HexAnswer*>& answers);
+				void addFacts(InterpretationConstPtr facts);
+				void setOutput(const HexAnswer& answer);
+			};
+
+			/*! \fn ProfileRecord::ProfileRecord(bool active)
+			 * \brief Constructs an empty record
+			 * \param active True if the evaluation shall actually be measured (profiling enabled)
+			 */
+
+			/*! \fn void ProfileRecord::begin()
+			 * \brief Starts the measurement in the calling thread
+			 */
+
+			/*! \fn void ProfileRecord::end()
+			 * \brief Stops the measurement; must be called by the same thread as begin
+			 */
+
+			/*! \fn void ProfileRecord::addInputs(const std::vector<HexAnswer*>& answers)
+			 * \brief Adds the answer-sets and atoms of the arguments of an operator to the input counts
+			 */
+
+			/*! \fn void ProfileRecord::addFacts(InterpretationConstPtr facts)
+			 * \brief Adds the input facts of a nested program to the input counts
+			 */
+
+			/*! \fn void ProfileRecord::setOutput(const HexAnswer& answer)
+			 * \brief Sets the output counts to the answer-sets and atoms of a result
+			 */
+
+			/**
+			 * Collects the measurements of all evaluations of cache entries (see HexAnswerCache) during a dlvhex run and writes
+			 * a profile table (sorted by wall time) and a trace in Chrome's trace event format (chrome://tracing) at the end of the run.
+			 * Entries of merging plans are labeled with the result identifiers of the translated plan (e.g. result_dalal_bb1_bb2):
+			 * operator applications carry them in their calls, belief bases are labeled if the plan is evaluated by the PlanScheduler.
+			 */
+			class Profiler{
+			public:
+				enum{
+					MainThread = 0,		// lanes 1..n are other threads of this process
+					WorkerLane = 1000,	// lanes WorkerLane + slot are worker processes
+				};
+
+			private:
+				std::string file;
+				std::vector<ProfileRecord> records;
+				std::map<int, std::string> labels;
+				pthread_mutex_t mutex;
+
+				std::string getLabel(const ProfileRecord& record);
+				void writeTable(std::ostream& os, std::vector<ProfileRecord> sorted);
+				void writeTrace(std::ostream& os);
+			public:
+				Profiler();
+				~Profiler();
+				void setFile(std::string file);
+				bool enabled();
+				void add(const ProfileRecord& record);
+				void setLabel(int index, std::string label);
+				void write();
+
+				static int getThread();
+			};
+
+			/*! \fn Profiler::Profiler()
+			 * \brief Constructs a disabled profiler
+			 */
+
+			/*! \fn Profiler::~Profiler()
+			 * \brief Writes the profile (if enabled)
+			 */
+
+			/*! \fn void Profiler::setFile(std::string file)
+			 * \brief Enables profiling; the table is written to file and the trace to file.trace.json. An empty string disables profiling.
+			 */
+
+			/*! \fn bool Profiler::enabled()
+			 * \brief Returns true if a profile file is set
+			 */
+
+			/*! \fn void Profiler::add(const ProfileRecord& record)
+			 * \brief Adds a finished measurement (may be called by any thread)
+			 */
+
+			/*! \fn void Profiler::setLabel(int index, std::string label)
+			 * \brief Labels all measurements of a cache entry
+			 * \param index The cache index of the entry
+			 * \param label The identifier of the entry in the merging plan
+			 */
+
+			/*! \fn void Profiler::write()
+			 * \brief Writes the profile table and the trace; write errors are ignored
+			 */
+
+			/*! \fn static int Profiler::getThread()
+			 * \brief Returns the lane of the calling thread (MainThread for the first thread which asks)
+			 */
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef __WORKERPOOL_H_
+#define __WORKERPOOL_H_
+
+#include <PublicTypes.h>
+#include <dlvhex2/ProgramCtx.h>
+
+#include <sys/types.h>
+#include <ostream>
+#include <string>
+#include <vector>
+
+DLVHEX_NAMESPACE_USE
+
+namespace dlvhex{
+	namespace merging{
+		namespace plugin{
+			class DynamicAtoms;
+
+			/**
+			 * Manages a pool of long-lived solver processes for nested hex programs.
+			 * Each worker is forked from the running dlvhex instance, i.e. it already has all plugins loaded. Programs are sent to the workers over a
+			 * socket using a simple framed protocol; the workers evaluate them as subprograms and send back the answer-sets.
+			 * Workers that crash are restarted transparently, workers that served a certain number of jobs are recycled in order to keep their registry small.
+			 */
+			class WorkerPool{
+			public:
+				/**
+				 * Kinds of jobs a worker can process
+				 */
+				enum JobType{
+					Program,
+					File,
+				};
+
+			private:
+				struct Worker{
+					pid_t pid;
+					int fd;
+					int jobs;
+					bool busy;
+					JobType type;
+					bool binary;
+					std::string program;
+					std::string facts;
+				};
+
+				ProgramCtx* ctx;
+				DynamicAtoms* atoms;
+				std::vector<Worker> workers;
+				int poolSize;
+				int maxJobsPerWorker;
+				int nextWorker;
+				bool binaryProtocol;
+
+				void spawnWorker(int slot);
+				void stopWorker(int slot, bool kill);
+				void serve(int fd);
+				int submitJob(JobType type, std::string program, InterpretationConstPtr facts, bool binary);
+				void sendJob(int slot);
+				bool receiveAnswer(int slot, std::string& answer, std::string& error);
+				bool finishJob(int slot, std::string& result);
+
+			public:
+				WorkerPool();
+				~WorkerPool();
+				void setProgramCtx(ProgramCtx& ctx);
+				void setSize(int workers);
+				int getSize();
+				bool enabled();
+				bool idle();
+				bool ready(int slot, int timeout);
+				void setBinaryProtocol(bool binary);
+				void setDynamicAtoms(DynamicAtoms* atoms);
+
+				int submit(JobType type, std::string program, InterpretationConstPtr facts);
+				void collectText(int slot, std::ostream& answer);
+				void collect(int slot, HexAnswer& answer);
+				void solveText(JobType type, std::string program, std::ostream& answer);
+				void solve(JobType type, std::string program, InterpretationConstPtr facts, HexAnswer& answer);
+			};
+
+			/*! \fn WorkerPool::WorkerPool()
+			 * \brief Constructs an empty (disabled) worker pool. Workers are forked lazily when the first job is submitted.
+			 */
+
+			/*! \fn WorkerPool::~WorkerPool()
+			 * \brief Terminates all worker processes
+			 */
+
+			/*! \fn void WorkerPool::setProgramCtx(ProgramCtx& ctx)
+			 * \brief Sets the program context the workers use for evaluating subprograms (must be called before the first job is submitted)
+			 * \param ctx The program context of the running dlvhex instance
+			 */
+
+			/*! \fn void WorkerPool::setSize(int workers)
+			 * \brief Sets the number of worker processes; 0 disables the pool.
+			 * \param workers The number of worker processes
+			 */
+
+			/*! \fn void WorkerPool::setBinaryProtocol(bool binary)
+			 * \brief Selects the format in which workers return answers to collect: the compact binary format (default) or dlvhex' textual output format
+			 * \param binary True for the binary format (see BinaryAnswerWriter), false for the textual format
+			 */
+
+			/*! \fn void WorkerPool::setDynamicAtoms(DynamicAtoms* atoms)
+			 * \brief Lets the workers register the per-arity atoms referenced by a program before they evaluate it
+			 * \param atoms The registry of per-arity atoms
+			 */
+
+			/*! \fn bool WorkerPool::enabled()
+			 * \brief Returns true if the pool has at least one worker slot
+			 * \return bool True if jobs can be submitted to this pool
+			 */
+
+			/*! \fn bool WorkerPool::idle()
+			 * \brief Returns true if a job can be submitted without waiting for another one
+			 */
+
+			/*! \fn bool WorkerPool::ready(int slot, int timeout)
+			 * \brief Checks if the result of a submitted job has arrived, i.e. if collect will not block
+			 * \param slot The worker slot returned by submit
+			 * \param timeout Maximum time in milliseconds to wait for the result (0 returns immediately)
+			 * \return bool True if the result can be collected
+			 */
+
+			/*! \fn int WorkerPool::submit(JobType type, std::string program, InterpretationConstPtr facts)
+			 * \brief Sends a job to an idle worker without waiting for the result
+			 * \param type Program if program contains source code, File if it is a path
+			 * \param program The program source code or path to a program (depending on type)
+			 * \param facts Additional input facts for the program (may be a null pointer)
+			 * \return int The worker slot that processes the job; pass it to collect or collectText
+			 */
+
+			/*! \fn void WorkerPool::collectText(int slot, std::ostream& answer)
+			 * \brief Waits for the result of a submitted job and writes the answer-sets in dlvhex' output format (one answer-set per line).
+			 * \param slot The worker slot returned by submit
+			 * \param answer The stream to write the answer-sets to
+			 * \throw PluginError If the job failed or the worker crashed twice
+			 */
+
+			/*! \fn void WorkerPool::collect(int slot, HexAnswer& answer)
+			 * \brief Waits for the result of a submitted job and adds the answer-sets to the registry of this dlvhex instance
+			 * \param slot The worker slot returned by submit
+			 * \param answer The answer where the answer-sets are appended
+			 * \throw PluginError If the job failed or the worker crashed twice
+			 */
+		}
+	}
+}
+
+#endif
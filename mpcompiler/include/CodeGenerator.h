@@ -9,22 +9,53 @@
 #include <ParseTreeNode.h>
 
 #include <iostream>
+#include <map>
+#include <string>
+#include <vector>
 
 namespace dlvhex{
 	namespace merging{
 		namespace tools{
 			namespace mpcompiler{
+				/**
+				 * Node of a merging plan as it is translated by the code generator: a belief base or an operator application.
+				 * The strings are exactly those which the external atoms of the generated program receive.
+				 */
+				struct PlanNode{
+					enum Type{
+						Program,	// belief base given by mapping rules (&callhex0)
+						File,		// belief base given by an external program (&callhexfile0)
+						Operator,	// operator application (&operator)
+					};
+
+					Type type;
+					std::string id;							// result identifier in the generated program (e.g. result_dalal_bb1_bb2)
+					std::string source;						// program or file name
+					std::string operatorname;
+					std::vector<std::pair<std::string, std::string> > parameters;	// key-value arguments of the operator
+					std::vector<int> arguments;					// indices of the argument nodes (-1 for undefined belief bases)
+
+					// key of the key-value argument which passes the result identifier to &operator (it is not passed on to the operator)
+					static const char* labelParameter(){ return "@label"; }
+				};
+
 				class CodeGenerator{
 					private:
 						ParseTreeNode *parsetreeroot;
 						bool codegenerated;
 						int errorcount;
 						int warningcount;
+						std::vector<PlanNode> plan;
+						std::map<std::string, PlanNode> beliefbases;	// by belief base name
+						std::map<std::string, int> plannodes;		// index in plan by result identifier
 
 						void translateBeliefBase(ParseTreeNode *parsetree, std::ostream &os, std::ostream &err);
 						std::string translateRevisionPlan(ParseTreeNode *parsetree, std::ostream &os, std::ostream &err);
 						std::string translateRevisionPlan_composed(ParseTreeNode *parsetree, std::ostream &os, std::ostream &err);
 						std::string translateRevisionPlan_beliefbase(ParseTreeNode *parsetree, std::ostream &os, std::ostream &err);
+						std::string getOperatorName(ParseTreeNode *parsetree);
+						bool hasOperatorParameters(ParseTreeNode *parsetree);
+						void collectSources(ParseTreeNode *parsetree, std::string operatorname, std::vector<ParseTreeNode*> &sources);
 						void writeAnswerSetExtraction(ParseTreeNode *parsetree, std::ostream &os, std::ostream &err);
 						std::string quote(std::string code);
 						std::string unquote(std::string code);
@@ -36,6 +67,7 @@ namespace dlvhex{
 						bool succeeded();
 						bool codeGenerated();
 						void generateCode(std::ostream &os, std::ostream &err);
+						const std::vector<PlanNode>& getPlan();
 				};
 			}
 		}
@@ -45,47 +77,47 @@ namespace dlvhex{
 #endif
 
 
-/*! \fn dlvhex::merging::tools::rpcompiler::CodeGenerator::CodeGenerator(ParseTreeNode *parsetree)
+/*! \fn dlvhex::merging::tools::rpcompiler::CodeGenerator::CodeGenerator(ParseTreeNode *parsetree)
  *  \brief Initializes the code generator for a certain parse tree.
- *  \param parsetree A pointer to a parsetree created by an IParser instance.
+ *  \param parsetree A pointer to a parsetree created by an IParser instance.
  */
 
-/*! \fn static std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::quote(std::string code)
+/*! \fn static std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::quote(std::string code)
  *  \brief Quotes dlv progarm code for &hex and &hexfile calls s.t. the character " is avoided.
- *  \param code dlv program code
- *  \return std::string dlv program code without the character ". \ is escaped as \\, " is escaped as \'
+ *  \param code dlv program code
+ *  \return std::string dlv program code without the character ". \ is escaped as \\, " is escaped as \'
  */
 
-/*! \fn static std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::unquote(std::string code)
+/*! \fn static std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::unquote(std::string code)
  *  \brief Unquotes dlv progarm code for &hex and &hexfile calls.
- *  \param code dlv program code
- *  \return std::string unquoted dlv program code
+ *  \param code dlv program code
+ *  \return std::string unquoted dlv program code
  */
 
-/*! \fn void dlvhex::merging::tools::rpcompiler::CodeGenerator::translateBeliefBase(ParseTreeNode *parsetree, std::ostream &os, std::ostream &os)
+/*! \fn void dlvhex::merging::tools::rpcompiler::CodeGenerator::translateBeliefBase(ParseTreeNode *parsetree, std::ostream &os, std::ostream &os)
  *  \brief Translates the definitions for one belief base.
  *  \param parsetree Pointer to the belief base root node.
- *  \param os An output stream to write the code to
+ *  \param os An output stream to write the code to
  *  \param err An output stream to write error messages to
  */
 
-/*! \fn std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::translateRevisionPlan(ParseTreeNode *parsetree, std::ostream &os, std::ostream &os)
+/*! \fn std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::translateRevisionPlan(ParseTreeNode *parsetree, std::ostream &os, std::ostream &os)
  *  \brief Translates one hierarchie level of the revision plan
  *  \param parsetree Pointer to the current node in the revision plan.
  *  \param os An output stream to write the code to
  *  \param err An output stream to write error messages to
- *  \return std::string Name of this result or 	intermediate result consisting of the belief base names delimited by underscores
+ *  \return std::string Name of this result or 	intermediate result consisting of the belief base names delimited by underscores
  */
 
-/*! \fn std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::translateRevisionPlan_composed(ParseTreeNode *parsetree, std::ostream &os, std::ostream &os)
+/*! \fn std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::translateRevisionPlan_composed(ParseTreeNode *parsetree, std::ostream &os, std::ostream &os)
  *  \brief Translates one hierarchie level of a composed revision plan (operator application)
  *  \param parsetree Pointer to the root node of a composed revision plan.
  *  \param os An output stream to write the code to
- *  \return std::string Name of this intermediate result consisting of the belief base names delimited by underscores
+ *  \return std::string Name of this intermediate result consisting of the belief base names delimited by underscores
  *  \param err An output stream to write error messages to
  */
 
-/*! \fn std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::translateRevisionPlan_beliefbase(ParseTreeNode *parsetree, std::ostream &os, std::ostream &os)
+/*! \fn std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::translateRevisionPlan_beliefbase(ParseTreeNode *parsetree, std::ostream &os, std::ostream &os)
  *  \brief Translates an access to a belief base as used in a revision plan
  *  \param parsetree Pointer to the root node of a belief base usage
  *  \param os An output stream to write the code to
@@ -93,42 +125,66 @@ namespace dlvhex{
  *  \return std::string Name of this result or 	intermediate consisting of the belief base name prefixed by "_"
  */
 
-/*! \fn void dlvhex::merging::tools::rpcompiler::CodeGenerator::writeAnswerSetExtraction(ParseTreeNode *parsetree, std::ostream &os, std::ostream &err)
+/*! \fn std::string dlvhex::merging::tools::rpcompiler::CodeGenerator::getOperatorName(ParseTreeNode *parsetree)
+ *  \brief Returns the operator used in a composed revision plan section
+ *  \param parsetree Pointer to the root node of a composed revision plan.
+ *  \return std::string Value of the key "operator" (or the empty string if the key is missing)
+ */
+
+/*! \fn bool dlvhex::merging::tools::rpcompiler::CodeGenerator::hasOperatorParameters(ParseTreeNode *parsetree)
+ *  \brief Checks if a composed revision plan section contains key-value pairs other than "operator"
+ *  \param parsetree Pointer to the root node of a composed revision plan.
+ *  \return bool True if run-time arguments are passed to the operator
+ */
+
+/*! \fn void dlvhex::merging::tools::rpcompiler::CodeGenerator::collectSources(ParseTreeNode *parsetree, std::string operatorname, std::vector<ParseTreeNode*> &sources)
+ *  \brief Collects the information sources of a composed revision plan, where nested applications of an n-ary operator without run-time arguments are inlined (union and intersection at any position, setminus only at the first position)
+ *  \param parsetree Pointer to the root node of a composed revision plan.
+ *  \param operatorname The operator whose nested applications are inlined ("" for none)
+ *  \param sources Vector where the (belief base or revision plan) sources are appended
+ */
+
+/*! \fn void dlvhex::merging::tools::rpcompiler::CodeGenerator::writeAnswerSetExtraction(ParseTreeNode *parsetree, std::ostream &os, std::ostream &err)
  *  \brief Writes hex code which extracts the answer sets from the sub programs and transfers their content into the real answer sets of this program. This step requires the common signature from the parse tree in order to determine the public predicates.
  *  \param parsetree Pointer to the current node in the revision plan.
  *  \param os An output stream to write the code to
  *  \param err An output stream to write error messages to
  */
 
-/*! \fn void dlvhex::merging::tools::rpcompiler::CodeGenerator::ParseTreeNode *parsetree)
- *  \brief Prepares this instance for code generation for a given parse tree.
+/*! \fn void dlvhex::merging::tools::rpcompiler::CodeGenerator::ParseTreeNode *parsetree)
+ *  \brief Prepares this instance for code generation for a given parse tree.
  *  \param parsetree Pointer to the root of the parse tree.
  */
 
-/*! \fn int dlvhex::merging::tools::rpcompiler::CodeGenerator::getErrorCount()
+/*! \fn int dlvhex::merging::tools::rpcompiler::CodeGenerator::getErrorCount()
  *  \brief Returns the number of errors which occurred during the last code generation (last call of generateCode). If no code has been generated so far, error count will always trivially be 0. Call codeGenerated() to check if code has been generated.
- *  \return int The number of errors which occurred during code generation
+ *  \return int The number of errors which occurred during code generation
  */
 
-/*! \fn int dlvhex::merging::tools::rpcompiler::CodeGenerator::getWarningCount()
+/*! \fn int dlvhex::merging::tools::rpcompiler::CodeGenerator::getWarningCount()
  *  \brief Returns the number of warnings which occurred during code generation. If no code has been generated so far, warning count will always trivially be 0. Call codeGenerated() to check if code has been generated.
- *  \return int The number of warnings which occurred during code generation
+ *  \return int The number of warnings which occurred during code generation
  */
 
-/*! \fn bool dlvhex::merging::tools::rpcompiler::CodeGenerator::succeeded()
+/*! \fn bool dlvhex::merging::tools::rpcompiler::CodeGenerator::succeeded()
  *  \brief Returns true iff the last code generation (last call of generateCode) finished without errors _and_ code has been generated so far.
- *  \return bool True if the last code generation (last call of generateCode) finished without errors _and_ code has been generated so far, otherwise false.
+ *  \return bool True if the last code generation (last call of generateCode) finished without errors _and_ code has been generated so far, otherwise false.
  */
 
-/*! \fn bool dlvhex::merging::tools::rpcompiler::CodeGenerator::codeGenerated()
+/*! \fn bool dlvhex::merging::tools::rpcompiler::CodeGenerator::codeGenerated()
  *  \brief Returns true iff code has been generated so far (i.e. at least one call of generateCode() occurred)
- *  \return bool True if code has been generated so far, otherwise false
+ *  \return bool True if code has been generated so far, otherwise false
  */
 
-/*! \fn void dlvhex::merging::tools::rpcompiler::CodeGenerator::generateCode(std::ostream &os, std::ostream &err)
- *  \brief Generates the output code for a given parsetree.
+/*! \fn void dlvhex::merging::tools::rpcompiler::CodeGenerator::generateCode(std::ostream &os, std::ostream &err)
+ *  \brief Generates the output code for a given parsetree.
  *  \param parsetree Pointer to the root of the parse tree.
  *  \param os An output stream to write the code to
  *  \param err An output stream to write error messages to
- *  \return int The number of errors which occurred during code generation
+ *  \return int The number of errors which occurred during code generation
+ */
+
+/*! \fn const std::vector<PlanNode>& dlvhex::merging::tools::rpcompiler::CodeGenerator::getPlan()
+ *  \brief Returns the merging plan translated by the last call of generateCode, where the arguments of a node always precede it
+ *  \return const std::vector<PlanNode>& The belief bases and operator applications of the plan
  */
@@ -33,6 +33,9 @@ void CodeGenerator::generateCode(std::ostream &os, std::ostream &err){
 	ParseTreeNode *parsetree = parsetreeroot;
 	errorcount = 0;
 	warningcount = 0;
+	plan.clear();
+	beliefbases.clear();
+	plannodes.clear();
 
 	// Write mappings for belief bases
 	os << "% -------------------- Mappings for belief bases -------------------- " << std::endl;
@@ -156,20 +159,30 @@ void CodeGenerator::translateBeliefBase(ParseTreeNode *parsetree, std::ostream &
 		errorcount++;
 		err << "Error during code generation for revision plan: Either mapping rules OR an external program can be defined. For belief base \"" << name << "\" both were found." << std::endl;
 	}else{
+		PlanNode node;
 		if (externalprogram){
 			os << "sources(" << name << ", AnswerNr) :- &callhexfile0[\"";
 			os << filename;
 			os << "\"](" << "AnswerNr" << ")." << std::endl;
+			node.type = PlanNode::File;
+			node.source = filename;
 // , \"" << args << (useInputRewriter ? std::string(" --inputrewriter=\"") + inputrewriter + std::string("\"") : "") << "\"
 		}else{
 			os << "sources(" << name << ", AnswerNr) :- &callhex0[\"";
 			os << mappings;
 			os << "\"](" << "AnswerNr" << ")." << std::endl;
 // , \"" << args << (useInputRewriter ? std::string(" --inputrewriter=\"") + inputrewriter + std::string("\"") : "") << "\"
+			node.type = PlanNode::Program;
+			node.source = mappings;
 		}
+		beliefbases[name] = node;
 	}
 }
 
+const std::vector<PlanNode>& CodeGenerator::getPlan(){
+	return plan;
+}
+
 // Translates one revision plan section recursively
 std::string CodeGenerator::translateRevisionPlan(ParseTreeNode *parsetree, std::ostream &os, std::ostream &err){
 	// Check for errors during code generation for revision plans: Type of information source must be either a belief base or a composed revision plan
@@ -189,6 +202,55 @@ std::string CodeGenerator::translateRevisionPlan(ParseTreeNode *parsetree, std::
 	assert(0);
 }
 
+// Returns the value of the "operator" key of a composed revision plan section (or "" if there is none)
+std::string CodeGenerator::getOperatorName(ParseTreeNode *parsetree){
+	assert(parsetree->getType() == ParseTreeNode::revisionplansection);
+
+	if (parsetree->begin(ParseTreeNode::kvpairs) != parsetree->end()){
+		for (ParseTreeNodeIterator it = parsetree->begin(ParseTreeNode::kvpairs)->begin(ParseTreeNode::kvpair); it != parsetree->begin(ParseTreeNode::kvpairs)->end(); ++it){
+			if (((StringTreeNode*)(it->getChild(0)))->getValue() == std::string("operator")){
+				return unquote(((StringTreeNode*)(it->getChild(1)))->getValue());
+			}
+		}
+	}
+	return std::string("");
+}
+
+// Checks if a composed revision plan section passes key-value pairs other than "operator" to its operator
+bool CodeGenerator::hasOperatorParameters(ParseTreeNode *parsetree){
+	assert(parsetree->getType() == ParseTreeNode::revisionplansection);
+
+	if (parsetree->begin(ParseTreeNode::kvpairs) != parsetree->end()){
+		for (ParseTreeNodeIterator it = parsetree->begin(ParseTreeNode::kvpairs)->begin(ParseTreeNode::kvpair); it != parsetree->begin(ParseTreeNode::kvpairs)->end(); ++it){
+			if (((StringTreeNode*)(it->getChild(0)))->getValue() != std::string("operator")) return true;
+		}
+	}
+	return false;
+}
+
+// Collects the information sources of a composed revision plan section. Nested applications of the same associative operator
+// (union, intersection) are inlined, such that the operator is applied once to all of their sources; for setminus, only the
+// first source may be inlined since A \ B \ C = (A \ B) \ C, but A \ (B \ C) is different.
+void CodeGenerator::collectSources(ParseTreeNode *parsetree, std::string operatorname, std::vector<ParseTreeNode*> &sources){
+	assert(parsetree->getType() == ParseTreeNode::revisionplansection);
+
+	if (parsetree->begin(ParseTreeNode::revisionsources) == parsetree->end()) return;
+
+	bool first = true;
+	for (ParseTreeNodeIterator it = parsetree->begin(ParseTreeNode::revisionsources)->begin(); it != parsetree->begin(ParseTreeNode::revisionsources)->end(); ++it){
+		bool flatten =	it->getType() == ParseTreeNode::revisionplansection &&
+				getOperatorName(&(*it)) == operatorname &&
+				!hasOperatorParameters(&(*it)) &&
+				(operatorname == std::string("union") || operatorname == std::string("intersection") || (operatorname == std::string("setminus") && first));
+		if (flatten){
+			collectSources(&(*it), operatorname, sources);
+		}else{
+			sources.push_back(&(*it));
+		}
+		first = false;
+	}
+}
+
 // Translation of composed revision plan sections
 std::string CodeGenerator::translateRevisionPlan_composed(ParseTreeNode *parsetree, std::ostream &os, std::ostream &err){
 	assert(parsetree->getType() == ParseTreeNode::revisionplansection);
@@ -212,14 +274,19 @@ std::string CodeGenerator::translateRevisionPlan_composed(ParseTreeNode *parsetr
 	// This requires that all sub revision plans are generated before, since the unique identifier is constructed by concatenating the identifiers of all sub operator applications.
 	std::string operatorapplicationidsugg = std::string("");
 	std::vector<std::string> answerargidentifiers;
-	if (parsetree->begin(ParseTreeNode::revisionsources) != parsetree->end()){
-		for (ParseTreeNodeIterator it = parsetree->begin(ParseTreeNode::revisionsources)->begin(); it != parsetree->begin(ParseTreeNode::revisionsources)->end(); ++it){
-			// Recursive generation of revision plans
-			std::string subrvid = translateRevisionPlan(&(*it), os, err);
-			answerargidentifiers.push_back(subrvid);
-			// Unique operator application identifier consists of all identifiers of the sub-revision plans (separated by "_")
-			operatorapplicationidsugg = operatorapplicationidsugg + subrvid;
-		}
+	std::vector<ParseTreeNode*> sources;
+	if (hasOperatorParameters(parsetree)){
+		collectSources(parsetree, std::string(""), sources);
+	}else{
+		// n-ary operators are applied once to the sources of nested applications instead of materializing each intermediate result
+		collectSources(parsetree, getOperatorName(parsetree), sources);
+	}
+	for (std::vector<ParseTreeNode*>::iterator it = sources.begin(); it != sources.end(); ++it){
+		// Recursive generation of revision plans
+		std::string subrvid = translateRevisionPlan(*it, os, err);
+		answerargidentifiers.push_back(subrvid);
+		// Unique operator application identifier consists of all identifiers of the sub-revision plans (separated by "_")
+		operatorapplicationidsugg = operatorapplicationidsugg + subrvid;
 	}
 	// if this does not make the identifier unique yet (in case that the same sub-merging plan is contained twice), add a running number
 	int ri = 0;
@@ -239,6 +306,8 @@ std::string CodeGenerator::translateRevisionPlan_composed(ParseTreeNode *parsetr
 	// The two types of arguments are assembled for the current operator application in the following two big blocks
 
 	// Handle key-value pairs in the current revision plan section
+	PlanNode node;
+	node.type = PlanNode::Operator;
 	bool firstarg = true;
 	if (parsetree->begin(ParseTreeNode::kvpairs) != parsetree->end()){
 		for (ParseTreeNodeIterator it = parsetree->begin(ParseTreeNode::kvpairs)->begin(ParseTreeNode::kvpair); it != parsetree->begin(ParseTreeNode::kvpairs)->end(); ++it){
@@ -260,10 +329,20 @@ std::string CodeGenerator::translateRevisionPlan_composed(ParseTreeNode *parsetr
 				// Collect the key-value pairs in a new predicate which is unique for this operator application
 				kvarguments << "kv_arg" << operatorapplicationid << "(" << key << ",\"" << quote(value) << "\").";
 				firstarg = false;
+
+				// quoted keys are passed without quotes (like all string constants)
+				if (key.length() >= 2 && key[0] == '\"' && key[key.length() - 1] == '\"') key = key.substr(1, key.length() - 2);
+				node.parameters.push_back(std::pair<std::string, std::string>(key, quote(value)));
 			}
 		}
 	}
 
+	// the result identifier labels the application in profiles, however the program is evaluated
+	if (!firstarg){
+		kvarguments << std::endl;
+	}
+	kvarguments << "kv_arg" << operatorapplicationid << "(\"" << PlanNode::labelParameter() << "\",\"result_" << operatorname << operatorapplicationid << "\").";
+
 	// Generate code for the sets of answer sets arguments of the operator
 	int i = 1;
 	firstarg = true;
@@ -280,6 +359,7 @@ std::string CodeGenerator::translateRevisionPlan_composed(ParseTreeNode *parsetr
 		// "Copy" the handles to the answers which shall be passed to the parameter into a new predicate which is unique
 		// for this operator application
 		answerarguments << "answersets_arg" << operatorapplicationid << "(" << (i - 1) << ", R" << i << ") :- results(result" << arg << ", R" << i << ").";
+		node.arguments.push_back(plannodes.find(arg) != plannodes.end() ? plannodes[arg] : -1);
 
 		firstarg = false;
 		i++;
@@ -297,6 +377,11 @@ std::string CodeGenerator::translateRevisionPlan_composed(ParseTreeNode *parsetr
 	os << "results(result" << "_" << operatorname << operatorapplicationid << ", AnswerNr) :- " << "&operator[\"" << operatorname << "\", answersets_arg" << operatorapplicationid << ", kv_arg" << operatorapplicationid << "](AnswerNr)." << std::endl;
 	os << std::endl;
 
+	node.operatorname = operatorname;
+	node.id = std::string("result_") + operatorname + operatorapplicationid;
+	plannodes[std::string("_") + operatorname + operatorapplicationid] = plan.size();
+	plan.push_back(node);
+
 	return std::string("_") + operatorname + operatorapplicationid;
 }
 
@@ -308,6 +393,12 @@ std::string CodeGenerator::translateRevisionPlan_beliefbase(ParseTreeNode *parse
 	std::string operatorapplicationid = ((StringTreeNode*)parsetree->getChild(0))->getValue();
 	os << "% Using belief base " << operatorapplicationid << std::endl;
 	os << "results(result_" << operatorapplicationid << ", AnswerNr) :- sources(" << operatorapplicationid << ", AnswerNr)." << std::endl;
+	// belief bases which are used several times are evaluated only once
+	if (plannodes.find(std::string("_") + operatorapplicationid) == plannodes.end() && beliefbases.find(operatorapplicationid) != beliefbases.end()){
+		plannodes[std::string("_") + operatorapplicationid] = plan.size();
+		plan.push_back(beliefbases[operatorapplicationid]);
+		plan.back().id = std::string("result_") + operatorapplicationid;
+	}
 	operatorapplicationid = std::string("_") + operatorapplicationid;
 	os << std::endl;
 
@@ -0,0 +1,72 @@
+#include <AnswerFormat.h>
+
+#include <dlvhex2/Printer.h>
+#include <dlvhex2/Interpretation.h>
+
+#include <boost/functional/hash.hpp>
+
+#include <sstream>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+bool AnswerFormat::printAtom(RegistryPtr reg, std::ostream& o, ID ogid){
+	RawPrinter printer(o, reg);
+	if (!ogid.isAuxiliary()){
+		printer.print(ogid);
+		return true;
+	}
+
+	// strongly negated atoms are auxiliary atoms over the positive predicate
+	const OrdinaryAtom& ogatom = reg->ogatoms.getByID(ogid);
+	if (reg->getTypeByAuxiliaryConstantSymbol(ogatom.tuple[0]) != 's') return false;
+	o << "-";
+	printer.print(reg->getIDByAuxiliaryConstantSymbol(ogatom.tuple[0]));
+	if (ogatom.tuple.size() > 1){
+		o << "(";
+		for (int i = 1; i < ogatom.tuple.size(); i++){
+			if (i > 1) o << ",";
+			printer.print(ogatom.tuple[i]);
+		}
+		o << ")";
+	}
+	return true;
+}
+
+std::string AnswerFormat::formatAnswerSet(InterpretationConstPtr answerset){
+	RegistryPtr reg = answerset->getRegistry();
+	std::stringstream ss, atom;
+	bool first = true;
+	ss << "{";
+	for (Interpretation::Storage::enumerator it = answerset->getStorage().first(); it != answerset->getStorage().end(); ++it){
+		atom.str("");
+		if (printAtom(reg, atom, reg->ogatoms.getIDByAddress(*it))){
+			if (!first) ss << ",";
+			ss << atom.str();
+			first = false;
+		}
+	}
+	ss << "}";
+	return ss.str();
+}
+
+std::string AnswerFormat::formatFacts(InterpretationConstPtr facts){
+	if (facts == InterpretationConstPtr()) return "";
+
+	RegistryPtr reg = facts->getRegistry();
+	std::stringstream ss;
+	for (Interpretation::Storage::enumerator it = facts->getStorage().first(); it != facts->getStorage().end(); ++it){
+		if (printAtom(reg, ss, reg->ogatoms.getIDByAddress(*it))){
+			ss << "." << std::endl;
+		}
+	}
+	return ss.str();
+}
+
+std::size_t AnswerFormat::hashAnswerSet(InterpretationConstPtr answerset){
+	std::size_t seed = 0;
+	for (Interpretation::Storage::enumerator it = answerset->getStorage().first(); it != answerset->getStorage().end(); ++it){
+		boost::hash_combine(seed, *it);
+	}
+	return seed;
+}
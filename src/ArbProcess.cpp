@@ -0,0 +1,131 @@
+#include <ArbProcess.h>
+
+#include <dlvhex2/PluginInterface.h>
+
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+// size of the chunks passed between the streams and the pipes
+static const size_t CHUNKSIZE = 1 << 20;
+
+int ArbProcess::filter(std::istream& in, std::ostream& out){
+	// prepare the argument vector for execvp
+	std::vector<std::string> cmd = commandline();
+	if (cmd.size() == 0) throw PluginError("No command given");
+	std::vector<char*> argv;
+	for (int i = 0; i < cmd.size(); i++) argv.push_back(const_cast<char*>(cmd[i].c_str()));
+	argv.push_back(NULL);
+
+	int toChild[2], fromChild[2];
+	if (pipe(toChild) != 0) throw PluginError("Could not create pipe for \"" + executionstring + "\"");
+	if (pipe(fromChild) != 0){
+		close(toChild[0]);
+		close(toChild[1]);
+		throw PluginError("Could not create pipe for \"" + executionstring + "\"");
+	}
+
+	out.flush();
+	std::cout.flush();
+	std::cerr.flush();
+
+	pid_t pid = fork();
+	if (pid < 0){
+		close(toChild[0]); close(toChild[1]);
+		close(fromChild[0]); close(fromChild[1]);
+		throw PluginError("Could not fork \"" + executionstring + "\"");
+	}
+	if (pid == 0){
+		dup2(toChild[0], STDIN_FILENO);
+		dup2(fromChild[1], STDOUT_FILENO);
+		close(toChild[0]); close(toChild[1]);
+		close(fromChild[0]); close(fromChild[1]);
+		execvp(argv[0], &argv[0]);
+		_exit(127);
+	}
+	close(toChild[0]);
+	close(fromChild[1]);
+	int wfd = toChild[1];
+	int rfd = fromChild[0];
+	fcntl(wfd, F_SETFL, fcntl(wfd, F_GETFL) | O_NONBLOCK);
+
+	// a process which exits before it has read all of its input must not kill us with SIGPIPE
+	struct sigaction ignore, previous;
+	ignore.sa_handler = SIG_IGN;
+	sigemptyset(&ignore.sa_mask);
+	ignore.sa_flags = 0;
+	sigaction(SIGPIPE, &ignore, &previous);
+
+	std::vector<char> inbuf(CHUNKSIZE), outbuf(CHUNKSIZE);
+	size_t inpos = 0, inlen = 0;
+	bool inputDone = false;
+
+	while (wfd >= 0 || rfd >= 0){
+		// refill the input buffer
+		if (wfd >= 0 && inpos == inlen && !inputDone){
+			inlen = in.rdbuf()->sgetn(&inbuf[0], CHUNKSIZE);
+			inpos = 0;
+			if (inlen == 0) inputDone = true;
+		}
+		if (wfd >= 0 && inputDone){
+			close(wfd);
+			wfd = -1;
+		}
+
+		struct pollfd fds[2];
+		int nfds = 0;
+		if (rfd >= 0){
+			fds[nfds].fd = rfd;
+			fds[nfds].events = POLLIN;
+			nfds++;
+		}
+		if (wfd >= 0){
+			fds[nfds].fd = wfd;
+			fds[nfds].events = POLLOUT;
+			nfds++;
+		}
+		if (nfds == 0) break;
+		if (poll(fds, nfds, -1) < 0){
+			if (errno == EINTR) continue;
+			break;
+		}
+
+		for (int f = 0; f < nfds; f++){
+			if (fds[f].revents == 0) continue;
+			if (fds[f].fd == rfd){
+				ssize_t r = read(rfd, &outbuf[0], CHUNKSIZE);
+				if (r > 0){
+					out.write(&outbuf[0], r);
+				}else if (r == 0 || errno != EINTR){
+					close(rfd);
+					rfd = -1;
+				}
+			}else{
+				ssize_t w = write(wfd, &inbuf[inpos], inlen - inpos);
+				if (w > 0){
+					inpos += w;
+				}else if (w < 0 && errno != EINTR && errno != EAGAIN){
+					// the process does not accept more input
+					close(wfd);
+					wfd = -1;
+				}
+			}
+		}
+	}
+
+	sigaction(SIGPIPE, &previous, NULL);
+
+	int status;
+	while (waitpid(pid, &status, 0) < 0){
+		if (errno != EINTR) return -1;
+	}
+	return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
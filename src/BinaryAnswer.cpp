@@ -0,0 +1,179 @@
+#include <BinaryAnswer.h>
+
+#include <dlvhex2/Interpretation.h>
+
+#include <sstream>
+#include <string.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+static const char MAGIC[4] = { 'H', 'X', 'A', '1' };
+static const uint32_t INTEGER_FLAG = 0x80000000;
+static const uint32_t STRONGNEG_FLAG = 0x80000000;
+
+
+// -------------------- Util (local functions!) --------------------
+
+static void appendInt(std::string& buf, uint32_t value){
+	buf.append((const char*)&value, sizeof(uint32_t));
+}
+
+
+// ---------- BinaryAnswerWriter ----------
+
+BinaryAnswerWriter::BinaryAnswerWriter(RegistryPtr reg) : reg(reg), termCount(0), answersetCount(0){
+}
+
+uint32_t BinaryAnswerWriter::encodeTerm(ID term){
+	if (term.isIntegerTerm()){
+		assert((term.address & INTEGER_FLAG) == 0);
+		return term.address | INTEGER_FLAG;
+	}
+
+	if (term.address >= termIndex.size()) termIndex.resize(term.address + 1, 0);
+	if (termIndex[term.address] == 0){
+		const std::string& symbol = reg->terms.getByID(term).symbol;
+		appendInt(terms, symbol.length());
+		terms.append(symbol);
+		termIndex[term.address] = ++termCount;
+	}
+	return termIndex[term.address] - 1;
+}
+
+void BinaryAnswerWriter::add(InterpretationConstPtr answerset){
+	// reserve space for the number of atoms
+	size_t countPos = answersets.size();
+	appendInt(answersets, 0);
+
+	uint32_t atomCount = 0;
+	for (Interpretation::Storage::enumerator it = answerset->getStorage().first(); it != answerset->getStorage().end(); ++it){
+		ID ogid = reg->ogatoms.getIDByAddress(*it);
+		const OrdinaryAtom& ogatom = reg->ogatoms.getByID(ogid);
+
+		// strongly negated atoms are auxiliary atoms over the positive predicate, all other auxiliary atoms are internal
+		bool strongneg = false;
+		if (ogid.isAuxiliary()){
+			if (reg->getTypeByAuxiliaryConstantSymbol(ogatom.tuple[0]) != 's') continue;
+			strongneg = true;
+		}
+
+		appendInt(answersets, ogatom.tuple.size() | (strongneg ? STRONGNEG_FLAG : 0));
+		appendInt(answersets, encodeTerm(strongneg ? reg->getIDByAuxiliaryConstantSymbol(ogatom.tuple[0]) : ogatom.tuple[0]));
+		for (int i = 1; i < ogatom.tuple.size(); i++){
+			appendInt(answersets, encodeTerm(ogatom.tuple[i]));
+		}
+		atomCount++;
+	}
+	memcpy(&answersets[countPos], &atomCount, sizeof(uint32_t));
+	answersetCount++;
+}
+
+void BinaryAnswerWriter::add(const HexAnswer& answer){
+	for (HexAnswer::const_iterator it = answer.begin(); it != answer.end(); ++it){
+		add(*it);
+	}
+}
+
+void BinaryAnswerWriter::write(std::string& out){
+	out.reserve(out.size() + 12 + terms.size() + answersets.size());
+	out.append(MAGIC, 4);
+	appendInt(out, termCount);
+	out.append(terms);
+	appendInt(out, answersetCount);
+	out.append(answersets);
+}
+
+
+// ---------- BinaryAnswerReader ----------
+
+BinaryAnswerReader::BinaryAnswerReader(const char* data, size_t size) : pos(data), end(data + size){
+}
+
+BinaryAnswerReader::BinaryAnswerReader(const std::string& data) : pos(data.data()), end(data.data() + data.size()){
+}
+
+uint32_t BinaryAnswerReader::readInt(){
+	if (end - pos < (ptrdiff_t)sizeof(uint32_t)) throw PluginError("Binary answer is truncated");
+	uint32_t value;
+	memcpy(&value, pos, sizeof(uint32_t));
+	pos += sizeof(uint32_t);
+	return value;
+}
+
+bool BinaryAnswerReader::isBinaryAnswer(const char* data, size_t size){
+	return size >= 4 && memcmp(data, MAGIC, 4) == 0;
+}
+
+void BinaryAnswerReader::read(RegistryPtr reg, HexAnswer& answer) throw (PluginError){
+	if (!isBinaryAnswer(pos, end - pos)) throw PluginError("Invalid binary answer");
+	pos += 4;
+
+	// term table: register each symbol once
+	uint32_t termCount = readInt();
+	std::vector<ID> terms;
+	terms.reserve(termCount);
+	for (uint32_t t = 0; t < termCount; t++){
+		uint32_t len = readInt();
+		if ((size_t)(end - pos) < len) throw PluginError("Binary answer is truncated");
+		std::string symbol(pos, len);
+		pos += len;
+		ID id = reg->terms.getIDByString(symbol);
+		if (id == ID_FAIL){
+			Term term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, symbol);
+			id = reg->storeTerm(term);
+		}
+		terms.push_back(id);
+	}
+
+	// answer-sets
+	uint32_t answersetCount = readInt();
+	OrdinaryAtom atom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+	for (uint32_t a = 0; a < answersetCount; a++){
+		InterpretationPtr intr(new Interpretation(reg));
+		uint32_t atomCount = readInt();
+		for (uint32_t i = 0; i < atomCount; i++){
+			uint32_t size = readInt();
+			bool strongneg = (size & STRONGNEG_FLAG) != 0;
+			size &= ~STRONGNEG_FLAG;
+			if (size == 0) throw PluginError("Invalid binary answer");
+			atom.tuple.resize(size);
+			for (uint32_t t = 0; t < size; t++){
+				uint32_t value = readInt();
+				if (value & INTEGER_FLAG){
+					atom.tuple[t] = ID::termFromInteger(value & ~INTEGER_FLAG);
+				}else{
+					if (value >= terms.size()) throw PluginError("Invalid term index in binary answer");
+					atom.tuple[t] = terms[value];
+				}
+			}
+
+			ID predicate = atom.tuple[0];
+			if (strongneg){
+				atom.kind = ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG | ID::PROPERTY_AUX;
+				atom.tuple[0] = reg->getAuxiliaryConstantSymbol('s', predicate);
+			}else{
+				atom.kind = ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG;
+			}
+
+			// atoms which are already known (e.g. from before the worker was forked) need no textual representation
+			ID id = reg->ogatoms.getIDByTuple(atom.tuple);
+			if (id == ID_FAIL){
+				std::stringstream text;
+				if (strongneg) text << "-";
+				for (uint32_t t = 0; t < size; t++){
+					if (t == 1) text << "(";
+					if (t > 1) text << ",";
+					ID term = t == 0 ? predicate : atom.tuple[t];
+					if (term.isIntegerTerm()) text << term.address;
+					else text << reg->terms.getByID(term).symbol;
+				}
+				if (size > 1) text << ")";
+				atom.text = text.str();
+				id = reg->storeOrdinaryGAtom(atom);
+			}
+			intr->setFact(id.address);
+		}
+		answer.push_back(intr);
+	}
+}
@@ -0,0 +1,113 @@
+#include <ConstraintCache.h>
+
+#include <dlvhex2/ProgramCtx.h>
+#include <dlvhex2/HexParser.h>
+#include <dlvhex2/InputProvider.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <sys/stat.h>
+#include <sys/time.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+
+// ---------- ConstraintCache ----------
+
+boost::unordered_map<std::string, ConstraintCache::Entry> ConstraintCache::constraints;
+boost::unordered_map<std::string, ConstraintCache::Entry> ConstraintCache::files;
+
+void ConstraintCache::parse(RegistryPtr reg, const std::string& source, Entry& entry){
+	double start = now();
+
+	// parse into a subcontext sharing the registry, such that the IDs can be used in the programs of the operators
+	ProgramCtx pc;
+	pc.changeRegistry(reg);
+	InputProviderPtr ip(new InputProvider());
+	ip->addStringInput(source, "constraints");
+	ModuleHexParser hp;
+	hp.parse(ip, pc);
+
+	entry.reg = reg;
+	entry.source = source;
+	entry.rules = pc.idb;
+	entry.facts = pc.edb != InterpretationPtr() ? pc.edb : InterpretationPtr(new Interpretation(reg));
+	entry.parseTime = now() - start;
+}
+
+void ConstraintCache::splice(const Entry& entry, Constraints& target){
+	target.source += entry.source;
+	target.source += "\n";
+	target.rules.insert(target.rules.end(), entry.rules.begin(), entry.rules.end());
+	if (target.facts == InterpretationPtr()) target.facts = InterpretationPtr(new Interpretation(entry.reg));
+	target.facts->add(*entry.facts);
+}
+
+double ConstraintCache::addConstraint(RegistryPtr reg, const std::string& constraint, Constraints& target) throw (IOperator::OperatorException){
+	boost::unordered_map<std::string, Entry>::iterator it = constraints.find(constraint);
+	if (it != constraints.end() && it->second.reg == reg){
+		splice(it->second, target);
+		return it->second.parseTime;
+	}
+
+	Entry entry;
+	try{
+		parse(reg, constraint, entry);
+	}catch(SyntaxError){
+		throw IOperator::OperatorException(std::string("Could not parse constraint due to a syntax error: \"") + constraint + std::string("\""));
+	}
+	splice(constraints[constraint] = entry, target);
+	return 0;
+}
+
+double ConstraintCache::addConstraintFile(RegistryPtr reg, const std::string& filename, Constraints& target) throw (IOperator::OperatorException){
+	// a cached file is only reused if it was not modified in the meantime
+	struct stat st;
+	bool exists = stat(filename.c_str(), &st) == 0;
+	boost::unordered_map<std::string, Entry>::iterator it = files.find(filename);
+	if (exists && it != files.end() && it->second.reg == reg && it->second.mtime == st.st_mtime && it->second.size == st.st_size){
+		splice(it->second, target);
+		return it->second.parseTime;
+	}
+
+	// read input
+	std::ifstream inp;
+	inp.open(filename.c_str());
+	std::string s;
+	std::stringstream content;
+	while (inp.good() && std::getline(inp, s)){
+		content << s << std::endl;
+	}
+
+	Entry entry;
+	try{
+		parse(reg, content.str(), entry);
+	}catch(SyntaxError){
+		throw IOperator::OperatorException(std::string("Could not parse constraint file due to a syntax error: \"") + filename + std::string("\""));
+	}
+	if (exists){
+		entry.mtime = st.st_mtime;
+		entry.size = st.st_size;
+		splice(files[filename] = entry, target);
+	}else{
+		files.erase(filename);
+		splice(entry, target);
+	}
+	return 0;
+}
+
+void ConstraintCache::clear(){
+	constraints.clear();
+	files.clear();
+}
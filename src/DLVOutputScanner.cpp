@@ -0,0 +1,113 @@
+#include <DLVOutputScanner.h>
+
+#include <string.h>
+
+using namespace dlvhex::merging::plugin;
+
+static const char DIAGNOSIS[] = "Diagnosis: ";
+static const int DIAGNOSIS_LENGTH = sizeof(DIAGNOSIS) - 1;
+
+DLVOutputScanner::DLVOutputScanner(std::ostream& out) : out(out), state(LineStart), prefixMatched(0){
+}
+
+void DLVOutputScanner::scan(const char* data, std::streamsize len){
+	const char* end = data + len;
+	const char* pos = data;
+
+	while (pos < end){
+		switch (state){
+			case LineStart:
+				if (*pos == DIAGNOSIS[prefixMatched]){
+					pos++;
+					if (++prefixMatched == DIAGNOSIS_LENGTH){
+						out.put('{');
+						state = Diagnosis;
+					}
+				}else{
+					// not a diagnosis; the consumed prefix contains neither '{' nor a line break, so it can be dropped
+					state = Skip;
+				}
+				break;
+
+			case Skip:
+				while (pos < end && *pos != '{' && *pos != '\n') pos++;
+				if (pos < end){
+					if (*pos == '{'){
+						state = AnswerSet;
+					}else{
+						state = LineStart;
+						prefixMatched = 0;
+						pos++;
+					}
+				}
+				break;
+
+			case AnswerSet:{
+				// copy everything up to and including '}'
+				const char* close = (const char*)memchr(pos, '}', end - pos);
+				if (close == NULL){
+					out.write(pos, end - pos);
+					pos = end;
+				}else{
+					out.write(pos, close - pos + 1);
+					out.put('\n');
+					pos = close + 1;
+					state = Skip;
+				}
+				break;
+			}
+
+			case Diagnosis:{
+				// copy the rest of the line with blanks replaced by commas
+				const char* span = pos;
+				while (pos < end && *pos != ' ' && *pos != '\n') pos++;
+				out.write(span, pos - span);
+				if (pos < end){
+					if (*pos == ' '){
+						out.put(',');
+					}else{
+						out.write("}\n", 2);
+						state = LineStart;
+						prefixMatched = 0;
+					}
+					pos++;
+				}
+				break;
+			}
+		}
+	}
+}
+
+DLVOutputScanner::int_type DLVOutputScanner::overflow(int_type c){
+	if (!traits_type::eq_int_type(c, traits_type::eof())){
+		char ch = traits_type::to_char_type(c);
+		scan(&ch, 1);
+	}
+	return traits_type::not_eof(c);
+}
+
+std::streamsize DLVOutputScanner::xsputn(const char* s, std::streamsize n){
+	scan(s, n);
+	return n;
+}
+
+int DLVOutputScanner::sync(){
+	out.flush();
+	return 0;
+}
+
+void DLVOutputScanner::finish(){
+	switch (state){
+		case AnswerSet:
+			out.write("}\n", 2);
+			break;
+		case Diagnosis:
+			out.write("}\n", 2);
+			break;
+		default:
+			break;
+	}
+	state = LineStart;
+	prefixMatched = 0;
+	out.flush();
+}
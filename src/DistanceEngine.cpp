@@ -0,0 +1,243 @@
+#include <DistanceEngine.h>
+
+#include <cassert>
+#include <climits>
+#include <string.h>
+#include <sys/time.h>
+
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+
+// ---------- DistanceEngine ----------
+
+DistanceEngine::DistanceEngine(int atomCount, const float penalize[4][4], Aggregation aggregation) : atomCount(atomCount), aggregation(aggregation), bestCost(INT_MAX), optimal(NULL), timeout(0), deadline(0), nodes(0), interrupted(false), listener(NULL){
+	memcpy(this->penalize, penalize, 16 * sizeof(float));
+}
+
+void DistanceEngine::addSource(int weight){
+	Source s;
+	s.weight = weight;
+	memset(s.cost, 0, 16 * sizeof(int));
+	sources.push_back(s);
+}
+
+void DistanceEngine::addAnswerSet(const std::vector<bool>& positive, const std::vector<bool>& negative){
+	assert(sources.size() > 0);
+	assert(positive.size() == atomCount && negative.size() == atomCount);
+	DistanceKernel::Bitset pos(DistanceKernel::blockCount(atomCount), 0);
+	DistanceKernel::Bitset neg(DistanceKernel::blockCount(atomCount), 0);
+	for (int atom = 0; atom < atomCount; atom++){
+		if (positive[atom]) DistanceKernel::set(pos, atom);
+		if (negative[atom]) DistanceKernel::set(neg, atom);
+	}
+	sources.back().positive.push_back(pos);
+	sources.back().negative.push_back(neg);
+}
+
+// computes the costs of each atom and answer-set for both truth values in the decision
+void DistanceEngine::prepare(){
+	firstAnswerSet.clear();
+	costTrue.clear();
+	costFalse.clear();
+	int answersetCount = 0;
+	for (int s = 0; s < sources.size(); s++){
+		firstAnswerSet.push_back(answersetCount);
+		answersetCount += sources[s].positive.size();
+	}
+	firstAnswerSet.push_back(answersetCount);
+
+	costTrue.resize(answersetCount * atomCount);
+	costFalse.resize(answersetCount * atomCount);
+	remaining.resize(answersetCount * (atomCount + 1));
+	partial.assign(answersetCount, 0);
+
+	int as = 0;
+	for (int s = 0; s < sources.size(); s++){
+		// same rounding as in the cost rules of the ASP encoding
+		int (&cost)[4][4] = sources[s].cost;
+		for (int individual = 0; individual < 4; individual++){
+			for (int agg = 0; agg < 4; agg++){
+				cost[individual][agg] = (int)(sources[s].weight * penalize[individual][agg]);
+			}
+		}
+
+		for (int a = 0; a < sources[s].positive.size(); a++, as++){
+			for (int atom = 0; atom < atomCount; atom++){
+				// literals of the individual: + or not, - or not-
+				int pos = DistanceKernel::get(sources[s].positive[a], atom) ? 0 : 1;
+				int neg = DistanceKernel::get(sources[s].negative[a], atom) ? 2 : 3;
+				// a true atom in the decision satisfies + and not-, a false one - and not
+				costTrue[as * atomCount + atom] = cost[pos][0] + cost[pos][3] + cost[neg][0] + cost[neg][3];
+				costFalse[as * atomCount + atom] = cost[pos][2] + cost[pos][1] + cost[neg][2] + cost[neg][1];
+			}
+
+			// cheapest costs of the atoms from a certain position on
+			remaining[as * (atomCount + 1) + atomCount] = 0;
+			for (int atom = atomCount - 1; atom >= 0; atom--){
+				int t = costTrue[as * atomCount + atom];
+				int f = costFalse[as * atomCount + atom];
+				remaining[as * (atomCount + 1) + atom] = remaining[as * (atomCount + 1) + atom + 1] + (t < f ? t : f);
+			}
+		}
+	}
+}
+
+// aggregated costs of a complete decision (atoms which are not true are strongly false)
+int DistanceEngine::evaluate(const DistanceKernel::Bitset& decision){
+	int blocks = decision.size();
+	DistanceKernel::Bitset falseAtoms(blocks);
+	for (int b = 0; b < blocks; b++) falseAtoms[b] = ~decision[b];
+	if (atomCount % 64 != 0) falseAtoms[blocks - 1] &= ((DistanceKernel::Block)1 << (atomCount % 64)) - 1;
+
+	int agg = 0;
+	for (int s = 0; s < sources.size(); s++){
+		int best = INT_MAX;
+		for (int a = 0; a < sources[s].positive.size(); a++){
+			int counts[4][4];
+			DistanceKernel::countDifferences(&sources[s].positive[a][0], &sources[s].negative[a][0], &decision[0], &falseAtoms[0], blocks, atomCount, counts);
+			int c = 0;
+			for (int individual = 0; individual < 4; individual++){
+				for (int group = 0; group < 4; group++){
+					c += sources[s].cost[individual][group] * counts[individual][group];
+				}
+			}
+			if (c < best) best = c;
+		}
+		if (aggregation == Sum){
+			agg += best;
+		}else if (best > agg){
+			agg = best;
+		}
+	}
+	return agg;
+}
+
+// aggregated lower bound for the decision on the atoms before the given one; exact if all atoms are decided
+int DistanceEngine::bound(int atom){
+	int agg = 0;
+	for (int s = 0; s < sources.size(); s++){
+		int best = INT_MAX;
+		for (int as = firstAnswerSet[s]; as < firstAnswerSet[s + 1]; as++){
+			int c = partial[as] + remaining[as * (atomCount + 1) + atom];
+			if (c < best) best = c;
+		}
+		if (aggregation == Sum){
+			agg += best;
+		}else if (best > agg){
+			agg = best;
+		}
+	}
+	return agg;
+}
+
+bool DistanceEngine::timeUp(){
+	// looking at the clock in every node would be too expensive
+	if (timeout > 0 && (++nodes & 1023) == 0 && now() >= deadline) interrupted = true;
+	return interrupted;
+}
+
+void DistanceEngine::search(int atom){
+	// a complete decision is evaluated before the clock is checked, such that it is not lost when the time budget is exceeded
+	if (atom == atomCount){
+		int cost = bound(atom);
+		if (cost < bestCost){
+			bestCost = cost;
+			optimal->clear();
+			if (listener != NULL) listener->improved(decision, cost);
+		}
+		if (cost == bestCost){
+			optimal->push_back(decision);
+		}
+		timeUp();
+		return;
+	}
+	if (timeUp()) return;
+
+	// compute the bounds for both truth values
+	int answersetCount = partial.size();
+	int boundTrue, boundFalse;
+	for (int as = 0; as < answersetCount; as++) partial[as] += costTrue[as * atomCount + atom];
+	boundTrue = bound(atom + 1);
+	for (int as = 0; as < answersetCount; as++) partial[as] += costFalse[as * atomCount + atom] - costTrue[as * atomCount + atom];
+	boundFalse = bound(atom + 1);
+	for (int as = 0; as < answersetCount; as++) partial[as] -= costFalse[as * atomCount + atom];
+
+	// try the more promising value first such that good solutions are found early; all decisions with equal costs are kept
+	bool first = boundTrue <= boundFalse;
+	for (int i = 0; i < 2; i++){
+		bool value = (i == 0) ? first : !first;
+		if ((value ? boundTrue : boundFalse) > bestCost) continue;
+
+		const std::vector<int>& cost = value ? costTrue : costFalse;
+		for (int as = 0; as < answersetCount; as++) partial[as] += cost[as * atomCount + atom];
+		decision[atom] = value;
+		search(atom + 1);
+		for (int as = 0; as < answersetCount; as++) partial[as] -= cost[as * atomCount + atom];
+	}
+}
+
+void DistanceEngine::setTimeout(int milliseconds){
+	timeout = milliseconds;
+}
+
+void DistanceEngine::setListener(Listener* listener){
+	this->listener = listener;
+}
+
+bool DistanceEngine::isComplete(){
+	return !interrupted;
+}
+
+int DistanceEngine::solve(std::vector<std::vector<bool> >& optimal){
+	interrupted = false;
+	nodes = 0;
+	deadline = now() + timeout / 1000.0;
+
+	// a source without answer-sets makes the merging program inconsistent
+	for (int s = 0; s < sources.size(); s++){
+		if (sources[s].positive.size() == 0) return -1;
+	}
+
+	prepare();
+	decision.assign(atomCount, false);
+
+	// upper bound: the decisions taken by the sources themselves (kept as fallback if the search is interrupted early)
+	bestCost = INT_MAX;
+	seeds.clear();
+	if (atomCount > 0){
+		for (int s = 0; s < sources.size(); s++){
+			for (int a = 0; a < sources[s].positive.size(); a++){
+				int c = evaluate(sources[s].positive[a]);
+				if (c < bestCost){
+					bestCost = c;
+					seeds.clear();
+				}
+				if (c == bestCost){
+					std::vector<bool> seed(atomCount);
+					for (int atom = 0; atom < atomCount; atom++) seed[atom] = DistanceKernel::get(sources[s].positive[a], atom);
+					bool known = false;
+					for (int i = 0; i < seeds.size() && !known; i++) known = seeds[i] == seed;
+					if (!known) seeds.push_back(seed);
+				}
+			}
+		}
+	}
+
+	std::vector<std::vector<bool> > found;
+	this->optimal = &found;
+	search(0);
+	this->optimal = NULL;
+	if (interrupted && found.size() == 0) found.swap(seeds);
+
+	optimal.insert(optimal.end(), found.begin(), found.end());
+	return bestCost;
+}
@@ -0,0 +1,253 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif /* HAVE_CONFIG_H */
+
+#include <DistanceKernel.h>
+
+#include <cassert>
+
+#if defined(HAVE_X86_TARGET_ATTRIBUTES) || defined(HAVE_AVX512_POPCNT)
+#include <immintrin.h>
+#endif
+
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+// All implementations compute the same 8 population counts over the blocks:
+//	0: P, 1: N, 2: GP, 3: GN, 4: P & GP, 5: P & GN, 6: N & GP, 7: N & GN
+// where P, N are the positive and negative atoms of the individual and GP, GN the ones of the group decision
+typedef void (*PopcountFunction)(const uint64_t* p, const uint64_t* n, const uint64_t* gp, const uint64_t* gn, int blocks, uint64_t c[8]);
+
+static inline uint64_t popcountGeneric(uint64_t x){
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (x * 0x0101010101010101ULL) >> 56;
+}
+
+static void countGeneric(const uint64_t* p, const uint64_t* n, const uint64_t* gp, const uint64_t* gn, int blocks, uint64_t c[8]){
+	for (int i = 0; i < blocks; i++){
+		c[0] += popcountGeneric(p[i]);
+		c[1] += popcountGeneric(n[i]);
+		c[2] += popcountGeneric(gp[i]);
+		c[3] += popcountGeneric(gn[i]);
+		c[4] += popcountGeneric(p[i] & gp[i]);
+		c[5] += popcountGeneric(p[i] & gn[i]);
+		c[6] += popcountGeneric(n[i] & gp[i]);
+		c[7] += popcountGeneric(n[i] & gn[i]);
+	}
+}
+
+#ifdef HAVE_X86_TARGET_ATTRIBUTES
+__attribute__((target("popcnt")))
+static void countPopcnt(const uint64_t* p, const uint64_t* n, const uint64_t* gp, const uint64_t* gn, int blocks, uint64_t c[8]){
+	for (int i = 0; i < blocks; i++){
+		c[0] += __builtin_popcountll(p[i]);
+		c[1] += __builtin_popcountll(n[i]);
+		c[2] += __builtin_popcountll(gp[i]);
+		c[3] += __builtin_popcountll(gn[i]);
+		c[4] += __builtin_popcountll(p[i] & gp[i]);
+		c[5] += __builtin_popcountll(p[i] & gn[i]);
+		c[6] += __builtin_popcountll(n[i] & gp[i]);
+		c[7] += __builtin_popcountll(n[i] & gn[i]);
+	}
+}
+
+// byte-wise popcount by nibble lookup (vpshufb), summed up into the four 64-bit lanes
+__attribute__((target("avx2")))
+static inline __m256i popcount256(__m256i v, __m256i lookup, __m256i lowMask){
+	__m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, lowMask));
+	__m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask));
+	return _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256());
+}
+
+__attribute__((target("avx2,popcnt")))
+static void countAvx2(const uint64_t* p, const uint64_t* n, const uint64_t* gp, const uint64_t* gn, int blocks, uint64_t c[8]){
+	// the lookup-based counting only pays off for large bitsets
+	if (blocks < 128){
+		countPopcnt(p, n, gp, gn, blocks, c);
+		return;
+	}
+
+	const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+						0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+	const __m256i lowMask = _mm256_set1_epi8(0x0F);
+	__m256i acc[8];
+	for (int k = 0; k < 8; k++) acc[k] = _mm256_setzero_si256();
+
+	int i = 0;
+	for (; i + 4 <= blocks; i += 4){
+		__m256i vp = _mm256_loadu_si256((const __m256i*)(p + i));
+		__m256i vn = _mm256_loadu_si256((const __m256i*)(n + i));
+		__m256i vgp = _mm256_loadu_si256((const __m256i*)(gp + i));
+		__m256i vgn = _mm256_loadu_si256((const __m256i*)(gn + i));
+		acc[0] = _mm256_add_epi64(acc[0], popcount256(vp, lookup, lowMask));
+		acc[1] = _mm256_add_epi64(acc[1], popcount256(vn, lookup, lowMask));
+		acc[2] = _mm256_add_epi64(acc[2], popcount256(vgp, lookup, lowMask));
+		acc[3] = _mm256_add_epi64(acc[3], popcount256(vgn, lookup, lowMask));
+		acc[4] = _mm256_add_epi64(acc[4], popcount256(_mm256_and_si256(vp, vgp), lookup, lowMask));
+		acc[5] = _mm256_add_epi64(acc[5], popcount256(_mm256_and_si256(vp, vgn), lookup, lowMask));
+		acc[6] = _mm256_add_epi64(acc[6], popcount256(_mm256_and_si256(vn, vgp), lookup, lowMask));
+		acc[7] = _mm256_add_epi64(acc[7], popcount256(_mm256_and_si256(vn, vgn), lookup, lowMask));
+	}
+	for (int k = 0; k < 8; k++){
+		uint64_t lanes[4];
+		_mm256_storeu_si256((__m256i*)lanes, acc[k]);
+		c[k] += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	}
+
+	// remaining blocks
+	countPopcnt(p + i, n + i, gp + i, gn + i, blocks - i, c);
+}
+#endif
+
+#ifdef HAVE_AVX512_POPCNT
+__attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+static void countAvx512(const uint64_t* p, const uint64_t* n, const uint64_t* gp, const uint64_t* gn, int blocks, uint64_t c[8]){
+	__m512i acc[8];
+	for (int k = 0; k < 8; k++) acc[k] = _mm512_setzero_si512();
+
+	int i = 0;
+	for (; i + 8 <= blocks; i += 8){
+		__m512i vp = _mm512_loadu_si512((const void*)(p + i));
+		__m512i vn = _mm512_loadu_si512((const void*)(n + i));
+		__m512i vgp = _mm512_loadu_si512((const void*)(gp + i));
+		__m512i vgn = _mm512_loadu_si512((const void*)(gn + i));
+		acc[0] = _mm512_add_epi64(acc[0], _mm512_popcnt_epi64(vp));
+		acc[1] = _mm512_add_epi64(acc[1], _mm512_popcnt_epi64(vn));
+		acc[2] = _mm512_add_epi64(acc[2], _mm512_popcnt_epi64(vgp));
+		acc[3] = _mm512_add_epi64(acc[3], _mm512_popcnt_epi64(vgn));
+		acc[4] = _mm512_add_epi64(acc[4], _mm512_popcnt_epi64(_mm512_and_si512(vp, vgp)));
+		acc[5] = _mm512_add_epi64(acc[5], _mm512_popcnt_epi64(_mm512_and_si512(vp, vgn)));
+		acc[6] = _mm512_add_epi64(acc[6], _mm512_popcnt_epi64(_mm512_and_si512(vn, vgp)));
+		acc[7] = _mm512_add_epi64(acc[7], _mm512_popcnt_epi64(_mm512_and_si512(vn, vgn)));
+	}
+	for (int k = 0; k < 8; k++) c[k] += _mm512_reduce_add_epi64(acc[k]);
+
+	// remaining blocks
+	for (; i < blocks; i++){
+		c[0] += __builtin_popcountll(p[i]);
+		c[1] += __builtin_popcountll(n[i]);
+		c[2] += __builtin_popcountll(gp[i]);
+		c[3] += __builtin_popcountll(gn[i]);
+		c[4] += __builtin_popcountll(p[i] & gp[i]);
+		c[5] += __builtin_popcountll(p[i] & gn[i]);
+		c[6] += __builtin_popcountll(n[i] & gp[i]);
+		c[7] += __builtin_popcountll(n[i] & gn[i]);
+	}
+}
+#endif
+
+namespace{
+	struct Implementation{
+		const char* name;
+		PopcountFunction function;
+		bool (*supported)();
+	};
+
+	bool always(){
+		return true;
+	}
+
+#ifdef HAVE_X86_TARGET_ATTRIBUTES
+	bool cpuPopcnt(){
+		return __builtin_cpu_supports("popcnt");
+	}
+
+	bool cpuAvx2(){
+		return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+	}
+#endif
+
+#ifdef HAVE_AVX512_POPCNT
+	bool cpuAvx512(){
+		return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+	}
+#endif
+
+	// ordered by preference
+	const Implementation implementations[] = {
+#ifdef HAVE_AVX512_POPCNT
+		{ "avx512", countAvx512, cpuAvx512 },
+#endif
+#ifdef HAVE_X86_TARGET_ATTRIBUTES
+		{ "avx2", countAvx2, cpuAvx2 },
+		{ "popcnt", countPopcnt, cpuPopcnt },
+#endif
+		{ "generic", countGeneric, always },
+	};
+	const int implementationCount = sizeof(implementations) / sizeof(Implementation);
+
+	// selected on first use
+	const Implementation* selected = NULL;
+
+	const Implementation* select(){
+		if (selected == NULL){
+			for (int i = 0; i < implementationCount; i++){
+				if (implementations[i].supported()){
+					selected = &implementations[i];
+					break;
+				}
+			}
+		}
+		return selected;
+	}
+}
+
+
+// ---------- DistanceKernel ----------
+
+int DistanceKernel::blockCount(int atomCount){
+	return (atomCount + 63) / 64;
+}
+
+void DistanceKernel::set(Bitset& bitset, int atom){
+	bitset[atom / 64] |= (Block)1 << (atom % 64);
+}
+
+bool DistanceKernel::get(const Bitset& bitset, int atom){
+	return (bitset[atom / 64] >> (atom % 64)) & 1;
+}
+
+void DistanceKernel::countDifferences(const Block* individualPos, const Block* individualNeg, const Block* groupPos, const Block* groupNeg, int blocks, int atomCount, int counts[4][4]){
+	uint64_t c[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+	select()->function(individualPos, individualNeg, groupPos, groupNeg, blocks, c);
+
+	// class i of the individual is X (+ or -) or its complement (not or not-), class j of the group is Y or its complement:
+	//	|X & Y|, |X & ~Y| = |X| - |X & Y|, |~X & Y| = |Y| - |X & Y|, |~X & ~Y| = atoms - |X| - |Y| + |X & Y|
+	for (int x = 0; x < 2; x++){
+		for (int y = 0; y < 2; y++){
+			int cx = (int)c[x];
+			int cy = (int)c[2 + y];
+			int cxy = (int)c[4 + 2 * x + y];
+			counts[2 * x][2 * y] = cxy;
+			counts[2 * x][2 * y + 1] = cx - cxy;
+			counts[2 * x + 1][2 * y] = cy - cxy;
+			counts[2 * x + 1][2 * y + 1] = atomCount - cx - cy + cxy;
+		}
+	}
+}
+
+std::string DistanceKernel::getImplementation(){
+	return select()->name;
+}
+
+std::vector<std::string> DistanceKernel::getImplementations(){
+	std::vector<std::string> names;
+	for (int i = 0; i < implementationCount; i++){
+		if (implementations[i].supported()) names.push_back(implementations[i].name);
+	}
+	return names;
+}
+
+bool DistanceKernel::setImplementation(const std::string& name){
+	for (int i = 0; i < implementationCount; i++){
+		if (name == implementations[i].name && implementations[i].supported()){
+			selected = &implementations[i];
+			return true;
+		}
+	}
+	return false;
+}
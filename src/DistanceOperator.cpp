@@ -0,0 +1,863 @@
+#include <DistanceOperator.h>
+
+#include <AnswerFormat.h>
+#include <ArbProcess.h>
+#include <BinaryAnswer.h>
+#include <DLVOutputScanner.h>
+#include <DistanceEngine.h>
+#include <HexAnswerCache.h>
+#include <InternalSolver.h>
+#include <Portfolio.h>
+
+#include <dlvhex2/AnswerSet.h>
+#include <dlvhex2/DLVresultParserDriver.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging;
+using namespace dlvhex::merging::plugin;
+
+// -------------------- Util (local functions!) --------------------
+
+namespace{
+	// collects the answer-sets delivered by DLVResultParser
+	struct HexAnswerAdder{
+		HexAnswer& answer;
+		HexAnswerAdder(HexAnswer& a) : answer(a){}
+		void operator()(AnswerSet::Ptr as){
+			answer.push_back(as->interpretation);
+		}
+	};
+}
+
+// writes an atom given by the tuple of its positive version; a non-empty predicate replaces the one of the tuple
+static void printAtom(RegistryPtr reg, std::ostream& o, const Tuple& tuple, bool strongneg, const std::string& predicate = ""){
+	if (strongneg) o << "-";
+	if (predicate.length() > 0) o << predicate;
+	else o << reg->terms.getByID(tuple[0]).symbol;
+	for (int i = 1; i < tuple.size(); i++){
+		o << (i == 1 ? "(" : ",");
+		if (tuple[i].isIntegerTerm()) o << tuple[i].address;
+		else o << reg->terms.getByID(tuple[i]).symbol;
+	}
+	if (tuple.size() > 1) o << ")";
+}
+
+static ID storeConstant(RegistryPtr reg, const std::string& symbol){
+	ID id = reg->terms.getIDByString(symbol);
+	if (id == ID_FAIL){
+		Term term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, symbol);
+		id = reg->storeTerm(term);
+	}
+	return id;
+}
+
+// returns the ground atom given by the tuple of its positive version (strongly negated atoms are auxiliaries, see BinaryAnswerReader)
+static ID storeAtom(RegistryPtr reg, const Tuple& tuple, bool strongneg){
+	OrdinaryAtom atom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+	atom.tuple = tuple;
+	if (strongneg){
+		atom.kind |= ID::PROPERTY_AUX;
+		atom.tuple[0] = reg->getAuxiliaryConstantSymbol('s', tuple[0]);
+	}
+	ID id = reg->ogatoms.getIDByTuple(atom.tuple);
+	if (id == ID_FAIL){
+		std::stringstream text;
+		printAtom(reg, text, tuple, strongneg);
+		atom.text = text.str();
+		id = reg->storeOrdinaryGAtom(atom);
+	}
+	return id;
+}
+
+// sums up the integer arguments of the optimization atoms
+static long getCosts(RegistryPtr reg, InterpretationConstPtr intr, ID optID){
+	long cost = 0;
+	for (Interpretation::Storage::enumerator it = intr->getStorage().first(); it != intr->getStorage().end(); ++it){
+		const OrdinaryAtom& ogatom = reg->ogatoms.getByAddress(*it);
+		if (ogatom.tuple[0] == optID && ogatom.tuple.size() > 1 && ogatom.tuple.back().isIntegerTerm()){
+			cost += ogatom.tuple.back().address;
+		}
+	}
+	return cost;
+}
+
+namespace{
+	// prints the results of the solvers as they improve (debug mode)
+	class ProgressPrinter : public InternalSolver::Listener, public DistanceEngine::Listener{
+	private:
+		std::string name;
+		RegistryPtr reg;
+		const std::vector<Tuple>& sourceAtoms;
+		const std::vector<bool>& relevant;
+	public:
+		ProgressPrinter(const std::string& name, RegistryPtr reg, const std::vector<Tuple>& sourceAtoms, const std::vector<bool>& relevant) : name(name), reg(reg), sourceAtoms(sourceAtoms), relevant(relevant){}
+
+		void model(InterpretationPtr model, long cost){
+			std::cerr << name << ": model with costs " << cost << ": " << AnswerFormat::formatAnswerSet(model) << std::endl;
+		}
+
+		void improved(const std::vector<bool>& decision, int cost){
+			std::cerr << name << ": decision with costs " << cost << ": {";
+			bool first = true;
+			for (int i = 0; i < sourceAtoms.size(); i++){
+				if (!relevant[i]) continue;
+				if (!first) std::cerr << ",";
+				printAtom(reg, std::cerr, sourceAtoms[i], !decision[i]);
+				first = false;
+			}
+			std::cerr << "}" << std::endl;
+		}
+	};
+}
+
+
+// ---------- DistanceOperator ----------
+
+std::set<std::string> DistanceOperator::getRecognizedParameters(){
+	std::set<std::string> list;
+	list.insert("constraint");
+	list.insert("constraintfile");
+	list.insert("ignore");
+	list.insert("weights");
+	list.insert("aggregate");
+	list.insert(getPenalizeParameter());
+	list.insert("maxint");
+	list.insert("solver");
+	list.insert("portfolio");
+	list.insert("timeout");
+	list.insert("anytime");
+	return list;
+}
+
+int DistanceOperator::getCapabilities(const OperatorArguments& parameters){
+	// with a time budget, the result depends on how far the search gets
+	for (OperatorArguments::const_iterator argIt = parameters.begin(); argIt != parameters.end(); argIt++){
+		if (argIt->first == std::string("timeout")) return ParallelSafe;
+	}
+	return Pure | ParallelSafe;
+}
+
+std::vector<std::string> DistanceOperator::getDependencies(const OperatorArguments& parameters){
+	std::vector<std::string> files;
+	for (OperatorArguments::const_iterator argIt = parameters.begin(); argIt != parameters.end(); argIt++){
+		if (argIt->first == std::string("constraintfile")) files.push_back(argIt->second);
+	}
+	return files;
+}
+
+bool DistanceOperator::isAberration(const std::string& rule){
+	return rule == "aberration";
+}
+
+std::string DistanceOperator::findUniqueAtomName(const std::string prefix, std::set<std::string>& usedPredNames){
+	static int ri = 0;
+	std::string name;
+	do{
+		// repeat this until we find a unique name
+		std::stringstream ss;
+		ss << prefix;
+		if (ri++ > 0) ss << ri;	// we want to avoid numbers if possible
+		name = ss.str();
+	}while (usedPredNames.find(name) != usedPredNames.end());
+
+	// name was used now
+	usedPredNames.insert(name);
+	return name;
+}
+
+void DistanceOperator::parseParameters(RegistryPtr reg, int arity, const OperatorArguments& parameters, std::vector<int>& weights, int& maxint, std::set<std::string>& ignoredPredicates, ConstraintCache::Constraints& constraints, std::string& aggregation, float penalize[4][4], std::string& solver, int& portfolio, int& timeout, bool& anytime, double& parseTimeSaved){
+
+	bool penalizeSet = false;
+	parseTimeSaved = 0;
+
+	// process additional parameters
+	for (OperatorArguments::const_iterator argIt = parameters.begin(); argIt != parameters.end(); argIt++){
+
+		// add side constraints
+		if (argIt->first == std::string("constraint")){
+			// parse it (once per process)
+			parseTimeSaved += ConstraintCache::addConstraint(reg, argIt->second, constraints);
+		}else if (argIt->first == std::string("constraintfile")){
+			// read and parse it (once per process, unless the file is modified)
+			parseTimeSaved += ConstraintCache::addConstraintFile(reg, argIt->second, constraints);
+
+		// weight of knowledge bases
+		}else if (argIt->first == std::string("weights")){
+			std::vector<std::string> w;
+			boost::split(w, argIt->second, boost::is_any_of(","));
+			weights.clear();
+			if (w.size() != arity) throw IOperator::OperatorException(std::string("Invalid number of weight values: \"") + argIt->second + std::string("\"; must be equal to arity!"));
+			for (int i = 0; i < arity; i++){
+				if (atoi(w[i].c_str()) <= 0) throw IOperator::OperatorException(std::string("Invalid weight value: \"") + w[i] + std::string("\"; must be a positive integer!"));
+				weights.push_back(atoi(w[i].c_str()));
+			}
+
+		// penalize function
+		}else if (argIt->first == getPenalizeParameter()){
+			parsePenalize(argIt->second, penalize);
+			penalizeSet = true;
+
+		// extract aggregation function
+		}else if (argIt->first == std::string("aggregate")){
+			aggregation = argIt->second;
+
+		// extract maxint
+		}else if (argIt->first == std::string("maxint")){
+			maxint = atoi(argIt->second.c_str());
+			if (maxint <= 0) throw IOperator::OperatorException(std::string("maxint must be a positive integer. \"") + argIt->second + std::string("\" was passed"));
+
+		// extract predicates to ignore
+		}else if (argIt->first == std::string("ignore")){
+			std::vector<std::string> preds;
+			boost::split(preds, argIt->second, boost::is_any_of(","));
+			ignoredPredicates.insert(preds.begin(), preds.end());
+
+		// solver backend
+		}else if (argIt->first == std::string("solver")){
+			if (argIt->second != std::string("native") && argIt->second != std::string("dlv") && argIt->second != std::string("internal")){
+				throw IOperator::OperatorException(std::string("Unknown solver \"") + argIt->second + std::string("\"; must be \"native\", \"dlv\" or \"internal\""));
+			}
+			solver = argIt->second;
+
+		// number of backends to run in parallel
+		}else if (argIt->first == std::string("portfolio")){
+			portfolio = atoi(argIt->second.c_str());
+			if (portfolio <= 0) throw IOperator::OperatorException(std::string("portfolio must be a positive integer. \"") + argIt->second + std::string("\" was passed"));
+
+		// time budget
+		}else if (argIt->first == std::string("timeout")){
+			timeout = atoi(argIt->second.c_str());
+			if (timeout <= 0) throw IOperator::OperatorException(std::string("timeout must be a positive integer (milliseconds). \"") + argIt->second + std::string("\" was passed"));
+		}else if (argIt->first == std::string("anytime")){
+			if (argIt->second != std::string("true") && argIt->second != std::string("false")){
+				throw IOperator::OperatorException(std::string("anytime must be \"true\" or \"false\". \"") + argIt->second + std::string("\" was passed"));
+			}
+			anytime = argIt->second == std::string("true");
+		}
+	}
+
+	// default value for penalize (if not used defined)
+	if (!penalizeSet){
+		penalize[0][0] = 0; penalize[0][1] = 1; penalize[0][2] = 0; penalize[0][3] = 0;
+		penalize[1][0] = 0; penalize[1][1] = 0; penalize[1][2] = 0; penalize[1][3] = 0;
+		penalize[2][0] = 0; penalize[2][1] = 0; penalize[2][2] = 0; penalize[2][3] = 1;
+		penalize[3][0] = 0; penalize[3][1] = 0; penalize[3][2] = 0; penalize[3][3] = 0;
+	}
+}
+
+void DistanceOperator::parsePenalize(const std::string& rule, float penalize[4][4]){
+	// shortcuts
+	if (rule == "ignoring"){
+		// +,not
+		// -,not-
+		penalize[0][1] = 1; penalize[2][3] = 1;
+	}
+	else if (rule == "unfounded"){
+		// not,+
+		penalize[1][0] = 1;
+	}
+	else if (isAberration(rule)){
+		// +,not
+		// -,not-
+		// not,+
+		penalize[0][1] = 1; penalize[2][3] = 1; penalize[1][0] = 1;
+	}else{
+		std::vector<std::string> p;
+		boost::split(p, rule, boost::is_any_of(","));
+
+		if (p.size() != 3) throw IOperator::OperatorException(std::string("Invalid penalize definition \"") + rule + std::string("\". Must be of kind \"{+,not,-,not-},{+,not,-,not-},int\""));
+		int individual = -1;
+		int agg = -1;
+		if (p[0] == "+") individual = 0; 	if (p[0] == "not") individual = 1;	if (p[0] == "-") individual = 2;	if (p[0] == "not-") individual = 3;
+		if (p[1] == "+") agg = 0; 		if (p[1] == "not") agg = 1;		if (p[1] == "-") agg = 2;		if (p[1] == "not-") agg = 3;
+		float factor = atof(p[2].c_str());
+		if (individual < 0 || agg < 0 || (factor == 0 && p[2] != "0")){
+			throw IOperator::OperatorException(std::string("Invalid penalize definition \"") + rule + std::string("\". Must be of kind \"{+,not,-,not-},{+,not,-,not-},int\""));
+		}else{
+			penalize[individual][agg] = factor;
+		}
+	}
+}
+
+void DistanceOperator::createAtomList(RegistryPtr reg, const std::vector<const HexAnswer*>& arguments, std::vector<Tuple>& sourceAtoms, boost::unordered_map<Tuple, int>& atomIndex){
+	// for all answers
+	BOOST_FOREACH (const HexAnswer* answer, arguments){
+		// look into each answer-set
+		BOOST_FOREACH (InterpretationPtr intr, *answer){
+			for (Interpretation::Storage::enumerator it = intr->getStorage().first(); it != intr->getStorage().end(); ++it){
+				ID ogid = reg->ogatoms.getIDByAddress(*it);
+				Tuple key = reg->ogatoms.getByID(ogid).tuple;
+
+				// strongly negated atoms are identified with their positive counterpart, other auxiliaries are no beliefs
+				if (ogid.isAuxiliary()){
+					if (reg->getTypeByAuxiliaryConstantSymbol(key[0]) != 's') continue;
+					key[0] = reg->getIDByAuxiliaryConstantSymbol(key[0]);
+				}
+
+				// add it if it does not occur yet (we have to prevent duplicates)
+				if (atomIndex.find(key) == atomIndex.end()){
+					atomIndex[key] = sourceAtoms.size();
+					sourceAtoms.push_back(key);
+				}
+			}
+		}
+	}
+}
+
+void DistanceOperator::buildAggregateFunction(const int arity, const std::string aggregation, const std::string optAtom, const std::string costSum, std::ostream& program){
+	std::string aggregationcode;
+
+	// create predefined aggregate function (if requested)
+	if (aggregation == std::string("sum")){
+		// sum up the results from the individuals
+		std::stringstream ss;
+		ss << "optimize(S" << (arity - 1) << ") :- ";
+		for (int i = 0; i < arity; i++){
+			if (i > 0) ss << ", S" << i << "=S" << (i - 1) << "+V" << i << ", ";
+			ss << "cost(" << i << ", " << (i == 0 ? "S" : "V") << i << ")";
+		}
+		ss << ".";
+		aggregationcode = ss.str();
+	}else if (aggregation == std::string("max")){
+		// take the maximum of the individual results
+		std::stringstream ss;
+		for (int i = 0; i < arity; i++){
+			ss << "optimize(M) :- cost(" << i << ", M)";
+			for (int j = 0; j < arity; j++) ss << ", cost(" << j << ", V" << j << "), M >= V" << j;
+			ss << ".";
+		}
+		aggregationcode = ss.str();
+	}else{
+		// user has already implemented the aggregate function
+		aggregationcode = aggregation;
+	}
+
+	// make sure that the aggregate function uses our unique predicate names
+	boost::algorithm::replace_all(aggregationcode, "cost", costSum);
+	boost::algorithm::replace_all(aggregationcode, "optimize", optAtom);
+	program << aggregationcode << std::endl;
+}
+
+void DistanceOperator::writeAtomSelectionRules(RegistryPtr reg, const std::vector<Tuple>& sourceAtoms, std::ostream& program){
+
+	// Make sure that each atom is either positive or negative
+	// Note: this binary behaviour is reasonable since each atom occurrs in at least one answer-set. Thus, the answer "unknown" is senseless anyway because
+	// we always have evidences for positive or negative information.
+	BOOST_FOREACH (const Tuple& atom, sourceAtoms){
+		// add rules of kind: "a v -a."
+		printAtom(reg, program, atom, false);
+		program << " v ";
+		printAtom(reg, program, atom, true);
+		program << "." << std::endl;
+	}
+}
+
+void DistanceOperator::renameSourceAtoms(RegistryPtr reg, const std::vector<Tuple>& sourceAtoms, std::set<std::string>& usedPredNames, std::map<ID, std::string>& localAtoms){
+
+	BOOST_FOREACH (const Tuple& atom, sourceAtoms){
+		// do we have already a name for this predicate?
+		if (localAtoms.find(atom[0]) == localAtoms.end()){
+			// no: create one
+			localAtoms[atom[0]] = findUniqueAtomName(reg->terms.getByID(atom[0]).getUnquotedString(), usedPredNames);
+		}
+	}
+}
+
+void DistanceOperator::writeAnswerSetSelectionRules(RegistryPtr reg, const HexAnswer* source, const std::map<ID, std::string>& localAtomMapping, const std::set<std::string>& ignoredPredicates, std::set<std::string>& usedPredNames, std::ostream& program){
+
+	// for all answer-sets of this source
+	std::stringstream head_asSelection;
+	BOOST_FOREACH (InterpretationPtr intr, *source){
+
+		// make a unique prop. atom that decides if this answer-set is selected or not
+		std::string atom_asSelection = findUniqueAtomName("as_", usedPredNames);
+
+		// a disjunction of all those atoms will select exactly one (due to minimality criterion of answer-sets)
+		if (head_asSelection.tellp() > 0) head_asSelection << " v ";
+		head_asSelection << atom_asSelection;
+
+		// for all atoms of this answer-set
+		for (Interpretation::Storage::enumerator it = intr->getStorage().first(); it != intr->getStorage().end(); ++it){
+			ID ogid = reg->ogatoms.getIDByAddress(*it);
+			Tuple atom = reg->ogatoms.getByID(ogid).tuple;
+			bool strongneg = false;
+			if (ogid.isAuxiliary()){
+				if (reg->getTypeByAuxiliaryConstantSymbol(atom[0]) != 's') continue;
+				atom[0] = reg->getIDByAuxiliaryConstantSymbol(atom[0]);
+				strongneg = true;
+			}
+
+			// check if this atom is relevant or ignored
+			if (ignoredPredicates.find(reg->terms.getByID(atom[0]).getUnquotedString()) == ignoredPredicates.end()){
+				// relevant: if the current answer-set is selected, then the contained atoms can be derived (under the local name)
+				assert(localAtomMapping.find(atom[0]) != localAtomMapping.end());
+				printAtom(reg, program, atom, strongneg, localAtomMapping.find(atom[0])->second);
+				program << " :- " << atom_asSelection << "." << std::endl;
+			}
+		}
+	}
+
+	// make sure that one of the answer-sets of this source is selected
+	// (at least one -> minimality of answer-sets will make sure that also at most one is selected)
+	program << head_asSelection.str() << "." << std::endl;
+}
+
+void DistanceOperator::writeCostComputationRules(RegistryPtr reg, const int sourceNr, const std::map<ID, std::string>& localAtomMapping, const std::vector<Tuple>& sourceAtoms, const std::string costAtom, const std::string costAccAtom, const std::string costSumAtom, const int weight, const float penalize[4][4], int& maxint, std::ostream& program){
+
+	// for all atoms (even those that do not occur in this source, since they can still be relevant depending on the cost model)
+	int constraintNr = 0;
+	BOOST_FOREACH (const Tuple& atom, sourceAtoms){
+		const std::string& local = localAtomMapping.find(atom[0])->second;
+
+		// for all combinations of positive, strongly negated and default-negated literals
+		for (int individual = 0; individual < 4; individual++){
+			for (int agg = 0; agg < 4; agg++){
+				int costs = (int)(weight * penalize[individual][agg]);
+				if (costs > 0){
+					// compute maximum integer needed
+					maxint += costs;
+
+					// cost(SRC, K, c) :- [not] [-]local, [not] [-]group.
+					program << costAtom << "(" << sourceNr << "," << constraintNr << "," << costs << ") :- ";
+					if (individual == 1 || individual == 3) program << "not ";
+					printAtom(reg, program, atom, individual >= 2, local);
+					program << ", ";
+					if (agg == 1 || agg == 3) program << "not ";
+					printAtom(reg, program, atom, agg >= 2);
+					program << "." << std::endl;
+
+					// the costs are 0 if the rule above is not applicable
+					program << costAtom << "(" << sourceNr << "," << constraintNr << ",0) :- not " << costAtom << "(" << sourceNr << "," << constraintNr << "," << costs << ")." << std::endl;
+
+					// accumulate the costs along the constraints
+					if (constraintNr == 0){
+						program << costAccAtom << "(" << sourceNr << ",0,C) :- " << costAtom << "(" << sourceNr << ",0,C)." << std::endl;
+					}else{
+						program << costAccAtom << "(" << sourceNr << "," << constraintNr << ",S) :- " << costAccAtom << "(" << sourceNr << "," << (constraintNr - 1) << ",S0), " << costAtom << "(" << sourceNr << "," << constraintNr << ",C), S=S0+C." << std::endl;
+					}
+					constraintNr++;
+				}
+			}
+		}
+	}
+
+	// total costs of this source
+	if (constraintNr == 0){
+		program << costSumAtom << "(" << sourceNr << ",0)." << std::endl;
+	}else{
+		program << costSumAtom << "(" << sourceNr << ",S) :- " << costAccAtom << "(" << sourceNr << "," << (constraintNr - 1) << ",S)." << std::endl;
+	}
+}
+
+void DistanceOperator::optimize(HexAnswer& result, std::string optAtom){
+	// answer cleaning: only keep those answer-sets that have to pay the minimum penalty for weak constraint violation
+	if (result.size() == 0) return;
+	RegistryPtr reg = result[0]->getRegistry();
+	ID optID = reg->terms.getIDByString(optAtom);
+
+	std::vector<long> weights;
+	weights.reserve(result.size());
+	long bestWeight = -1;	// none found so far
+	BOOST_FOREACH (InterpretationPtr intr, result){
+		long weight = getCosts(reg, intr, optID);
+		weights.push_back(weight);
+
+		// check if this weight is better than the best previous one
+		if (bestWeight == -1 || weight < bestWeight){
+			bestWeight = weight;
+		}
+	}
+
+	// keep the first occurrence of each answer-set with the best weight; duplicates are detected by a content hash
+	// (full comparison only for answer-sets with equal hash values)
+	HexAnswer optimal;
+	boost::unordered_map<std::size_t, std::vector<int> > occurrences;	// hash value -> indices in optimal
+	for (int i = 0; i < result.size(); i++){
+		if (weights[i] > bestWeight) continue;
+
+		std::vector<int>& candidates = occurrences[AnswerFormat::hashAnswerSet(result[i])];
+		bool found = false;
+		for (std::vector<int>::iterator it = candidates.begin(); it != candidates.end() && !found; ++it){
+			if (*optimal[*it] == *result[i]) found = true;
+		}
+		if (!found){
+			candidates.push_back(optimal.size());
+			optimal.push_back(result[i]);
+		}
+	}
+	result.swap(optimal);
+}
+
+void DistanceOperator::solveNative(bool debug, RegistryPtr reg, const std::vector<const HexAnswer*>& arguments, const std::vector<Tuple>& sourceAtoms, const boost::unordered_map<Tuple, int>& atomIndex, const std::vector<bool>& relevant, const std::vector<int>& weights, const float penalize[4][4], const std::string& aggregation, const std::string& optAtom, int timeout, bool& complete, HexAnswer& result){
+
+	// add the answer-sets of all sources as bitsets (ignored atoms are never contained, as in writeAnswerSetSelectionRules)
+	DistanceEngine engine(sourceAtoms.size(), penalize, aggregation == std::string("max") ? DistanceEngine::Max : DistanceEngine::Sum);
+	for (int s = 0; s < arguments.size(); s++){
+		engine.addSource(weights[s]);
+		BOOST_FOREACH (InterpretationPtr intr, *arguments[s]){
+			std::vector<bool> positive(sourceAtoms.size(), false);
+			std::vector<bool> negative(sourceAtoms.size(), false);
+			for (Interpretation::Storage::enumerator it = intr->getStorage().first(); it != intr->getStorage().end(); ++it){
+				ID ogid = reg->ogatoms.getIDByAddress(*it);
+				Tuple key = reg->ogatoms.getByID(ogid).tuple;
+				bool strongneg = false;
+				if (ogid.isAuxiliary()){
+					if (reg->getTypeByAuxiliaryConstantSymbol(key[0]) != 's') continue;
+					key[0] = reg->getIDByAuxiliaryConstantSymbol(key[0]);
+					strongneg = true;
+				}
+				boost::unordered_map<Tuple, int>::const_iterator idx = atomIndex.find(key);
+				assert(idx != atomIndex.end());
+				if (!relevant[idx->second]) continue;
+				if (strongneg) negative[idx->second] = true;
+				else positive[idx->second] = true;
+			}
+			engine.addAnswerSet(positive, negative);
+		}
+	}
+
+	std::vector<std::vector<bool> > decisions;
+	ProgressPrinter printer(getName(), reg, sourceAtoms, relevant);
+	if (debug) engine.setListener(&printer);
+	engine.setTimeout(timeout);
+	int cost = engine.solve(decisions);
+	complete = engine.isComplete();
+
+	// the optimization atom with the costs, as in the output of the merging program
+	Tuple costTuple;
+	costTuple.push_back(storeConstant(reg, optAtom));
+	costTuple.push_back(ID::termFromInteger(cost));
+	ID costAtom = storeAtom(reg, costTuple, false);
+
+	// build the answer-sets; decisions which differ only in ignored atoms are equal after filtering
+	std::set<std::vector<bool> > written;
+	for (int d = 0; d < decisions.size(); d++){
+		std::vector<bool> projected;
+		for (int i = 0; i < sourceAtoms.size(); i++){
+			if (relevant[i]) projected.push_back(decisions[d][i]);
+		}
+		if (!written.insert(projected).second) continue;
+
+		InterpretationPtr intr(new Interpretation(reg));
+		for (int i = 0; i < sourceAtoms.size(); i++){
+			if (!relevant[i]) continue;
+			intr->setFact(storeAtom(reg, sourceAtoms[i], !decisions[d][i]).address);
+		}
+		intr->setFact(costAtom.address);
+		result.push_back(intr);
+	}
+}
+
+void DistanceOperator::solveDLV(RegistryPtr reg, const std::string& program, int maxint, const std::set<std::string>& filter, HexAnswer& result){
+	std::stringstream command;
+	command << "dlv -silent -N=" << maxint << " -filter=";
+	for (std::set<std::string>::const_iterator it = filter.begin(); it != filter.end(); ++it){
+		if (it != filter.begin()) command << ",";
+		command << *it;
+	}
+	command << " --";
+
+	// strip off dlv's meta output concerning costs while dlv is running
+	std::stringstream input(program);
+	std::stringstream answer;
+	DLVOutputScanner scanner(answer);
+	std::ostream dlvoutput(&scanner);
+	ArbProcess dlv(command.str());
+	int errcode = dlv.filter(input, dlvoutput);
+	scanner.finish();
+	if (errcode != 0){
+		throw IOperator::OperatorException("Error from dlv while solving the merging program");
+	}
+
+	DLVResultParser parser(reg);
+	parser.parse(answer, HexAnswerAdder(result));
+}
+
+void DistanceOperator::solveProgram(bool debug, RegistryPtr reg, const std::string& backend, const std::string& program, const ConstraintCache::Constraints& constraints, int maxint, const std::set<std::string>& filter, const std::string& optAtom, int timeout, bool& complete, HexAnswer& result){
+	if (backend == std::string("internal")){
+		// solve within this process; the internal solver computes the minimal costs itself and uses the parsed constraints
+		std::vector<Tuple> noAtoms;
+		std::vector<bool> noRelevance;
+		ProgressPrinter printer(getName(), reg, noAtoms, noRelevance);
+		complete = InternalSolver::solve(program, constraints.rules, constraints.facts, maxint, optAtom, filter, result, timeout, debug ? &printer : NULL);
+	}else{
+		// dlv prints improving models for the weak constraint; the last one has the minimal costs
+		std::stringstream weak;
+		weak << program << constraints.source << ":~ " << optAtom << "(C). [C:1]" << std::endl;
+		HexAnswer improving;
+		solveDLV(reg, weak.str(), maxint, filter, improving);
+		optimize(improving, optAtom);
+
+		// then compute all models with these costs
+		if (improving.size() > 0){
+			std::stringstream bounded;
+			bounded << program << constraints.source << ":- " << optAtom << "(C), C > " << getCosts(reg, improving[0], reg->terms.getIDByString(optAtom)) << "." << std::endl;
+			HexAnswer optimal;
+			solveDLV(reg, bounded.str(), maxint, filter, optimal);
+
+			// finally, keep only the answer-sets with minimal costs
+			optimize(optimal, optAtom);
+			result.insert(result.end(), optimal.begin(), optimal.end());
+		}
+		complete = true;
+	}
+}
+
+void DistanceOperator::markIncomplete(RegistryPtr reg, bool complete, bool anytime, HexAnswer& result){
+	if (complete) return;
+	if (!anytime) throw IOperator::OperatorException("Time budget exceeded before the optimal answer-sets were found (set anytime to accept the best ones found so far)");
+
+	Tuple nonoptimal;
+	nonoptimal.push_back(storeConstant(reg, "nonoptimal"));
+	ID marker = storeAtom(reg, nonoptimal, false);
+	BOOST_FOREACH (InterpretationPtr intr, result){
+		intr->setFact(marker.address);
+	}
+}
+
+void DistanceOperator::evaluate(bool debug, const std::vector<const HexAnswer*>& arguments, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException){
+
+	// the merging program adds atoms to the registry, which must not happen while other applications are evaluated:
+	// compute in a child process and let the cache decode the result in the main thread
+	EncodedAnswerSink* encodedResult = dynamic_cast<EncodedAnswerSink*>(&result);
+	if (!encodedResult || !encodedResult->isConcurrent() || arguments.size() == 0 || arguments[0]->size() == 0){
+		compute(debug, arguments, parameters, result);
+		return;
+	}
+
+	RegistryPtr reg = (*arguments[0])[0]->getRegistry();
+	std::string encoded;
+	try{
+		Portfolio child;
+		if (child.start(getName())){
+			try{
+				HexAnswer answer;
+				HexAnswerSink sink(answer);
+				compute(debug, arguments, parameters, sink);
+				BinaryAnswerWriter writer(reg);
+				writer.add(answer);
+				writer.write(encoded);
+				child.deliver(encoded);
+			}catch(std::exception& e){
+				child.fail(e.what());
+			}catch(...){
+				child.fail("unknown error");
+			}
+		}
+		child.wait(encoded);
+	}catch(PluginError& e){
+		throw OperatorException(e.what());
+	}
+	encodedResult->addEncoded(encoded);
+}
+
+void DistanceOperator::compute(bool debug, const std::vector<const HexAnswer*>& arguments, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException){
+
+	int arity = arguments.size();
+	if (arity == 0){
+		throw OperatorException(std::string("Error: The ") + getName() + std::string(" operator expects at least 1 argument."));
+	}
+
+	// the group decision must coincide with some answer-set of each source
+	BOOST_FOREACH (const HexAnswer* answer, arguments){
+		if (answer->size() == 0) return;
+	}
+	RegistryPtr reg = (*arguments[0])[0]->getRegistry();
+
+	// default values
+	std::string aggregation = "sum";
+	std::string solverBackend = "";	// automatic
+	int portfolio = 1;
+	int timeout = 0;	// unlimited
+	bool anytime = false;
+	double parseTimeSaved = 0;
+	int maxint = 0;
+
+	std::set<std::string> ignoredPredicates;
+	std::vector<int> weights;
+	for (int i = 0; i < arity; i++)	// default value
+		weights.push_back(1);
+
+
+	// ---------- some information gathering ----------
+
+	// construct a logic program that computes the answer as follows:
+	//	- rename all atoms such that they are unique for each belief base, i.e. no atom occurs in multiple sources
+	//	- guess final atoms: each one can be true or false
+	//	- add weak constraints, such that the final atoms are as similar to the sources as possible
+
+	// create a collection of all atoms occurring in some source and further extract all predicate names that were used
+	std::vector<Tuple> sourceAtoms;
+	boost::unordered_map<Tuple, int> atomIndex;
+	createAtomList(reg, arguments, sourceAtoms, atomIndex);
+	std::set<std::string> usedPredNames;
+	BOOST_FOREACH (const Tuple& atom, sourceAtoms){
+		usedPredNames.insert(reg->terms.getByID(atom[0]).getUnquotedString());
+	}
+
+	// create a unique optimization atom
+	std::string optAtom = findUniqueAtomName("optimize", usedPredNames);
+
+	// create a unique cost atoms for intermedicate results and final sum (for each source)
+	std::string costAtom = findUniqueAtomName("cost", usedPredNames);
+	std::string costAcc = findUniqueAtomName("costAcc", usedPredNames);
+	std::string costSum = findUniqueAtomName("costSum", usedPredNames);
+
+	// parse parameters (may throws an exception)
+	float penalize[4][4];	// 0=positive, 1=defneg, 2=strong neg, 3=def and strong neg
+				// first dimension: individuals
+				// second dimension: aggregated decision
+	memset(penalize, 0, 16 * sizeof(float));
+	ConstraintCache::Constraints constraints;
+	parseParameters(reg, arity, parameters, weights, maxint, ignoredPredicates, constraints, aggregation, penalize, solverBackend, portfolio, timeout, anytime, parseTimeSaved);
+	if (debug && parseTimeSaved > 0){
+		std::cerr << getName() << ": reused cached constraints, saved " << parseTimeSaved << " s of parsing" << std::endl;
+	}
+	if (anytime && usedPredNames.find("nonoptimal") != usedPredNames.end()){
+		throw OperatorException("Predicate \"nonoptimal\" is reserved in anytime mode");
+	}
+
+	// the native engine handles the common case of no side constraints and a built-in aggregate function
+	bool sideConstraints = false;
+	for (OperatorArguments::const_iterator argIt = parameters.begin(); argIt != parameters.end(); argIt++){
+		if (argIt->first == std::string("constraint") || argIt->first == std::string("constraintfile")) sideConstraints = true;
+	}
+	bool nativeApplicable = !sideConstraints && (aggregation == std::string("sum") || aggregation == std::string("max"));
+	if (solverBackend == std::string("native") && !nativeApplicable){
+		throw OperatorException("Solver \"native\" supports neither constraints nor user-defined aggregate functions");
+	}
+	// dlv cannot be interrupted with its best model so far
+	if (solverBackend == std::string("dlv") && timeout > 0){
+		throw OperatorException("Solver \"dlv\" does not support a timeout; use \"native\" or \"internal\"");
+	}
+	if (solverBackend == std::string("")){
+		solverBackend = nativeApplicable ? "native" : (timeout > 0 ? "internal" : "dlv");
+	}
+	// the internal solver computes the costs from the optimization atom only and would ignore the weak constraints of the user
+	bool weakConstraints = false;
+	BOOST_FOREACH (ID rule, constraints.rules){
+		if (rule.isWeakConstraint()) weakConstraints = true;
+	}
+	if (solverBackend == std::string("internal") && weakConstraints){
+		throw OperatorException("Solver \"internal\" does not support weak constraints; use \"dlv\"");
+	}
+
+	// filter the output to prevent double entries due to differences in intermediate atoms
+	std::vector<bool> relevant;
+	std::set<std::string> filter;
+	filter.insert(optAtom);
+	BOOST_FOREACH (const Tuple& atom, sourceAtoms){
+		std::string predicate = reg->terms.getByID(atom[0]).getUnquotedString();
+		relevant.push_back(ignoredPredicates.find(predicate) == ignoredPredicates.end());
+		if (relevant.back()) filter.insert(predicate);
+	}
+
+	if (solverBackend == std::string("native") && portfolio <= 1){
+		bool complete;
+		HexAnswer answer;
+		solveNative(debug, reg, arguments, sourceAtoms, atomIndex, relevant, weights, penalize, aggregation, optAtom, timeout, complete, answer);
+		markIncomplete(reg, complete, anytime, answer);
+		result.addAll(answer);
+		return;
+	}
+
+
+	// ---------- start building the program ----------
+
+	std::stringstream program;
+
+	// built appropriate aggregate function
+	buildAggregateFunction(arity, aggregation, optAtom, costSum, program);
+
+	// write selection rules for all atoms
+	writeAtomSelectionRules(reg, sourceAtoms, program);
+
+	// by default, maxint is set by writeCostComputationRules (see below) such that it is high enough to compute the costs (using sum aggregation); if
+	// the user uses additional integer rules or more expensive aggregate functions, the value can be overwritten in the parameters
+	// this value is sufficient for maximum aggregate function
+	int micomp = 0;
+
+	// add the information from all sources
+	for (int s = 0; s < arity; s++){
+
+		// make sure we use unique atom names in each source
+		std::map<ID, std::string> localAtomMapping;
+		renameSourceAtoms(reg, sourceAtoms, usedPredNames, localAtomMapping);
+
+		// select exactly one answer-set of this source and derive the atoms within
+		writeAnswerSetSelectionRules(reg, arguments[s], localAtomMapping, ignoredPredicates, usedPredNames, program);
+
+		// compute the costs for this source
+		writeCostComputationRules(reg, s, localAtomMapping, sourceAtoms, costAtom, costAcc, costSum, weights[s], penalize, micomp, program);
+	}
+	if (micomp > maxint)
+		maxint = micomp;
+
+	// execute the program
+	try{
+		HexAnswer answer;
+		if (portfolio > 1){
+			// members: the selected backend first, then the other applicable ones
+			std::vector<std::string> configurations;
+			configurations.push_back(solverBackend);
+			if (nativeApplicable && solverBackend != std::string("native")) configurations.push_back("native");
+			if (solverBackend != std::string("dlv") && timeout == 0) configurations.push_back("dlv");
+			if (InternalSolver::available() && solverBackend != std::string("internal") && !weakConstraints) configurations.push_back("internal");
+			if (configurations.size() > portfolio) configurations.resize(portfolio);
+
+			Portfolio members;
+			for (int i = 0; i < configurations.size(); i++){
+				if (members.start(configurations[i])){
+					try{
+						HexAnswer memberResult;
+						bool complete;
+						if (configurations[i] == std::string("native")){
+							solveNative(debug, reg, arguments, sourceAtoms, atomIndex, relevant, weights, penalize, aggregation, optAtom, timeout, complete, memberResult);
+						}else{
+							solveProgram(debug, reg, configurations[i], program.str(), constraints, maxint, filter, optAtom, timeout, complete, memberResult);
+						}
+						markIncomplete(reg, complete, anytime, memberResult);
+						BinaryAnswerWriter writer(reg);
+						writer.add(memberResult);
+						std::string encoded;
+						writer.write(encoded);
+						members.deliver(encoded);
+					}catch(std::exception& e){
+						members.fail(e.what());
+					}catch(...){
+						members.fail("unknown error");
+					}
+				}
+			}
+
+			std::string encoded;
+			int winner = members.wait(encoded);
+			if (debug){
+				std::cerr << getName() << ": portfolio member \"" << members.getName(winner) << "\" finished first" << std::endl;
+			}
+			BinaryAnswerReader(encoded).read(reg, answer);
+		}else{
+			bool complete;
+			solveProgram(debug, reg, solverBackend, program.str(), constraints, maxint, filter, optAtom, timeout, complete, answer);
+			markIncomplete(reg, complete, anytime, answer);
+		}
+		result.addAll(answer);
+	}catch(OperatorException&){
+		throw;
+	}catch(...){
+		std::stringstream ss;
+		if (debug){
+			ss << ": " << std::endl << program.str() << constraints.source;
+		}
+		throw OperatorException("Error while building and executing the merging program" + ss.str());
+	}
+}
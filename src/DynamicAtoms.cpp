@@ -0,0 +1,167 @@
+#include <DynamicAtoms.h>
+
+#include <HexExecution.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <stdlib.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+static bool isIdentifierChar(char c){
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static bool isNumber(const std::string& s){
+	if (s.length() == 0) return false;
+	for (int i = 0; i < s.length(); i++){
+		if (s[i] < '0' || s[i] > '9') return false;
+	}
+	return true;
+}
+
+static bool hasPrefix(const std::string& s, const std::string& prefix){
+	return s.length() > prefix.length() && s.substr(0, prefix.length()) == prefix;
+}
+
+static const std::string::size_type MAX_NAME_LENGTH = 64;	// longer names cannot denote one of the atoms (their arities would exceed MAX_ARITY)
+
+static int parseArity(const std::string& s){
+	if (s.length() > 9 || atoi(s.c_str()) > DynamicAtoms::MAX_ARITY){
+		std::stringstream msg;
+		msg << "Arity " << s << " exceeds the maximum arity " << DynamicAtoms::MAX_ARITY << " of &callhexN, &callhexfileN and &simulatorI_O";
+		throw PluginError(msg.str());
+	}
+	return atoi(s.c_str());
+}
+
+namespace{
+	// forwards the converted program to the output and registers the referenced atoms on the way; a reference which is split between
+	// two writes is completed by the next one
+	class ScanningBuffer : public std::streambuf{
+	private:
+		std::streambuf* target;
+		DynamicAtoms& atoms;
+		bool inReference;
+		std::string name;
+		std::string error;
+
+		void complete(){
+			inReference = false;
+			try{
+				atoms.add(name);
+			}catch(PluginError& e){
+				// streams swallow exceptions of their buffers; the error is reported when the program is complete
+				if (error.length() == 0) error = e.what();
+			}
+			name.clear();
+		}
+
+		void scan(const char* s, std::streamsize n){
+			for (std::streamsize k = 0; k < n; k++){
+				if (inReference){
+					if (isIdentifierChar(s[k])){
+						if (name.length() < MAX_NAME_LENGTH) name += s[k];
+						continue;
+					}
+					complete();
+				}
+				if (s[k] == '&') inReference = true;
+			}
+		}
+	protected:
+		virtual int overflow(int c){
+			if (c == traits_type::eof()) return traits_type::not_eof(c);
+			char ch = traits_type::to_char_type(c);
+			scan(&ch, 1);
+			return target->sputc(ch);
+		}
+
+		virtual std::streamsize xsputn(const char* s, std::streamsize n){
+			scan(s, n);
+			return target->sputn(s, n);
+		}
+
+		virtual int sync(){
+			return target->pubsync();
+		}
+	public:
+		ScanningBuffer(std::streambuf* target, DynamicAtoms& atoms) : target(target), atoms(atoms), inReference(false){}
+
+		void finish(){
+			if (inReference) complete();
+			if (error.length() > 0) throw PluginError(error);
+		}
+	};
+}
+
+
+// ---------- DynamicAtoms ----------
+
+DynamicAtoms::DynamicAtoms(HexAnswerCache& rsCache) : ctx(NULL), resultsetCache(rsCache){
+}
+
+void DynamicAtoms::setProgramCtx(ProgramCtx& ctx){
+	this->ctx = &ctx;
+}
+
+void DynamicAtoms::add(const std::string& name){
+	if (registered.find(name) != registered.end()) return;
+	assert(ctx);
+
+	PluginAtomPtr atom;
+	if (hasPrefix(name, "callhexfile") && isNumber(name.substr(11))){
+		atom = PluginAtomPtr(new CallHexFileAtom(resultsetCache, parseArity(name.substr(11))), PluginPtrDeleter<PluginAtom>());
+	}else if (hasPrefix(name, "callhex") && isNumber(name.substr(7))){
+		atom = PluginAtomPtr(new CallHexAtom(resultsetCache, parseArity(name.substr(7))), PluginPtrDeleter<PluginAtom>());
+	}else if (hasPrefix(name, "simulator")){
+		std::string::size_type sep = name.find('_');
+		if (sep == std::string::npos || !isNumber(name.substr(9, sep - 9)) || !isNumber(name.substr(sep + 1))) return;
+		atom = PluginAtomPtr(new SimulatorAtom(*ctx, parseArity(name.substr(9, sep - 9)), parseArity(name.substr(sep + 1))), PluginPtrDeleter<PluginAtom>());
+	}else{
+		return;
+	}
+
+	ctx->addPluginAtom(atom);
+	registered.insert(name);
+}
+
+void DynamicAtoms::require(const std::string& program){
+	for (std::string::size_type pos = program.find('&'); pos != std::string::npos; pos = program.find('&', pos)){
+		std::string::size_type end = ++pos;
+		while (end < program.length() && isIdentifierChar(program[end])) end++;
+		add(program.substr(pos, end - pos));
+		pos = end;
+	}
+}
+
+void DynamicAtoms::requireFile(const std::string& filename){
+	std::ifstream file(filename.c_str());
+	if (!file.is_open()) return;
+	std::stringstream ss;
+	ss << file.rdbuf();
+	require(ss.str());
+}
+
+
+// ---------- AtomScanner ----------
+
+AtomScanner::AtomScanner(PluginConverterPtr i, DynamicAtoms& a) : inner(i), atoms(a){
+}
+
+void AtomScanner::convert(std::istream& i, std::ostream& o){
+	ScanningBuffer buffer(o.rdbuf(), atoms);
+	std::ostream program(&buffer);
+	if (inner){
+		inner->convert(i, program);
+	}else{
+		program << i.rdbuf();
+	}
+	program.flush();
+	buffer.finish();
+}
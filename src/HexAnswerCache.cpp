@@ -1,6 +1,11 @@
 #include <HexAnswerCache.h>
 
 #include <HexExecution.h>
+#include <DynamicAtoms.h>
+#include <PlanScheduler.h>
+#include <OperatorAdapter.h>
+#include <IOperatorV2.h>
+#include <BinaryAnswer.h>
 #include "dlvhex2/HexParser.h"
 #include "dlvhex2/InputProvider.h"
 #include "dlvhex2/InternalGrounder.h"
@@ -20,6 +25,9 @@
 #include "dlvhex2/OnlineModelBuilder.h"
 #include "dlvhex2/OfflineModelBuilder.h"
 
+#include <boost/functional/hash.hpp>
+
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -128,8 +136,27 @@ HexCall::HexCall(CallType ct, std::string prog, std::string args, Interpretation
 	hashcode = hash(h.str());
 }
 
-HexCall::HexCall(CallType ct, IOperator* op, bool deb, bool sil, std::vector<int> as, OperatorArguments kv) : type(ct), program(""), operatorImpl(op), debug(deb), silent(sil), asParams(as), kvParams(kv){
+HexCall::HexCall(CallType ct, IOperator* op, bool deb, bool sil, std::vector<int> as, OperatorArguments kv, std::string version) : type(ct), program(""), operatorImpl(op), operatorVersion(version), debug(deb), silent(sil), asParams(as), kvParams(kv){
 	assert(ct == OperatorCall);
+
+	// the order of key-value pairs does not matter; sort them once such that comparisons are linear and mostly decided by the digest
+	sortedKvParams = kvParams;
+	std::sort(sortedKvParams.begin(), sortedKvParams.end());
+	kvDigest = 0;
+	for (OperatorArguments::const_iterator it = sortedKvParams.begin(); it != sortedKvParams.end(); ++it){
+		boost::hash_combine(kvDigest, boost::hash_value(it->first));
+		boost::hash_combine(kvDigest, boost::hash_value(it->second));
+	}
+
+	// the result of an operator which reads files is only the same as long as the files are the same; within a run, the files are
+	// compared by modification time and size (their contents are only hashed for the persistent cache)
+	IOperatorV2* v2 = dynamic_cast<IOperatorV2*>(op);
+	if (v2){
+		dependencies = v2->getDependencies(kvParams);
+		for (std::vector<std::string>::iterator it = dependencies.begin(); it != dependencies.end(); ++it){
+			dependencyStamp += PersistentCache::stampFile(*it) + ";";
+		}
+	}
 }
 
 const bool HexCall::operator==(const HexCall &other) const{
@@ -146,35 +173,15 @@ const bool HexCall::operator==(const HexCall &other) const{
 			// Check if operator is the same
 			if (other.operatorImpl != operatorImpl) return false;
 
-			// Check if the answer set arguments are passed in the same order
-			for (int i = 0; i < asParams.size(); i++){
-				if (asParams[i] != other.asParams[i]) return false;
-			}
+			// Check if the files read by the operator are unchanged
+			if (other.dependencyStamp != dependencyStamp) return false;
 
-			// Check if the sets of key-value arguments are equivalent (order does not matter)
-			// One direction
-			for (OperatorArguments::const_iterator it = kvParams.begin(); it != kvParams.end(); it++){
-				bool found = false;
-				for (OperatorArguments::const_iterator it2 = other.kvParams.begin(); it2 != other.kvParams.end(); it2++){
-					if ((*it) == (*it2)){
-						found = true;
-						break;
-					}
-				}
-				if (!found) return false;
-			}
+			// Check if the answer set arguments are passed in the same order
+			if (asParams != other.asParams) return false;
 
-			// Other direction
-			for (OperatorArguments::const_iterator it = other.kvParams.begin(); it != other.kvParams.end(); it++){
-				bool found = false;
-				for (OperatorArguments::const_iterator it2 = kvParams.begin(); it2 != kvParams.end(); it2++){
-					if ((*it) == (*it2)){
-						found = true;
-						break;
-					}
-				}
-				if (!found) return false;
-			}
+			// Check if the sets of key-value arguments are equivalent (order does not matter); the full comparison is only needed if the digests match
+			if (kvDigest != other.kvDigest) return false;
+			if (sortedKvParams != other.sortedKvParams) return false;
 			return true;
 			break;
 
@@ -224,6 +231,16 @@ IOperator* HexCall::getOperator() const{
 	return operatorImpl;
 }
 
+const std::string HexCall::getOperatorVersion() const{
+	assert(getType() == OperatorCall);
+	return operatorVersion;
+}
+
+const std::vector<std::string> HexCall::getDependencies() const{
+	assert(getType() == OperatorCall);
+	return dependencies;
+}
+
 const std::string HexCall::getHashCode() const{
 	assert(getType() == HexProgram || getType() == HexFile);
 	return hashcode;
@@ -239,6 +256,37 @@ const bool HexCall::getSilent() const{
 	return silent;
 }
 
+void HexCall::setLabel(const std::string& label){
+	this->label = label;
+}
+
+const std::string HexCall::getLabel() const{
+	return label;
+}
+
+
+
+// ---------- OperatorApplication ----------
+
+OperatorApplication::OperatorApplication(const HexCall& c) : call(c), adapter(c.getOperator()), parameters(c.getKvParams()), result(new HexAnswer()), evaluated(false), stored(false){
+}
+
+OperatorApplication::~OperatorApplication(){
+	if (result) delete result;
+}
+
+void OperatorApplication::evaluate(bool concurrent){
+	if (evaluated) return;
+
+	IOperatorV2* op = OperatorAdapter::get(call.getOperator(), adapter);
+	std::vector<const HexAnswer*> inputs(answers.begin(), answers.end());
+	EncodedAnswerSink sink(*result, encoded, concurrent);
+	profile.begin();
+	op->evaluate(!call.getSilent() && call.getDebug(), inputs, parameters, sink);
+	profile.end();
+	profile.setOutput(*result);
+	evaluated = true;
+}
 
 
 // ---------- HexAnswerCache ----------
@@ -246,11 +294,21 @@ const bool HexCall::getSilent() const{
 HexAnswerCache::HexAnswerCache(){
 	maxCacheEntries = -1;
 	elementsInCache = 0;
+	pool = NULL;
+	persistent = NULL;
+	atoms = NULL;
+	scheduler = NULL;
+	profiler = NULL;
 }
 
 HexAnswerCache::HexAnswerCache(int limit){
 	maxCacheEntries = limit;
 	elementsInCache = 0;
+	pool = NULL;
+	persistent = NULL;
+	atoms = NULL;
+	scheduler = NULL;
+	profiler = NULL;
 }
 
 HexAnswerCache::~HexAnswerCache(){
@@ -259,59 +317,81 @@ HexAnswerCache::~HexAnswerCache(){
 		if (cache[i].second) delete cache[i].second;
 }
 
-HexAnswer* HexAnswerCache::loadHexProgram(const HexCall& call){
+HexAnswer* HexAnswerCache::loadHexProgram(const HexCall& call, ProfileRecord& record){
 	assert(call.getType() == HexCall::HexProgram);
 
-	HexAnswer* result = new HexAnswer();
-	InputProviderPtr ip(new InputProvider());
-	ip->addStringInput(unquote(call.getProgram()), "nestedprog");
+	if (atoms) atoms->require(unquote(call.getProgram()));
 
-	std::vector<InterpretationPtr> answer = ctx->evaluateSubprogram(ip, call.getFacts());
-	BOOST_FOREACH (InterpretationPtr intr, answer){
-		result->push_back(intr);
+	record.name = "program";
+	record.addFacts(call.getFacts());
+	record.begin();
+	HexAnswer* result = new HexAnswer();
+	if (pool && pool->enabled()){
+		pool->solve(WorkerPool::Program, unquote(call.getProgram()), call.getFacts(), *result);
+	}else{
+		InputProviderPtr ip(new InputProvider());
+		ip->addStringInput(unquote(call.getProgram()), "nestedprog");
+
+		std::vector<InterpretationPtr> answer = ctx->evaluateSubprogram(ip, call.getFacts());
+		BOOST_FOREACH (InterpretationPtr intr, answer){
+			result->push_back(intr);
+		}
 	}
+	record.end();
+	record.setOutput(*result);
 
 	return result;
 }
 
-HexAnswer* HexAnswerCache::loadHexFile(const HexCall& call){
+HexAnswer* HexAnswerCache::loadHexFile(const HexCall& call, ProfileRecord& record){
 	assert(call.getType() == HexCall::HexFile);
 
-	HexAnswer* result = new HexAnswer();
+	if (atoms) atoms->requireFile(call.getProgram());
 
-	InputProviderPtr ip(new InputProvider());
-	ip->addFileInput(call.getProgram());
-
-	std::vector<InterpretationPtr> answer = ctx->evaluateSubprogram(ip, call.getFacts());
-	BOOST_FOREACH (InterpretationPtr intr, answer){
-		result->push_back(intr);
+	record.name = call.getProgram();
+	record.addFacts(call.getFacts());
+	record.begin();
+	HexAnswer* result = new HexAnswer();
+	if (pool && pool->enabled()){
+		pool->solve(WorkerPool::File, call.getProgram(), call.getFacts(), *result);
+	}else{
+		InputProviderPtr ip(new InputProvider());
+		ip->addFileInput(call.getProgram());
+
+		std::vector<InterpretationPtr> answer = ctx->evaluateSubprogram(ip, call.getFacts());
+		BOOST_FOREACH (InterpretationPtr intr, answer){
+			result->push_back(intr);
+		}
 	}
+	record.end();
+	record.setOutput(*result);
 
 	return result;
 }
 
-HexAnswer* HexAnswerCache::loadOperatorCall(const HexCall& call){
+void HexAnswerCache::prepare(OperatorApplication& app, bool lookup){
+	const HexCall& call = app.call;
 	assert(call.getType() == HexCall::OperatorCall);
-
-	HexAnswer opanswer;
+	app.profile.active = profiling();
+	app.profile.label = call.getLabel();
 
 	// make a list of pointers to all answers passed to this operator
 	std::vector<int> answerIndices = call.getAsParams();
-	std::vector<HexAnswer*> answers;
 	for (std::vector<int>::iterator it = answerIndices.begin(); it != answerIndices.end(); ++it){
 		// prevent the used cache entries from being removed
 		locks[*it]++;
-		if (cache[*it].second == NULL) load(*it);
-		answers.push_back(cache[*it].second);
+		app.locked.push_back(*it);
+		if (!loaded(*it)) load(*it);
+		app.answers.push_back(materialized(*it));
 	}
-	OperatorArguments oa = call.getKvParams();
+	app.profile.addInputs(app.answers);
 
 	// check if all passed parameters are actually expected by the operator
 	bool provided = false;
 	try{
 		std::set<std::string> params = call.getOperator()->getRecognizedParameters();
 		provided = true;
-		for (OperatorArguments::iterator it = oa.begin(); it != oa.end(); ++it){
+		for (OperatorArguments::iterator it = app.parameters.begin(); it != app.parameters.end(); ++it){
 			if (params.find(it->first) == params.end()) throw IOperator::OperatorException(std::string("Parameter \"") + it->first + std::string("\" is not recognized by this operator."));
 		}
 	}catch(...){
@@ -320,40 +400,179 @@ HexAnswer* HexAnswerCache::loadOperatorCall(const HexCall& call){
 		}
 	}
 
-	// Finally call the operator
-	opanswer = call.getOperator()->apply(!call.getSilent() && call.getDebug(), (int)call.getAsParams().size(), answers, oa);
+	// results of pure operators may be known from previous runs
+	IOperatorV2* op = OperatorAdapter::get(call.getOperator(), app.adapter);
+	app.profile.name = op->getName();
+	if (lookup){
+		if (persistent && persistent->enabled() && (op->getCapabilities(app.parameters) & IOperatorV2::Pure)){
+			app.profile.begin();
+			std::vector<const HexAnswer*> inputs(app.answers.begin(), app.answers.end());
+			app.key = persistent->key(op->getName(), call.getOperatorVersion(), app.parameters, call.getDependencies(), inputs, reg);
+			app.evaluated = persistent->load(app.key, reg, *app.result);
+			app.stored = app.evaluated;
+			if (app.evaluated){
+				app.profile.end();
+				app.profile.name += " (persistent)";
+				app.profile.setOutput(*app.result);
+			}
+		}
+	}
+}
 
-	for (std::vector<int>::iterator it = answerIndices.begin(); it != answerIndices.end(); ++it){
+void HexAnswerCache::prepare(OperatorApplication& app){
+	prepare(app, true);
+}
+
+void HexAnswerCache::decode(OperatorApplication& app){
+	if (app.encoded.size() == 0) return;
+	for (std::vector<std::string>::iterator it = app.encoded.begin(); it != app.encoded.end(); ++it){
+		BinaryAnswerReader(*it).read(reg, *app.result);
+	}
+	app.encoded.clear();
+	app.profile.setOutput(*app.result);
+}
+
+void HexAnswerCache::release(OperatorApplication& app){
+	for (std::vector<int>::iterator it = app.locked.begin(); it != app.locked.end(); ++it){
 		assert(locks[*it] > 0);
 		locks[*it]--;
 	}
+	app.locked.clear();
+}
+
+HexAnswer* HexAnswerCache::loadOperatorCall(const HexCall& call, LazyAnswerPtr& view, ProfileRecord& record){
+	assert(call.getType() == HexCall::OperatorCall);
+
+	// Finally call the operator; operators which support it deliver a view instead of the materialized answer,
+	// others write their answer-sets directly into the cache entry
+	LazyOperator* lazy = dynamic_cast<LazyOperator*>(call.getOperator());
+	OperatorApplication app(call);
+	try{
+		prepare(app, !lazy);
+		if (lazy){
+			app.profile.begin();
+			view = lazy->applyLazy((int)call.getAsParams().size(), app.answers, app.parameters);
+			app.profile.end();
+			app.profile.answersetsOut = view->size();
+			delete app.result;
+			app.result = NULL;
+		}else{
+			app.evaluate();
+			decode(app);
+			if (app.key.length() > 0 && !app.stored) persistent->store(app.key, reg, *app.result);
+		}
+	}catch(...){
+		release(app);
+		throw;
+	}
+	release(app);
+	record = app.profile;
+
+	HexAnswer* result = app.result;
+	app.result = NULL;
+	return result;
+}
+
+int HexAnswerCache::finish(OperatorApplication& app){
+	assert(app.evaluated);
+	try{
+		decode(app);
+	}catch(...){
+		release(app);
+		throw;
+	}
+	if (app.key.length() > 0 && !app.stored) persistent->store(app.key, reg, *app.result);
+	release(app);
+
+	HexAnswer* result = app.result;
+	app.result = NULL;
+	int index = insert(app.call, result);
+	app.profile.index = index;
+	if (profiler) profiler->add(app.profile);
+	return index;
+}
 
-	return new HexAnswer(opanswer);
+void HexAnswerCache::abort(OperatorApplication& app){
+	release(app);
+}
+
+int HexAnswerCache::submit(const HexCall& call){
+	assert(call.getType() == HexCall::HexProgram || call.getType() == HexCall::HexFile);
+	if (!pool || !pool->enabled() || !pool->idle()) return -1;
+
+	ProfileRecord record(profiling());
+	record.name = call.getType() == HexCall::HexProgram ? std::string("program") : call.getProgram();
+	record.addFacts(call.getFacts());
+	record.begin();
+
+	int slot;
+	if (call.getType() == HexCall::HexProgram){
+		if (atoms) atoms->require(unquote(call.getProgram()));
+		slot = pool->submit(WorkerPool::Program, unquote(call.getProgram()), call.getFacts());
+	}else{
+		if (atoms) atoms->requireFile(call.getProgram());
+		slot = pool->submit(WorkerPool::File, call.getProgram(), call.getFacts());
+	}
+
+	// the work is done by the worker process, whose CPU time and memory are not visible
+	record.thread = Profiler::WorkerLane + slot;
+	record.cpu = -1;
+	record.memory = -1;
+	jobs[slot] = record;
+	return slot;
+}
+
+bool HexAnswerCache::ready(int slot, int timeout){
+	return pool->ready(slot, timeout);
+}
+
+int HexAnswerCache::collect(const HexCall& call, int slot){
+	ProfileRecord record = jobs[slot];
+	jobs.erase(slot);
+
+	HexAnswer* result = new HexAnswer();
+	try{
+		pool->collect(slot, *result);
+	}catch(...){
+		delete result;
+		throw;
+	}
+	record.end();
+	record.setOutput(*result);
+
+	int index = insert(call, result);
+	record.index = index;
+	if (profiler) profiler->add(record);
+	return index;
 }
 
 void HexAnswerCache::load(const int index){
 	assert(index >=0 && index < size());
 
 	// this method must only be called for elements that are currently not in the cache
-	assert(cache[index].second == NULL);
+	assert(!loaded(index));
 
 	// check type of the cache entry
 	HexAnswer* result;
+	ProfileRecord record(profiling());
 	switch(cache[index].first.getType()){
 		case HexCall::HexProgram:
-			result = loadHexProgram(cache[index].first);
+			result = loadHexProgram(cache[index].first, record);
 			break;
 		case HexCall::HexFile:
-			result = loadHexFile(cache[index].first);
+			result = loadHexFile(cache[index].first, record);
 			break;
 		case HexCall::OperatorCall:
-			result = loadOperatorCall(cache[index].first);
+			result = loadOperatorCall(cache[index].first, views[index], record);
 			break;
 		default:
 			assert(0);
 			break;
 	}
 
+	record.index = index;
+	if (profiler) profiler->add(record);
+
 	// store result in the cache
 	cache[index].second = result;
 //std::cout << "Have " << cache[index].size() << " answer sets" << std::endl;
@@ -383,35 +602,81 @@ void HexAnswerCache::reduceCache(){
 		// find element with oldes access timestamp
 		int oldesAccessCounter = -1;
 		for (int i = 0; i < cache.size(); i++){
-			if (locks[i] == 0 && cache[i].second != NULL && (accessCounter[i] > oldesAccessCounter || oldesAccessCounter == -1))
+			if (locks[i] == 0 && loaded(i) && (accessCounter[i] > oldesAccessCounter || oldesAccessCounter == -1))
 				oldesAccessCounter = i;
 		}
 		if (oldesAccessCounter == -1)	// no element can be outsourced
 			return;
 		else{
 			// remove oldest element
-			delete cache[oldesAccessCounter].second;
+			if (cache[oldesAccessCounter].second) delete cache[oldesAccessCounter].second;
 			cache[oldesAccessCounter].second = NULL;
+			views[oldesAccessCounter].reset();
 			accessCounter[oldesAccessCounter] = 0;
 			elementsInCache--;
 		}
 	}
 }
 
+bool HexAnswerCache::loaded(const int index){
+	return cache[index].second != NULL || views[index];
+}
+
+HexAnswer* HexAnswerCache::materialized(const int index){
+	assert(loaded(index));
+	if (views[index]) return &views[index]->materialize();
+	return cache[index].second;
+}
+
 bool HexAnswerCache::SubprogramAnswerSetCallback::operator()(AnswerSetPtr model){
 	answersets.push_back(model->interpretation);
 	return true;
 }
 
-const int HexAnswerCache::operator[](const HexCall call){
+int HexAnswerCache::find(const HexCall& call){
 	int index = 0;
 	for (std::vector<HexAnswerCacheEntry>::iterator it = cache.begin(); it != cache.end(); ++it, index++){
 		if (it->first == call){
 			return index;
 		}
 	}
+	return -1;
+}
+
+int HexAnswerCache::insert(const HexCall& call, HexAnswer* result){
+	int index = find(call);
+	if (index >= 0){
+		// computed concurrently (or evicted in the meantime)
+		if (loaded(index)){
+			delete result;
+		}else{
+			cache[index].second = result;
+			elementsInCache++;
+		}
+	}else{
+		index = cache.size();
+		cache.push_back(std::pair<HexCall, HexAnswer*>(call, result));
+		views.push_back(LazyAnswerPtr());
+		accessCounter.push_back(0);
+		locks.push_back(0);
+		elementsInCache++;
+	}
+	access(index);
+	reduceCache();
+	return index;
+}
+
+const int HexAnswerCache::operator[](const HexCall call){
+	// the first lookup evaluates the whole merging plan (if there is one), such that independent parts are computed concurrently
+	if (scheduler && scheduler->hasPlan()) scheduler->run(*this);
+
+	int index = find(call);
+	if (index >= 0) return index;
+
 	// not in cache yet: add it
+	index = cache.size();
 	cache.push_back(std::pair<HexCall, HexAnswer*>(call, NULL));
+	views.push_back(LazyAnswerPtr());
 	accessCounter.push_back(0);
 	locks.push_back(0);
 	load(index);
@@ -424,12 +689,34 @@ HexAnswer& HexAnswerCache::operator[](const int index){
 
 	// find the entry for this call
 	// check if the result is in the cache
-	if (cache[index].second == NULL){
+	if (!loaded(index)){
 		load(index);
 	}
 	access(index);
 	// now it's in the cache for sure
-	return *(cache[index].second);
+	return *materialized(index);
+}
+
+int HexAnswerCache::getAnswerSetCount(const int index){
+	assert(index >=0 && index < size());
+
+	if (!loaded(index)){
+		load(index);
+	}
+	access(index);
+	if (views[index]) return views[index]->distinctSize();
+	return cache[index].second->size();
+}
+
+InterpretationPtr HexAnswerCache::getAnswerSet(const int index, const int answerset){
+	assert(index >=0 && index < size());
+
+	if (!loaded(index)){
+		load(index);
+	}
+	access(index);
+	if (views[index]) return views[index]->getDistinct(answerset);
+	return (*cache[index].second)[answerset];
 }
 
 const int HexAnswerCache::size(){
@@ -440,3 +727,27 @@ void HexAnswerCache::setProgramCtx(ProgramCtx& ctx){
 	this->ctx = &ctx;
 	this->reg = ctx.registry();
 }
+
+void HexAnswerCache::setWorkerPool(WorkerPool* pool){
+	this->pool = pool;
+}
+
+void HexAnswerCache::setPersistentCache(PersistentCache* persistent){
+	this->persistent = persistent;
+}
+
+void HexAnswerCache::setDynamicAtoms(DynamicAtoms* atoms){
+	this->atoms = atoms;
+}
+
+void HexAnswerCache::setPlanScheduler(PlanScheduler* scheduler){
+	this->scheduler = scheduler;
+}
+
+void HexAnswerCache::setProfiler(Profiler* profiler){
+	this->profiler = profiler;
+}
+
+bool HexAnswerCache::profiling(){
+	return profiler && profiler->enabled();
+}
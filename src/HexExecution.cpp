@@ -373,10 +373,10 @@ AnswerSetsAtom::retrieve(const Query& query, Answer& answer) throw (PluginError)
 		throw PluginError("An invalid answer handle was passed to atom &answersets");
 	}else{
 		// Return handles to all answer-sets of the given answer (all integers from 0 to the number of answer-sets minus 1)
-		int i = 0;
-		for (HexAnswer::iterator it = resultsetCache[answerindex].begin(); it != resultsetCache[answerindex].end(); it++){
+		int count = resultsetCache.getAnswerSetCount(answerindex);
+		for (int i = 0; i < count; i++){
 			Tuple out;
-			out.push_back(ID::termFromInteger(i++));
+			out.push_back(ID::termFromInteger(i));
 			answer.get().push_back(out);
 		}
 	}
@@ -408,13 +408,12 @@ PredicatesAtom::retrieve(const Query& query, Answer& answer) throw (PluginError)
 	// check index validity
 	if (answerindex < 0 || answerindex >= resultsetCache.size()){
 		throw PluginError("An invalid answer handle was passed to atom &predicates");
-	}else if(answersetindex < 0 || answersetindex >= resultsetCache[answerindex].size()){
+	}else if(answersetindex < 0 || answersetindex >= resultsetCache.getAnswerSetCount(answerindex)){
 		throw PluginError("An invalid answer-set handle was passed to atom &predicates");
 	}else{
 		// Go through all atoms of the given answer_set
-		for(Interpretation::Storage::enumerator it =
-		    (resultsetCache[answerindex])[answersetindex]->getStorage().first();
-		    it != (resultsetCache[answerindex])[answersetindex]->getStorage().end(); ++it){
+		InterpretationPtr answerset = resultsetCache.getAnswerSet(answerindex, answersetindex);
+		for(Interpretation::Storage::enumerator it = answerset->getStorage().first(); it != answerset->getStorage().end(); ++it){
 
 			if (!reg->ogatoms.getIDByAddress(*it).isAuxiliary()){
 				ID ogid(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, *it);
@@ -457,15 +456,14 @@ ArgumentsAtom::retrieve(const Query& query, Answer& answer) throw (PluginError)
 	// check index validity
 	if (answerindex < 0 || answerindex >= resultsetCache.size()){
 		throw PluginError("An invalid answer handle was passed to atom &arguments");
-	}else if(answersetindex < 0 || answersetindex >= resultsetCache[answerindex].size()){
+	}else if(answersetindex < 0 || answersetindex >= resultsetCache.getAnswerSetCount(answerindex)){
 		throw PluginError("An invalid answer-set handle was passed to atom &arguments");
 	}else{
 		int runningindex = 0;
 
 		// Go through all atoms of the given answer_set
-		for(Interpretation::Storage::enumerator it =
-		    (resultsetCache[answerindex])[answersetindex]->getStorage().first();
-		    it != (resultsetCache[answerindex])[answersetindex]->getStorage().end(); ++it){
+		InterpretationPtr answerset = resultsetCache.getAnswerSet(answerindex, answersetindex);
+		for(Interpretation::Storage::enumerator it = answerset->getStorage().first(); it != answerset->getStorage().end(); ++it){
 
 			ID ogid(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG, *it);
 			const OrdinaryAtom& ogatom = reg->ogatoms.getByID(ogid);
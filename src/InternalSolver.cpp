@@ -0,0 +1,338 @@
+#include <InternalSolver.h>
+#include <AnswerFormat.h>
+#include <BinaryAnswer.h>
+
+#include <dlvhex2/HexParser.h>
+#include <dlvhex2/InputProvider.h>
+#include <dlvhex2/InternalGrounder.h>
+#include <dlvhex2/GenuineSolver.h>
+#include <dlvhex2/Nogood.h>
+#include <dlvhex2/OrdinaryASPProgram.h>
+#include <dlvhex2/Logger.h>
+
+#include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+#include <errno.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+static bool moreExpensive(const std::pair<uint32_t, IDAddress>& a, const std::pair<uint32_t, IDAddress>& b){
+	return a.first > b.first;
+}
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+// Frames from the enumerating child process consist of a one-byte tag, the payload length (4 bytes, network byte order) and the payload:
+//	'M' (costs (4 bytes, network byte order) and the model in binary format), 'E' (enumeration finished), 'X' (error message)
+
+static bool writeAll(int fd, const char* buf, size_t len){
+	while (len > 0){
+		ssize_t written = write(fd, buf, len);
+		if (written < 0){
+			if (errno == EINTR) continue;
+			return false;
+		}
+		buf += written;
+		len -= written;
+	}
+	return true;
+}
+
+static bool writeFrame(int fd, char tag, const std::string& payload){
+	uint32_t len = htonl(payload.size());
+	return writeAll(fd, &tag, 1) && writeAll(fd, (const char*)&len, 4) && writeAll(fd, payload.data(), payload.size());
+}
+
+namespace{
+	// keeps the models of minimum costs; models which differ only in filtered atoms are reported once
+	class Collector : public InternalSolver::Listener{
+	private:
+		InternalSolver::Listener* forward;
+		boost::unordered_map<std::size_t, std::vector<int> > occurrences;	// hash value -> indices in optimal
+	public:
+		long bestCost;
+		HexAnswer optimal;
+
+		Collector(InternalSolver::Listener* forward) : forward(forward), bestCost(-1){}
+
+		void model(InterpretationPtr model, long cost){
+			if (bestCost != -1 && cost > bestCost) return;
+			if (bestCost == -1 || cost < bestCost){
+				optimal.clear();
+				occurrences.clear();
+				bestCost = cost;
+			}
+
+			std::vector<int>& candidates = occurrences[AnswerFormat::hashAnswerSet(model)];
+			BOOST_FOREACH (int i, candidates){
+				if (*optimal[i] == *model) return;
+			}
+			candidates.push_back(optimal.size());
+			optimal.push_back(model);
+			if (forward != NULL) forward->model(model, cost);
+		}
+	};
+
+	// sends the models from the child process to the parent
+	class ModelWriter : public InternalSolver::Listener{
+	private:
+		RegistryPtr reg;
+		int fd;
+	public:
+		ModelWriter(RegistryPtr reg, int fd) : reg(reg), fd(fd){}
+
+		void model(InterpretationPtr model, long cost){
+			BinaryAnswerWriter writer(reg);
+			writer.add(model);
+			std::string encoded;
+			writer.write(encoded);
+			uint32_t c = htonl(cost);
+			if (!writeFrame(fd, 'M', std::string((const char*)&c, 4) + encoded)) _exit(1);
+		}
+	};
+}
+
+ProgramCtx* InternalSolver::ctx = NULL;
+
+void InternalSolver::setProgramCtx(ProgramCtx& ctx){
+	InternalSolver::ctx = &ctx;
+}
+
+bool InternalSolver::available(){
+	return ctx != NULL;
+}
+
+bool InternalSolver::solve(const std::string& program, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, HexAnswer& result, int timeout) throw (PluginError){
+	return solve(program, std::vector<ID>(), InterpretationConstPtr(), maxint, optPredicate, filter, result, timeout);
+}
+
+bool InternalSolver::solve(const std::string& program, const std::vector<ID>& rules, InterpretationConstPtr facts, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, HexAnswer& result, int timeout, Listener* listener) throw (PluginError){
+	if (!available()) throw PluginError("Internal solver was not initialized");
+
+	Collector collector(listener);
+	bool complete = true;
+	if (timeout > 0){
+		complete = enumerateForked(program, rules, facts, maxint, optPredicate, filter, collector, timeout);
+	}else{
+		enumerate(program, rules, facts, maxint, optPredicate, filter, collector);
+	}
+	result.insert(result.end(), collector.optimal.begin(), collector.optimal.end());
+	return complete;
+}
+
+void InternalSolver::enumerate(const std::string& program, const std::vector<ID>& rules, InterpretationConstPtr facts, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, Listener& listener) throw (PluginError){
+	RegistryPtr reg = ctx->registry();
+
+	// parse the program into a subcontext sharing our registry
+	DBGLOG(DBG, "Parsing optimization program");
+	ProgramCtx pc;
+	pc.changeRegistry(reg);
+	InputProviderPtr ip(new InputProvider());
+	ip->addStringInput(program, "optimizationprogram");
+	try{
+		ModuleHexParser hp;
+		hp.parse(ip, pc);
+	}catch(SyntaxError& e){
+		throw PluginError(std::string("Could not parse optimization program: ") + e.what());
+	}
+
+	// the costs are computed from the optimization predicate below; weak constraints would silently be ignored, thus they are rejected
+	// (the additional rules and facts were parsed before)
+	std::vector<ID> idb(pc.idb.begin(), pc.idb.end());
+	idb.insert(idb.end(), rules.begin(), rules.end());
+	BOOST_FOREACH (ID rule, idb){
+		if (rule.isWeakConstraint()) throw PluginError("Weak constraints are not supported by the internal solver");
+	}
+	InterpretationPtr edb(new Interpretation(reg));
+	if (pc.edb != InterpretationPtr()) edb->add(*pc.edb);
+	if (facts != InterpretationConstPtr()) edb->add(*facts);
+
+	DBGLOG(DBG, "Grounding optimization program");
+	OrdinaryASPProgram nonground(reg, idb, edb, maxint);
+	InternalGrounderPtr ig = InternalGrounderPtr(new InternalGrounder(pc, nonground));
+	OrdinaryASPProgram ground = ig->getGroundProgram();
+
+	// ground atoms over the optimization predicate which can be derived, most expensive first
+	ID optID = reg->terms.getIDByString(optPredicate);
+	std::vector<std::pair<uint32_t, IDAddress> > costAtoms;
+	BOOST_FOREACH (ID rule, ground.idb){
+		BOOST_FOREACH (ID head, reg->rules.getByID(rule).head){
+			const OrdinaryAtom& ogatom = reg->ogatoms.getByID(head);
+			if (ogatom.tuple[0] == optID && ogatom.tuple.size() > 1 && ogatom.tuple.back().isIntegerTerm()){
+				costAtoms.push_back(std::pair<uint32_t, IDAddress>(ogatom.tuple.back().address, head.address));
+			}
+		}
+	}
+	std::sort(costAtoms.begin(), costAtoms.end(), moreExpensive);
+	int excluded = 0;	// costAtoms[0 .. excluded-1] are forbidden by nogoods
+
+	DBGLOG(DBG, "Enumerating models of optimization program");
+	GenuineSolverPtr solver = GenuineSolver::getInstance(pc, ground);
+	long bestCost = -1;
+	InterpretationPtr model;
+	while ((model = solver->getNextModel()) != InterpretationPtr()){
+		long cost = 0;
+		InterpretationPtr projected(new Interpretation(reg));
+		for (Interpretation::Storage::enumerator it = model->getStorage().first(); it != model->getStorage().end(); ++it){
+			ID ogid = reg->ogatoms.getIDByAddress(*it);
+			const OrdinaryAtom& ogatom = reg->ogatoms.getByID(ogid);
+
+			// strongly negated atoms are filtered by their positive predicate, other auxiliary atoms are dropped
+			ID predicate = ogatom.tuple[0];
+			if (ogid.isAuxiliary()){
+				if (reg->getTypeByAuxiliaryConstantSymbol(predicate) != 's') continue;
+				predicate = reg->getIDByAuxiliaryConstantSymbol(predicate);
+			}
+
+			if (predicate == optID && ogatom.tuple.size() > 1 && ogatom.tuple.back().isIntegerTerm()){
+				cost += ogatom.tuple.back().address;
+			}
+			if (filter.size() == 0 || filter.count(reg->terms.getByID(predicate).getUnquotedString()) > 0){
+				projected->setFact(*it);
+			}
+		}
+
+		// models above the best costs so far cannot be optimal
+		if (bestCost != -1 && cost > bestCost) continue;
+		if (bestCost == -1 || cost < bestCost){
+			bestCost = cost;
+
+			// branch-and-bound: costs are not negative, thus models containing a cost atom above the bound cannot be optimal
+			while (excluded < costAtoms.size() && costAtoms[excluded].first > bestCost){
+				Nogood ng;
+				ng.insert(NogoodContainer::createLiteral(costAtoms[excluded].second, true));
+				solver->addNogood(ng);
+				excluded++;
+			}
+		}
+		listener.model(projected, cost);
+	}
+}
+
+bool InternalSolver::enumerateForked(const std::string& program, const std::vector<ID>& rules, InterpretationConstPtr facts, uint32_t maxint, const std::string& optPredicate, const std::set<std::string>& filter, Listener& listener, int timeout) throw (PluginError){
+	double deadline = now() + timeout / 1000.0;
+	RegistryPtr reg = ctx->registry();
+
+	int channel[2];
+	if (pipe(channel) != 0) throw PluginError("Could not create pipe for the internal solver");
+	std::cout.flush();
+	std::cerr.flush();
+	pid_t pid = fork();
+	if (pid < 0){
+		close(channel[0]);
+		close(channel[1]);
+		throw PluginError("Could not fork the internal solver");
+	}
+	if (pid == 0){
+		// child: enumerate and stream the models; the registry is a copy, thus the models are sent in binary format (with symbols)
+		close(channel[0]);
+		try{
+			ModelWriter writer(reg, channel[1]);
+			enumerate(program, rules, facts, maxint, optPredicate, filter, writer);
+			writeFrame(channel[1], 'E', std::string());
+		}catch(std::exception& e){
+			writeFrame(channel[1], 'X', e.what());
+		}catch(...){
+			writeFrame(channel[1], 'X', "unknown error");
+		}
+		_exit(0);
+	}
+	close(channel[1]);
+	int fd = channel[0];
+
+	// receive models until the enumeration finishes or the time budget is exceeded; the deadline is checked after each received model
+	// is handed to the listener, and the child is killed even while its solver searches for the next model
+	std::string buffer;
+	std::string error;
+	bool finished = false;
+	bool complete = false;
+	bool received = false;
+	while (!finished){
+		// without any model so far, we wait for the first one (anytime behaviour needs at least one model)
+		int wait = -1;
+		if (received){
+			double left = deadline - now();
+			if (left <= 0) break;
+			wait = (int)(left * 1000) + 1;
+		}
+
+		struct pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		int p = poll(&pfd, 1, wait);
+		if (p < 0 && errno != EINTR) break;
+		if (p <= 0) continue;
+
+		char chunk[65536];
+		ssize_t r = read(fd, chunk, sizeof(chunk));
+		if (r < 0){
+			if (errno == EINTR) continue;
+			break;
+		}
+		if (r == 0){
+			if (error.length() == 0) error = "Internal solver process terminated unexpectedly";
+			break;
+		}
+		buffer.append(chunk, r);
+
+		// process the complete frames
+		size_t pos = 0;
+		while (!finished && buffer.size() - pos >= 5){
+			uint32_t len;
+			memcpy(&len, buffer.data() + pos + 1, 4);
+			len = ntohl(len);
+			if (buffer.size() - pos - 5 < len) break;
+			char tag = buffer[pos];
+			std::string payload = buffer.substr(pos + 5, len);
+			pos += 5 + len;
+
+			if (tag == 'M' && payload.size() >= 4){
+				uint32_t cost;
+				memcpy(&cost, payload.data(), 4);
+				HexAnswer models;
+				BinaryAnswerReader(payload.data() + 4, payload.size() - 4).read(reg, models);
+				BOOST_FOREACH (InterpretationPtr model, models){
+					listener.model(model, ntohl(cost));
+				}
+				received = true;
+			}else if (tag == 'E'){
+				complete = true;
+				finished = true;
+			}else{
+				error = tag == 'X' ? payload : std::string("Invalid message from the internal solver process");
+				finished = true;
+			}
+		}
+		buffer.erase(0, pos);
+		if (error.length() > 0) break;
+	}
+
+	if (!finished){
+		DBGLOG(DBG, "Time budget exceeded, stopping enumeration");
+		kill(pid, SIGKILL);
+	}
+	close(fd);
+	while (waitpid(pid, NULL, 0) < 0 && errno == EINTR);
+
+	if (error.length() > 0) throw PluginError(error);
+	return complete;
+}
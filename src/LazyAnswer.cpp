@@ -0,0 +1,224 @@
+#include <LazyAnswer.h>
+#include <AnswerFormat.h>
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <new>
+
+#include <pthread.h>
+#include <unistd.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+// appends an answer-set with the given hash value to "out" unless it is already contained
+static void appendUnique(InterpretationPtr set, std::size_t hash, HexAnswer& out, boost::unordered_map<std::size_t, std::vector<int> >& occurrences){
+	std::vector<int>& candidates = occurrences[hash];
+	for (int c = 0; c < candidates.size(); c++){
+		if (out[candidates[c]]->getStorage() == set->getStorage()) return;
+	}
+	candidates.push_back(out.size());
+	out.push_back(set);
+}
+
+// combinations per band (bounds the memory for non-unique combinations) and per tile (unit of work of a thread)
+static const int BandSize = 1 << 16;
+static const int TileSize = 256;
+
+
+// ---------- LazyAnswer ----------
+
+struct LazyAnswer::Band{
+	const LazyAnswer* answer;
+	int first;			// index of the first combination in this band
+	int count;
+	int nextTile;			// next tile to be taken by a thread
+	bool failed;
+	HexAnswer sets;			// preallocated result storage
+	std::vector<std::size_t> hashes;
+};
+
+int LazyAnswer::threads = 0;
+
+LazyAnswer::LazyAnswer(Operation op, const std::vector<HexAnswer*>& answers, bool memo) throw (IOperator::OperatorException) : operation(op), memoize(memo), materialized(false), indexed(false){
+	assert(answers.size() > 0);
+
+	long long product = 1;
+	operands.resize(answers.size());
+	for (int o = 0; o < answers.size(); o++){
+		boost::unordered_map<std::size_t, std::vector<int> > occurrences;
+		for (int i = 0; i < answers[o]->size(); i++) appendUnique((*answers[o])[i], AnswerFormat::hashAnswerSet((*answers[o])[i]), operands[o], occurrences);
+		product *= operands[o].size();
+		if (product > INT_MAX) throw IOperator::OperatorException("Too many combinations of answer-sets");
+	}
+	count = (int)product;
+}
+
+void LazyAnswer::apply(InterpretationPtr set, InterpretationConstPtr operand) const{
+	switch (operation){
+		case Union:
+			set->getStorage() |= operand->getStorage();
+			break;
+		case Intersection:
+			set->getStorage() &= operand->getStorage();
+			break;
+		case Setminus:
+			set->getStorage() -= operand->getStorage();
+			break;
+		default:
+			assert(0);
+			break;
+	}
+}
+
+// combines the first operandCount operands; index enumerates their combinations (the last operand varies fastest)
+InterpretationPtr LazyAnswer::combine(int index, int operandCount) const{
+	std::vector<int> selected(operandCount);
+	for (int o = operandCount - 1; o >= 0; o--){
+		selected[o] = index % operands[o].size();
+		index /= operands[o].size();
+	}
+
+	InterpretationPtr set = InterpretationPtr(new Interpretation(*operands[0][selected[0]]));
+	for (int o = 1; o < operandCount; o++) apply(set, operands[o][selected[o]]);
+	return set;
+}
+
+void* LazyAnswer::combineTiles(void* arg){
+	Band* band = (Band*)arg;
+	const LazyAnswer* answer = band->answer;
+	const HexAnswer& last = answer->operands.back();
+	int tiles = (band->count + TileSize - 1) / TileSize;
+	int tile;
+	while ((tile = __sync_fetch_and_add(&band->nextTile, 1)) < tiles){
+		int end = std::min(band->count, (tile + 1) * TileSize);
+		try{
+			// consecutive combinations share the answer-sets of all but the last operand
+			int prefixIndex = -1;
+			InterpretationPtr prefix;
+			for (int i = tile * TileSize; i < end; i++){
+				int index = band->first + i;
+
+				// the memoized combinations are only read while materializing
+				boost::unordered_map<int, InterpretationPtr>::const_iterator it = answer->computed.find(index);
+				if (it != answer->computed.end()){
+					band->sets[i] = it->second;
+				}else if (answer->operands.size() == 1){
+					band->sets[i] = answer->combine(index, 1);
+				}else{
+					if (index / last.size() != prefixIndex){
+						prefixIndex = index / last.size();
+						prefix = answer->combine(prefixIndex, answer->operands.size() - 1);
+					}
+					InterpretationPtr set = InterpretationPtr(new Interpretation(*prefix));
+					answer->apply(set, last[index % last.size()]);
+					band->sets[i] = set;
+				}
+				band->hashes[i] = AnswerFormat::hashAnswerSet(band->sets[i]);
+			}
+		}catch(std::bad_alloc&){
+			band->failed = true;
+			return NULL;
+		}
+	}
+	return NULL;
+}
+
+int LazyAnswer::size() const{
+	return count;
+}
+
+InterpretationPtr LazyAnswer::get(int index){
+	assert(index >= 0 && index < size());
+
+	if (!memoize) return combine(index, operands.size());
+
+	boost::unordered_map<int, InterpretationPtr>::iterator it = computed.find(index);
+	if (it != computed.end()) return it->second;
+	InterpretationPtr set = combine(index, operands.size());
+	computed[index] = set;
+	return set;
+}
+
+void LazyAnswer::buildIndex(){
+	// the combinations are hashed one by one without memoizing them; only the first occurrences with the same hash are looked up again
+	boost::unordered_map<std::size_t, std::vector<int> > occurrences;
+	for (int i = 0; i < size(); i++){
+		InterpretationPtr set = combine(i, operands.size());
+		std::vector<int>& candidates = occurrences[AnswerFormat::hashAnswerSet(set)];
+		bool duplicate = false;
+		for (int c = 0; !duplicate && c < candidates.size(); c++){
+			if (get(candidates[c])->getStorage() == set->getStorage()) duplicate = true;
+		}
+		if (!duplicate){
+			candidates.push_back(i);
+			distinct.push_back(i);
+		}
+	}
+	indexed = true;
+}
+
+int LazyAnswer::distinctSize(){
+	if (!indexed) buildIndex();
+	return distinct.size();
+}
+
+InterpretationPtr LazyAnswer::getDistinct(int index){
+	if (!indexed) buildIndex();
+	assert(index >= 0 && index < distinct.size());
+	return get(distinct[index]);
+}
+
+HexAnswer& LazyAnswer::materialize(){
+	if (!materialized){
+		int threadCount = threads > 0 ? threads : std::max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+
+		// only the unique combinations of previous bands are kept in memory
+		boost::unordered_map<std::size_t, std::vector<int> > occurrences;
+		Band band;
+		band.answer = this;
+		for (band.first = 0; band.first < size(); band.first += BandSize){
+			band.count = std::min(BandSize, size() - band.first);
+			band.nextTile = 0;
+			band.failed = false;
+			band.sets.assign(band.count, InterpretationPtr());
+			band.hashes.assign(band.count, 0);
+
+			// the calling thread takes tiles as well; if threads cannot be created, the others do the remaining work
+			int tiles = (band.count + TileSize - 1) / TileSize;
+			std::vector<pthread_t> workers;
+			for (int t = 1; t < std::min(threadCount, tiles); t++){
+				pthread_t worker;
+				if (pthread_create(&worker, NULL, combineTiles, &band) == 0) workers.push_back(worker);
+			}
+			combineTiles(&band);
+			for (int t = 0; t < workers.size(); t++) pthread_join(workers[t], NULL);
+			if (band.failed) throw std::bad_alloc();
+
+			for (int i = 0; i < band.count; i++) appendUnique(band.sets[i], band.hashes[i], result, occurrences);
+		}
+		materialized = true;
+	}
+	return result;
+}
+
+LazyAnswerPtr LazyAnswer::fromParameters(Operation op, const std::vector<HexAnswer*>& operands, OperatorArguments& parameters) throw (IOperator::OperatorException){
+	bool memoize = true;
+	for (OperatorArguments::iterator argIt = parameters.begin(); argIt != parameters.end(); argIt++){
+		if (argIt->first == std::string("memoize")){
+			if (argIt->second != std::string("true") && argIt->second != std::string("false")){
+				throw IOperator::OperatorException(std::string("memoize must be \"true\" or \"false\". \"") + argIt->second + std::string("\" was passed"));
+			}
+			memoize = argIt->second == std::string("true");
+		}
+	}
+	return LazyAnswerPtr(new LazyAnswer(op, operands, memoize));
+}
+
+void LazyAnswer::setThreads(int threads){
+	LazyAnswer::threads = threads;
+}
@@ -15,9 +15,16 @@
 #include <iostream>
 #include <DLVHexProcess.h>
 #include <HexExecution.h>
+#include <WorkerPool.h>
+#include <PersistentCache.h>
+#include <DynamicAtoms.h>
+#include <PlanScheduler.h>
+#include <Profiler.h>
+#include <InternalSolver.h>
 #include <Operators.h>
 #include <Operators.h>
 #include <ArbProcess.h>
+#include <DLVOutputScanner.h>
 #include <SpiritParser.h>
 #include <ParseTreeNode.h>
 #include <CodeGenerator.h>
@@ -49,30 +56,12 @@ namespace dlvhex {
 				virtual void
 				convert(std::istream& i, std::ostream& o)
 				{
+					// Stream the program through the input rewriter and overwrite the input program with its output
 					ArbProcess rewriter(command);
-					rewriter.spawn();
-
-					std::istream& pi = rewriter.getInput();
-					std::ostream& po = rewriter.getOutput();
-					std::string line;
-
-					// Send program to input rewriter
-					while(getline(i, line)) {
-						po << line << std::endl;
-					}
-					rewriter.endoffile();
-
-					// Read output from input rewriter and overwrite the input program with modified one
-					std::stringstream routput;
-					while(getline(pi, line)) {
-						routput << line << std::endl;
-					}
-					o << routput.str();
-
+					int errcode = rewriter.filter(i, o);
 
 					// On errors throw a PluginError
-					int errcode;
-					if((errcode = rewriter.close()) != 0){
+					if(errcode != 0){
 						throw PluginError(std::string("Error from rewriter \"") + command + std::string("\""));
 					}
 
@@ -83,8 +72,9 @@ namespace dlvhex {
 			{
 			private:
 				bool dumpmp;
+				PlanScheduler* scheduler;
 			public:
-				MPCompiler(bool dump) : dumpmp(dump){}
+				MPCompiler(bool dump, PlanScheduler* s) : dumpmp(dump), scheduler(s){}
 
 				virtual void
 				convert(std::istream& i, std::ostream& o)
@@ -120,6 +110,9 @@ namespace dlvhex {
 							throw PluginError("Merging plan compilation failed");
 						}
 
+						// the plan is evaluated by the scheduler as soon as the translated program accesses the first result
+						if (!dumpmp && scheduler) scheduler->setPlan(cginst.getPlan());
+
 						delete parseTree;
 					}else{
 						std::cerr << "Parsing finished with errors:" << std::endl;
@@ -139,41 +132,15 @@ namespace dlvhex {
 				{
 				}
 
-				std::string diagToAs(std::string s){
-					// replace all blanks with ,
-					for (int i = 0; i < s.length(); i++) if (s[i] == ' ') s[i] = ',';
-					return s;
-				}
-
 				virtual void
 				convert(std::istream& i, std::ostream& o)
 				{
-					std::stringstream dlvoutput;
-					Rewriter::convert(i, dlvoutput);
-
 					// strip off dlv's meta output concerning cost and diagnosis (since this is not valid dlvhex output format)
-					std::string dlv = dlvoutput.str();
-
-					while (dlv.length() > 0){
-						if (dlv[0] == '{'){
-							// print everything until '}'
-							std::cout << dlv.substr(0, dlv.find_first_of("}") + 1) << std::endl;
-							dlv = dlv.substr(dlv.find_first_of("}") + 1);
-						}else{
-							std::string diag("Diagnosis: ");
-							if (dlv.substr(0, diag.length()) == diag){
-								std::string firstDiag = std::string("{") + diagToAs(dlv.substr(diag.length(), dlv.find_first_of("\n") - diag.length())) + std::string("}");
-								dlv = firstDiag + dlv.substr(dlv.find_first_of("\n") + 1);
-							}
-							// goto first '{' (if contained)
-							if (dlv.find_first_of("{") == std::string::npos){
-								// not contained: finished
-								dlv = "";
-							}else{
-								dlv = dlv.substr(dlv.find_first_of("{"));
-							}
-						}
-					}
+					// while dlv is running
+					DLVOutputScanner scanner(std::cout);
+					std::ostream dlvoutput(&scanner);
+					Rewriter::convert(i, dlvoutput);
+					scanner.finish();
 
 					o << ":- not a.";
 				}
@@ -186,12 +153,19 @@ namespace dlvhex {
 
 			// Cache for answer sets
 			HexAnswerCache resultsetCache;
+			// Atoms with one instance per arity, created when they are referenced
+			DynamicAtoms dynamicAtoms(resultsetCache);
+			// Solver processes for nested programs (disabled by default)
+			WorkerPool solverPool;
+			// Results of pure operators kept across runs (disabled by default)
+			PersistentCache operatorCache;
+			// Concurrent evaluation of merging plans
+			PlanScheduler planScheduler;
+			// Measurements of operator applications and nested programs (disabled by default)
+			Profiler profiler;
 			class MergingPlugin : public PluginInterface
 			{
 			private:
-				static const int CALL_MAX_ARITY = 32;
-				static const int SIMULATOR_MAX_ARITY = 5;
-
 				bool silentMode;
 				bool debugMode;
 
@@ -220,27 +194,33 @@ namespace dlvhex {
 				virtual PluginConverterPtr
 				createConverter(ProgramCtx& ctx)
 				{
-					return inputrewriter;
+					// the atoms referenced by the (rewritten) input are registered before it is parsed
+					dynamicAtoms.setProgramCtx(ctx);
+					return PluginConverterPtr(new AtomScanner(inputrewriter, dynamicAtoms));
 				}
 
 				virtual std::vector<PluginAtomPtr> createAtoms(ProgramCtx& ctx) const
 				{
 					resultsetCache.setProgramCtx(ctx);
+					solverPool.setProgramCtx(ctx);
+					InternalSolver::setProgramCtx(ctx);
+					resultsetCache.setWorkerPool(&solverPool);
+					resultsetCache.setPersistentCache(&operatorCache);
+					dynamicAtoms.setProgramCtx(ctx);
+					resultsetCache.setDynamicAtoms(&dynamicAtoms);
+					solverPool.setDynamicAtoms(&dynamicAtoms);
+					planScheduler.setProgramCtx(ctx);
+					planScheduler.setOperatorAtom(operator_atom);
+					resultsetCache.setPlanScheduler(&planScheduler);
+					resultsetCache.setProfiler(&profiler);
+					planScheduler.setProfiler(&profiler);
 
 					std::vector<PluginAtomPtr> ret;
 			
 					// return smart pointer with deleter (i.e., delete code compiled into this plugin)
 					ret.push_back(PluginAtomPtr(new HexAtom(resultsetCache), PluginPtrDeleter<PluginAtom>()));
 					ret.push_back(PluginAtomPtr(new HexFileAtom(resultsetCache), PluginPtrDeleter<PluginAtom>()));
-					for (int i = 0; i < CALL_MAX_ARITY; ++i){
-						ret.push_back(PluginAtomPtr(new CallHexAtom(resultsetCache, i), PluginPtrDeleter<PluginAtom>()));
-						ret.push_back(PluginAtomPtr(new CallHexFileAtom(resultsetCache, i), PluginPtrDeleter<PluginAtom>()));
-					}
-					for (int in = 0; in <= SIMULATOR_MAX_ARITY; ++in){
-						for (int out = 0; out <= SIMULATOR_MAX_ARITY; ++out){
-							ret.push_back(PluginAtomPtr(new SimulatorAtom(ctx, in, out), PluginPtrDeleter<PluginAtom>()));
-						}
-					}
+					// &callhexN, &callhexfileN and &simulatorI_O are added by dynamicAtoms for the arities in use
 					ret.push_back(PluginAtomPtr(new AnswerSetsAtom(resultsetCache), PluginPtrDeleter<PluginAtom>()));
 					ret.push_back(PluginAtomPtr(new PredicatesAtom(resultsetCache), PluginPtrDeleter<PluginAtom>()));
 					ret.push_back(PluginAtomPtr(new ArgumentsAtom(resultsetCache), PluginPtrDeleter<PluginAtom>()));
@@ -255,6 +235,8 @@ namespace dlvhex {
 					debugMode = false;
 					bool opinforequested = false;
 					std::string opinfo;
+					bool manifestgiven = false;
+					std::string manifest;
 
 					for (std::list<const char*>::iterator it = pluginOptions.begin(); 
 						 it != pluginOptions.end(); 
@@ -286,6 +268,13 @@ namespace dlvhex {
 							found.push_back(it);
 						}
 
+						if (	option.substr(0, std::string("--operatormanifest=").size()) == std::string("--operatormanifest=")){
+							manifestgiven = true;
+							manifest = removeQuotes(option.substr(option.find_first_of('=', 0) + 1));
+
+							found.push_back(it);
+						}
+
 						// input rewriters
 						if (	option.substr(0, std::string("--inputrewriter=").size()) == std::string("--inputrewriter=") ||
 							option.substr(0, std::string("--irw=").size()) == std::string("--irw=")){
@@ -296,12 +285,17 @@ namespace dlvhex {
 						}
 
 						// merging plans
-						if (	option.substr(0, std::string("--merging").size()) == std::string("--merging")){
-							if (inputrewriter) throw PluginError("Multiple rewriters were passed! (option --dlv and --merging counts as rewriter)");							if (option.substr(0, std::string("--mergingdump").size()) == std::string("--mergingdump")){
-								inputrewriter = PluginConverterPtr(new MPCompiler(true));
-							}else{
-								inputrewriter = PluginConverterPtr(new MPCompiler(false));
-							}
+						if (	option == std::string("--merging") ||
+							option == std::string("--mergingdump")){
+							if (inputrewriter) throw PluginError("Multiple rewriters were passed! (option --dlv and --merging counts as rewriter)");
+							inputrewriter = PluginConverterPtr(new MPCompiler(option == std::string("--mergingdump"), &planScheduler));
+
+							found.push_back(it);
+						}
+
+						// profiling
+						if (	option.substr(0, std::string("--mergingprofile=").size()) == std::string("--mergingprofile=")){
+							profiler.setFile(removeQuotes(option.substr(option.find_first_of('=', 0) + 1)));
 
 							found.push_back(it);
 						}
@@ -314,6 +308,51 @@ namespace dlvhex {
 							found.push_back(it);
 						}
 
+						// solver processes for nested programs
+						if (	option.substr(0, std::string("--workerpool=").size()) == std::string("--workerpool=")){
+							std::string size = option.substr(option.find_first_of('=', 0) + 1);
+							char* end;
+							long workers = strtol(size.c_str(), &end, 10);
+							if (size.length() == 0 || *end != '\0' || workers < 0){
+								throw PluginError("Invalid number of workers: \"" + size + "\"");
+							}
+							solverPool.setSize(workers);
+
+							found.push_back(it);
+						}
+						if (	option.substr(0, std::string("--workerprotocol=").size()) == std::string("--workerprotocol=")){
+							std::string protocol = option.substr(option.find_first_of('=', 0) + 1);
+							if (protocol == "binary"){
+								solverPool.setBinaryProtocol(true);
+							}else if (protocol == "text"){
+								solverPool.setBinaryProtocol(false);
+							}else{
+								throw PluginError("Unknown worker protocol: \"" + protocol + "\" (expected binary or text)");
+							}
+
+							found.push_back(it);
+						}
+
+						// concurrent evaluation of merging plans
+						if (	option.substr(0, std::string("--planthreads=").size()) == std::string("--planthreads=")){
+							std::string count = option.substr(option.find_first_of('=', 0) + 1);
+							char* end;
+							long threads = strtol(count.c_str(), &end, 10);
+							if (count.length() == 0 || *end != '\0' || threads < 0){
+								throw PluginError("Invalid number of plan threads: \"" + count + "\"");
+							}
+							planScheduler.setThreads(threads);
+
+							found.push_back(it);
+						}
+
+						// persistent cache for operator results
+						if (	option.substr(0, std::string("--operatorcache=").size()) == std::string("--operatorcache=")){
+							operatorCache.setDirectory(removeQuotes(option.substr(option.find_first_of('=', 0) + 1)));
+
+							found.push_back(it);
+						}
+
 						// wrapper for pure dlv programs
 						if (	option.substr(0, std::string("--dlv").size()) == std::string("--dlv")){
 							std::string dlvargs;
@@ -336,24 +375,30 @@ namespace dlvhex {
 						pluginOptions.erase(*it);
 				    	}
 
+					planScheduler.setDebug(debugMode);
 					if (operator_atom != NULL){
 						operator_atom->setMode(true, debugMode);
 
+						std::stringstream userplugindir;
+						const char* homedir = ::getpwuid(::geteuid())->pw_dir;
+						userplugindir << homedir << "/" << USER_PLUGIN_DIR;
+
+						// Libraries listed in the manifest are opened on first use
+						operator_atom->setManifest(manifestgiven ? manifest : userplugindir.str() + "/mergingplugin.manifest");
+
 						// Load all operators found in dlvhex' system plugin libraries
 						std::stringstream sysplugindir;
 						sysplugindir << SYS_PLUGIN_DIR;
 						operator_atom->addOperators(sysplugindir.str());
 
 						// Load all operators found in dlvhex' user plugin libraries
-						std::stringstream userplugindir;
-						const char* homedir = ::getpwuid(::geteuid())->pw_dir;
-						userplugindir << homedir << "/" << USER_PLUGIN_DIR;
 						operator_atom->addOperators(userplugindir.str());
 
 						// Load additional operator directories
 						for (std::vector<std::string>::iterator it = searchpaths.begin(); it != searchpaths.end(); it++){
 							operator_atom->addOperators(*it);
 						}
+						operator_atom->saveManifest();
 
 						if (opinforequested){
 							try{
@@ -431,8 +476,33 @@ namespace dlvhex {
 						<< "                 arguments that are passed to dlv." << std::endl
 						<< " --operatorinfo  Shows additional information about the specified operator" << std::endl
 						<< " or     --opinfo Example: --opinfo=dalal" << std::endl
+						<< " --operatormanifest=FILE" << std::endl
+						<< "                 File which lists the operators of each library, such that libraries" << std::endl
+						<< "                 are only opened when one of their operators is used. It is updated" << std::endl
+						<< "                 automatically when libraries change. Default: mergingplugin.manifest" << std::endl
+						<< "                 in the user plugin directory; an empty value opens all libraries" << std::endl
 						<< " --operatordebug Adds more details during operator loading and is useful for operator." << std::endl
 						<< "                 debugging. If --silent is passed, this flag is ignored." << std::endl
+						<< " --workerpool=N  Evaluates nested hex programs (&hex, &hexfile, &callhex, ...) in N" << std::endl
+						<< "                 long-lived solver processes rather than within this process." << std::endl
+						<< "                 Avoids the startup costs of the subprogram evaluation when many" << std::endl
+						<< "                 small programs are called. Default: 0 (disabled)" << std::endl
+						<< " --workerprotocol=binary|text" << std::endl
+						<< "                 Format in which the workers return answers: compact binary" << std::endl
+						<< "                 encoding (default) or dlvhex' textual output format" << std::endl
+						<< " --operatorcache=DIR" << std::endl
+						<< "                 Stores the results of pure operators (e.g. dalal) in DIR and reuses" << std::endl
+						<< "                 them in later runs as long as the arguments, the parameters and the" << std::endl
+						<< "                 files read by the operator (e.g. constraint files) are unchanged" << std::endl
+						<< " --mergingprofile=FILE" << std::endl
+						<< "                 Measures each operator application and nested program (wall and" << std::endl
+						<< "                 CPU time, memory, answer-sets and atoms in and out). Writes a" << std::endl
+						<< "                 table sorted by wall time to FILE and a Chrome trace (see" << std::endl
+						<< "                 chrome://tracing) to FILE.trace.json" << std::endl
+						<< " --planthreads=N Evaluates independent parts of merging plans concurrently: belief" << std::endl
+						<< "                 bases in the worker pool (see --workerpool) and applications of" << std::endl
+						<< "                 thread-safe operators in up to N threads. 0 evaluates the plan" << std::endl
+						<< "                 while the translated program is solved. Default: number of CPUs" << std::endl
 						<< "" << std::endl << std::endl;
 				}
 			};
@@ -0,0 +1,40 @@
+#include <OpIntersection.h>
+
+#include <sstream>
+#include <iostream>
+
+using namespace dlvhex::merging::plugin;
+
+std::string OpIntersection::getName(){
+	return "intersection";
+}
+
+std::string OpIntersection::getInfo(){
+	std::stringstream ss;
+	ss <<	"     intersection" << std::endl <<
+		"     ------------" << std::endl << std::endl <<
+		"Expects at least two inputs" << std::endl <<
+		"Computes the intersection of one answer-set of each argument for all combinations." << std::endl << std::endl <<
+		"Parameters:" << std::endl <<
+		"     memoize: \"true\" (default) stores combined answer-sets when they are accessed for the first time, \"false\" recomputes them";
+	return ss.str();
+}
+
+std::set<std::string> OpIntersection::getRecognizedParameters(){
+	std::set<std::string> list;
+	list.insert("memoize");
+	return list;
+}
+
+LazyAnswerPtr OpIntersection::applyLazy(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
+	if (arity < 2){
+		throw IOperator::OperatorException("Error: The intersection operator expects at least 2 arguments.");
+	}
+
+	// the combinations are only computed on access
+	return LazyAnswer::fromParameters(LazyAnswer::Intersection, arguments, parameters);
+}
+
+HexAnswer OpIntersection::apply(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
+	return applyLazy(arity, arguments, parameters)->materialize();
+}
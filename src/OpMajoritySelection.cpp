@@ -1,9 +1,27 @@
 #include <OpMajoritySelection.h>
 
+#include <dlvhex2/Registry.h>
+
+#include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
+
 #include <sstream>
 
+using namespace dlvhex;
 using namespace dlvhex::merging::plugin;
 
+
+// -------------------- Util (local functions!) --------------------
+
+// a ground atom which votes for (positive) or against (strongly negated) the atom with the same arguments
+struct Voter{
+	int entry;
+	bool negated;
+};
+
+
+// ---------- OpMajoritySelection ----------
+
 std::string OpMajoritySelection::getName(){
 	return "majorityselection";
 }
@@ -13,10 +31,10 @@ std::string OpMajoritySelection::getInfo(){
 	ss <<	"     majorityselection" << std::endl <<
 		"     -----------------" << std::endl << std::endl <<
 		"Expects exactly one input with arbitrary many answer-sets." << std::endl <<
-		"The argument \"majorityOf\" is mandatory and defines exactly one propositional atom name." << std::endl <<
-		"The operator will then check if the majority of all answer-sets accept or deny this atom." << std::endl <<
-		"Finally, only those answer-sets that follow this majority" << std::endl <<
-		"will remain; the others are deleted" << std::endl <<
+		"The argument \"majorityOf\" is mandatory and defines a predicate name; it can be passed multiple times." << std::endl <<
+		"For each ground atom over these predicates, the operator will check if the majority of all answer-sets accept or deny it." << std::endl <<
+		"Finally, only those answer-sets that follow the majority for all of these atoms" << std::endl <<
+		"will remain; the others are deleted. Atoms which are accepted and denied equally often are not considered." << std::endl <<
 		"Example: {a,b,c}, {a, -b, -c}, {-b, d} with majorityOf=b will deliver {a, -b, -c}, {-b, d}" << std::endl <<
 		"         since the majority denies b";
 	return ss.str();
@@ -28,67 +46,108 @@ std::set<std::string> OpMajoritySelection::getRecognizedParameters(){
 	return list;
 }
 
-HexAnswer OpMajoritySelection::apply(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
-	if (arity != 1){
+int OpMajoritySelection::getCapabilities(const OperatorArguments& parameters){
+	return Pure | Streaming | ParallelSafe | SharesInputs;
+}
+
+void OpMajoritySelection::evaluate(bool debug, const std::vector<const HexAnswer*>& arguments, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException){
+	if (arguments.size() != 1){
 		throw IOperator::OperatorException("Error: The majorityselection operator expects exactly 1 argument.");
 	}
 
-	// check if a predicate was passed that serves for answer-set selection
-	for (OperatorArguments::iterator it = parameters.begin(); it != parameters.end(); it++){
+	// collect the predicates that serve for answer-set selection
+	std::set<std::string> predicates;
+	for (OperatorArguments::const_iterator it = parameters.begin(); it != parameters.end(); it++){
 		if (it->first == std::string("majorityOf")){
-			dlvhex::Atom* p = new dlvhex::Atom(it->second);
-			dlvhex::AtomPtr pptr(p);
-
-			// check if the majority accepts or denies p
-			int acc = 0;
-			int deny = 0;
-
-			for (int answerSetNr = 0; answerSetNr < arguments[0]->size(); answerSetNr++){
-				dlvhex::AtomSet as;
-				(*arguments[0])[answerSetNr].matchPredicate(it->second, as);
-				if (as.size() > 0){
-					// check if the atom is propositional in this source
-					if (as.begin()->getArity() > 0){
-						throw OperatorException("Predicate \"" + it->second + "\" is not propositional.");
-					}
-					// it's propositional, thus we can safely assume that the answer-set contains exactly one element
-					assert(as.size() == 1);
-					if (!as.begin()->isStronglyNegated()){
-						acc++;
-					}else{
-						deny++;
-					}
-				}else{
-					// does not occur: neither acc nor deny
-				}
-			}
-			// decision possible?
-			if (acc == deny)
-				return (*arguments[0]);		// no
-		
-			// keep only the answer-sets that follow the majority
-			HexAnswer result;
-			for (int answerSetNr = 0; answerSetNr < arguments[0]->size(); answerSetNr++){
-				dlvhex::AtomSet as;
-				(*arguments[0])[answerSetNr].matchAtom(pptr, as);
-				if (acc > deny){
-					// acc > deny
-					if (as.size() > 0 && !as.begin()->isStronglyNegated()){
-						result.push_back((*arguments[0])[answerSetNr]);
-					}else{
-						// skip
-					}
-				}else{
-					// acc < deny
-					if (as.size() > 0 && !as.begin()->isStronglyNegated()){
-						// skip
-					}else{
-						result.push_back((*arguments[0])[answerSetNr]);
-					}
-				}
+			predicates.insert(it->second);
+		}
+	}
+	if (predicates.size() == 0){
+		throw OperatorException("You need to pass a predicate name among which the majority is selected. Use the property \"majorityOf\".");
+	}
+
+	const HexAnswer& answer = *arguments[0];
+	if (answer.size() == 0) return;
+	RegistryPtr reg = answer[0]->getRegistry();
+
+	// resolve each ground atom over these predicates once (rather than per answer-set);
+	// a positive atom and its strongly negated counterpart share an entry, which is identified by the arguments over the positive predicate
+	Interpretation occurring(reg);
+	BOOST_FOREACH (InterpretationPtr intr, answer){
+		occurring.add(*intr);
+	}
+	boost::unordered_map<Tuple, int> entries;
+	boost::unordered_map<IDAddress, Voter> voters;	// address of a voting atom -> its entry
+	Interpretation mask(reg);	// all voting atoms
+	std::vector<IDAddress> positive;	// address of the positive atom of each entry (if it occurs)
+	std::vector<bool> hasPositive;
+	for (Interpretation::Storage::enumerator it = occurring.getStorage().first(); it != occurring.getStorage().end(); ++it){
+		ID ogid = reg->ogatoms.getIDByAddress(*it);
+		const OrdinaryAtom& ogatom = reg->ogatoms.getByID(ogid);
+
+		Voter voter;
+		voter.negated = false;
+		Tuple key = ogatom.tuple;
+		if (ogid.isAuxiliary()){
+			if (reg->getTypeByAuxiliaryConstantSymbol(key[0]) != 's') continue;
+			key[0] = reg->getIDByAuxiliaryConstantSymbol(key[0]);
+			voter.negated = true;
+		}
+		if (predicates.count(reg->terms.getByID(key[0]).getUnquotedString()) == 0) continue;
+
+		boost::unordered_map<Tuple, int>::iterator entryIt = entries.find(key);
+		if (entryIt == entries.end()){
+			entryIt = entries.insert(std::pair<Tuple, int>(key, positive.size())).first;
+			positive.push_back(0);
+			hasPositive.push_back(false);
+		}
+		voter.entry = entryIt->second;
+		if (!voter.negated){
+			positive[voter.entry] = *it;
+			hasPositive[voter.entry] = true;
+		}
+		voters[*it] = voter;
+		mask.setFact(*it);
+	}
+
+	// count for each entry how many answer-sets accept or deny it; only the voting atoms of each answer-set are visited
+	std::vector<int> acc(positive.size(), 0);
+	std::vector<int> deny(positive.size(), 0);
+	BOOST_FOREACH (InterpretationPtr intr, answer){
+		Interpretation::Storage votes = mask.getStorage();
+		votes &= intr->getStorage();
+		for (Interpretation::Storage::enumerator it = votes.first(); it != votes.end(); ++it){
+			const Voter& voter = voters[*it];
+			if (voter.negated){
+				deny[voter.entry]++;
+			}else{
+				acc[voter.entry]++;
 			}
-			return result;
 		}
 	}
-	throw OperatorException("You need to pass a predicate name among which the majority is selected. Use the property \"majorityOf\".");
+
+	// atoms that must (not) be contained in order to follow the majority; no decision is possible for atoms with acc == deny
+	std::vector<IDAddress> accepted;
+	std::vector<IDAddress> denied;
+	for (int entry = 0; entry < positive.size(); entry++){
+		if (acc[entry] > deny[entry]){
+			accepted.push_back(positive[entry]);
+		}else if (acc[entry] < deny[entry] && hasPositive[entry]){
+			denied.push_back(positive[entry]);
+		}
+	}
+	// keep only the answer-sets that follow the majority
+	result.reserve(answer.size());
+	BOOST_FOREACH (InterpretationPtr intr, answer){
+		bool follows = true;
+		for (int i = 0; follows && i < accepted.size(); i++){
+			if (!intr->getFact(accepted[i])) follows = false;
+		}
+		for (int i = 0; follows && i < denied.size(); i++){
+			if (intr->getFact(denied[i])) follows = false;
+		}
+		if (follows){
+			result.add(intr);
+		}
+	}
 }
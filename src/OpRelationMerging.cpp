@@ -1,74 +1,97 @@
-#include "OpRelationMerging.h"
+#include <OpRelationMerging.h>
 
-#include <dlvhex2/PrintVisitor.h>
-#include <dlvhex2/AggregateAtom.h>
-#include <dlvhex2/DLVProcess.h>
-#include <dlvhex2/ASPSolver.h>
+#include <ArbProcess.h>
+#include <DLVOutputScanner.h>
+
+#include <dlvhex2/AnswerSet.h>
+#include <dlvhex2/DLVresultParserDriver.h>
 #include <dlvhex2/Registry.h>
-#include <dlvhex2/HexParserDriver.h>
 
+#include <boost/algorithm/string.hpp>
+#include <boost/foreach.hpp>
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <stdlib.h>
 #include <sstream>
 #include <set>
 
-#include <boost/algorithm/string.hpp>
-
 using namespace dlvhex;
 using namespace dlvhex::merging;
 using namespace dlvhex::merging::plugin;
 
-std::string OpRelationMerging::getName(){
-	return "relationmerging";
+
+// -------------------- Util (local functions!) --------------------
+
+namespace{
+	// collects the answer-sets delivered by DLVResultParser
+	struct HexAnswerAdder{
+		HexAnswer& answer;
+		HexAnswerAdder(HexAnswer& a) : answer(a){}
+		void operator()(AnswerSet::Ptr as){
+			answer.push_back(as->interpretation);
+		}
+	};
+
+	// schema and data tuples (without predicate) of one source
+	struct Source{
+		std::vector<std::string> schema;
+		std::vector<Tuple> data;
+	};
+
+	// state of a merged attribute value
+	enum ValueState{
+		Unknown,	// no source provides a value
+		Agreed,		// all sources provide the same value
+		Contradicting	// sources provide different values
+	};
+
+	// merged tuple: one entry per non-key attribute of the merged schema
+	struct MergedTuple{
+		Tuple values;
+		std::vector<ValueState> states;
+	};
 }
 
+static void printTerm(RegistryPtr reg, std::ostream& o, ID term){
+	if (term.isIntegerTerm()) o << term.address;
+	else o << reg->terms.getByID(term).symbol;
+}
 
-std::string OpRelationMerging::getInfo(){
-	std::stringstream ss;
-	ss <<	"     relationmerging" << std::endl <<
-		"     ---------------" << std::endl << std::endl <<
-		"This operator is not thought to be used practically since it is buggy and only used for test purposes!" << std::endl <<
-		 "A(H1), ..., A(Hn)	... handles to n answers" << std::endl <<
-		 "			    each answer is expected to contain exactly one answer-set with data entries of kind" << std::endl <<
-		 "			    	data(a1,...,an)" << std::endl <<
-		 "			    where ai are the attribute values as well as a schema definition of kind" << std::endl <<
-		 "			    	schema(n1,...,nn)" << std::endl <<
-		 "			    where ni are the attribute names" << std::endl <<
-		 "K(schema, s)		... A list of kind" << std::endl <<
-		 "			    	s = \"a1,...,an\"" << std::endl <<
-		 "			    defines the arity and the attribute names of the merged schema" << std::endl <<
-		 "K(key, s)		... A list of kind" << std::endl <<
-		 "			    	s = \"k1,...,km\"" << std::endl <<
-		 "K(default, d)		... \"d\" is a string of kind \"a=v\" where \"a\" is some attribute and \"v\" some default value" << std::endl <<
-		 "K(rule, r)		... \"r\" is a rule of kind" << std::endl <<
-		 "			    	attribute(merged, PrimaryKey, Value) :- attribute(1, PrimaryKey, V1), ..., attribute(n, PrimaryKey, Vn)" << std::endl <<
-		 "			    in order to overwrite the built-in rule that states that attribute values are copied into the result iff" << std::endl <<
-		 "			    all sources agree upon it's value" << std::endl <<
-		 "			    that defines the key attributes in the merged schema (they must also be contained in each source)" << std::endl <<
-		 "A			... answer to the operator result";
-	return ss.str();
+static ID storeConstant(RegistryPtr reg, const std::string& symbol){
+	ID id = reg->terms.getIDByString(symbol);
+	if (id == ID_FAIL){
+		Term term(ID::MAINKIND_TERM | ID::SUBKIND_TERM_CONSTANT, symbol);
+		id = reg->storeTerm(term);
+	}
+	return id;
 }
 
-std::set<std::string> OpRelationMerging::getRecognizedParameters(){
-	std::set<std::string> list;
-	list.insert("schema");
-	list.insert("key");
-	list.insert("default");
-	list.insert("rule");
-	return list;
+// returns the ground atom with the given predicate and arguments
+static ID storeAtom(RegistryPtr reg, ID predicate, const Tuple& args){
+	OrdinaryAtom atom(ID::MAINKIND_ATOM | ID::SUBKIND_ATOM_ORDINARYG);
+	atom.tuple.push_back(predicate);
+	atom.tuple.insert(atom.tuple.end(), args.begin(), args.end());
+	ID id = reg->ogatoms.getIDByTuple(atom.tuple);
+	if (id == ID_FAIL){
+		std::stringstream text;
+		printTerm(reg, text, predicate);
+		for (int i = 0; i < args.size(); i++){
+			text << (i == 0 ? "(" : ",");
+			printTerm(reg, text, args[i]);
+		}
+		if (args.size() > 0) text << ")";
+		atom.text = text.str();
+		id = reg->storeOrdinaryGAtom(atom);
+	}
+	return id;
 }
 
-// translates sources from
-//	schema(a1,...,an), data(v1,...,vn)
-// into
-//	a1(m, v1), ..., an(m, vn)
-void rewriteSource(int source, std::vector<HexAnswer*>& arguments, std::set<std::string>& key, std::vector<std::string>& key_ordered, std::vector<std::vector<std::string> >& schema_sources, AtomSet& facts){
-
-	// find key attributes in this source
-	std::set<int> keyIndices;
-	std::vector<int> keyIndices_ordered;
-	int i = 0;
-	for (std::vector<std::string>::iterator keyIt = schema_sources[source].begin(); keyIt != schema_sources[source].end(); ++keyIt, ++i){
-		if (key.find(*keyIt) != key.end()){
-			keyIndices.insert(i);
+// finds the key attributes in the schema of a source (in the order of the merged key)
+static void findKeyIndices(const std::vector<std::string>& schema_source, const std::set<std::string>& key, const std::vector<std::string>& key_ordered, std::vector<int>& keyIndices_ordered){
+
+	for (int i = 0; i < schema_source.size(); i++){
+		if (key.find(schema_source[i]) != key.end()){
 			keyIndices_ordered.push_back(i);
 		}
 	}
@@ -76,68 +99,79 @@ void rewriteSource(int source, std::vector<HexAnswer*>& arguments, std::set<std:
 	// sanity check: key of sources must coincide with key of merged data set
 	if (keyIndices_ordered.size() != key_ordered.size()) throw IOperator::OperatorException("Number of key attributes in sources and in merged set differrs");
 	for (int j = 0; j < keyIndices_ordered.size(); j++){
-		if (schema_sources[source][keyIndices_ordered[j]].compare(key_ordered[j]) != 0){
-			throw IOperator::OperatorException(std::string("Key attribute \"") + schema_sources[source][keyIndices_ordered[j]] + std::string("\" differrs from merged key attribute \"") + key_ordered[j] + std::string("\""));
+		if (schema_source[keyIndices_ordered[j]].compare(key_ordered[j]) != 0){
+			throw IOperator::OperatorException(std::string("Key attribute \"") + schema_source[keyIndices_ordered[j]] + std::string("\" differrs from merged key attribute \"") + key_ordered[j] + std::string("\""));
 		}
 	}
+}
 
-	AtomSet currentSource;
-	(*arguments[source])[0].matchPredicate("data", currentSource);
-	// rewrite all tuples
-	for (AtomSet::const_iterator atom = currentSource.begin(); atom != currentSource.end(); ++atom){
-		// rewrite all attributes of this tuple
-		for (int att = 1; att <= schema_sources[source].size(); att++){
-			// only for non-key indices
-			if (keyIndices.find(att) == keyIndices.end()){
-				Tuple args;
-				args.push_back(Term(source + 1));
-				// add key attributes to each entry
-				for (std::vector<int>::iterator keyIt = keyIndices_ordered.begin(); keyIt != keyIndices_ordered.end(); ++keyIt){
-					args.push_back(atom->getArgument(*keyIt + 1));
+// extracts the schema and the data tuples of the sources in one pass over each answer-set
+static void extractSources(RegistryPtr reg, const std::vector<const HexAnswer*>& arguments, std::vector<Source>& sources){
+
+	ID schemaPredicate = reg->terms.getIDByString("schema");
+	ID dataPredicate = reg->terms.getIDByString("data");
+	sources.resize(arguments.size());
+	for (int source = 0; source < arguments.size(); source++){
+		if (arguments[source]->size() != 1){
+			throw IOperator::OperatorException("Each source is expected to contain exactly one answer-set");
+		}
+		InterpretationConstPtr intr = (*arguments[source])[0];
+		int schemaAtoms = 0;
+		for (Interpretation::Storage::enumerator it = intr->getStorage().first(); it != intr->getStorage().end(); ++it){
+			ID ogid = reg->ogatoms.getIDByAddress(*it);
+			if (ogid.isAuxiliary()) continue;
+			const OrdinaryAtom& ogatom = reg->ogatoms.getByID(ogid);
+			if (ogatom.tuple[0] == dataPredicate){
+				sources[source].data.push_back(Tuple(ogatom.tuple.begin() + 1, ogatom.tuple.end()));
+			}else if (ogatom.tuple[0] == schemaPredicate){
+				schemaAtoms++;
+				sources[source].schema.clear();
+				for (int i = 1; i < ogatom.tuple.size(); i++){
+					sources[source].schema.push_back(reg->terms.getByID(ogatom.tuple[i]).getUnquotedString());
 				}
-				args.push_back(atom->getArgument(att));
-				facts.insert(AtomPtr(new Atom(schema_sources[source][att - 1], args)));
 			}
 		}
-		// write individual
-		Tuple args;
-		for (std::vector<int>::iterator keyIt = keyIndices_ordered.begin(); keyIt != keyIndices_ordered.end(); ++keyIt){
-			args.push_back(atom->getArgument(*keyIt + 1));
+		// sanity check
+		if (schemaAtoms != 1){
+			throw IOperator::OperatorException("Each source is expected to contain exactly one atom upon the predicate \"schema\".");
 		}
-		facts.insert(AtomPtr(new Atom("individuals", args)));
 	}
-
 }
 
 // translates sources from
 //	schema(a1,...,an), data(v1,...,vn)
 // into
 //	a1(m, v1), ..., an(m, vn)
-void rewriteSources(std::vector<HexAnswer*>& arguments, std::set<std::string>& key, std::vector<std::string>& key_ordered, std::vector<std::vector<std::string> >& schema_sources, AtomSet& facts){
+static void rewriteSources(RegistryPtr reg, const std::vector<Source>& sources, const std::set<std::string>& key, const std::vector<std::string>& key_ordered, std::ostream& program){
 
-	// extract individual schemas for the sources
-	for (int source = 0; source < arguments.size(); source++){
-		if (arguments[source]->size() != 1){
-			throw IOperator::OperatorException("Each source is expected to contain exactly one answer-set");
-		}
-		AtomSet currentSchemaAtom;
-		(*arguments[source])[0].matchPredicate("schema", currentSchemaAtom);
-		// sanity check
-		if (currentSchemaAtom.size() != 1){
-			throw IOperator::OperatorException("Each source is expected to contain exactly one atom upon the predicate \"schema\".");
-		}else{
-			Tuple s = currentSchemaAtom.begin()->getArguments();
-			std::vector<std::string> currentSchema;
-			for (Tuple::iterator it = s.begin(); it != s.end(); it++){
-				currentSchema.push_back(it->getUnquotedString());
+	// source m: schema(a1,...,an), data(v1,...,vn) --> a1(m, v1), ..., an(m, vn)
+	for (int source = 0; source < sources.size(); source++){
+		// find key attributes in this source
+		std::vector<int> keyIndices_ordered;
+		findKeyIndices(sources[source].schema, key, key_ordered, keyIndices_ordered);
+		std::set<int> keyIndices(keyIndices_ordered.begin(), keyIndices_ordered.end());
+
+		// rewrite all tuples
+		BOOST_FOREACH (const Tuple& data, sources[source].data){
+			// tuples without a complete key cannot be merged
+			if (keyIndices_ordered.size() > 0 && keyIndices_ordered.back() >= data.size()) continue;
+			std::stringstream keyargs;
+			for (std::vector<int>::iterator keyIt = keyIndices_ordered.begin(); keyIt != keyIndices_ordered.end(); ++keyIt){
+				keyargs << (keyIt == keyIndices_ordered.begin() ? "" : ", ");
+				printTerm(reg, keyargs, data[*keyIt]);
 			}
-			schema_sources.push_back(currentSchema);
-		}
-	}
 
-	// source m: schema(a1,...,an), data(v1,...,vn) --> a1(m, v1), ..., an(m, vn)
-	for (int source = 0; source < arguments.size(); source++){
-		rewriteSource(source, arguments, key, key_ordered, schema_sources, facts);
+			// rewrite all attributes of this tuple (only for non-key indices)
+			for (int att = 0; att < sources[source].schema.size() && att < data.size(); att++){
+				if (keyIndices.find(att) == keyIndices.end()){
+					program << sources[source].schema[att] << "(" << (source + 1) << ", " << keyargs.str() << ", ";
+					printTerm(reg, program, data[att]);
+					program << ")." << std::endl;
+				}
+			}
+			// write individual
+			program << "individuals(" << keyargs.str() << ")." << std::endl;
+		}
 	}
 }
 
@@ -145,103 +179,214 @@ void rewriteSources(std::vector<HexAnswer*>& arguments, std::set<std::string>& k
 //	a1(m, v1), ..., an(m, vn)
 // into single atoms of kind
 //	data(v1,...,vn)
-void resultExtraction(Program& program, std::set<std::string>& key, std::vector<std::string>& key_ordered, std::vector<std::string>& schema_merged){
+static void resultExtraction(const std::set<std::string>& key, const std::vector<std::string>& key_ordered, const std::vector<std::string>& schema_merged, std::ostream& program){
 
-	AtomSet facts; // empty
-
-	std::stringstream assembling;
 	std::stringstream query;
 	std::stringstream keyquery;
 	int i = 1;
-	for (std::vector<std::string>::iterator keyIt = key_ordered.begin(); keyIt != key_ordered.end(); ++keyIt){
+	for (std::vector<std::string>::const_iterator keyIt = key_ordered.begin(); keyIt != key_ordered.end(); ++keyIt){
 		keyquery << (keyIt == key_ordered.begin() ? "" : ", ") << "K" << (i++);
 	}
-	assembling << "data(" << keyquery.str();
+	program << "data(" << keyquery.str();
 	i = 1;
-	for (std::vector<std::string>::iterator attIt = schema_merged.begin(); attIt != schema_merged.end(); ++attIt){
+	for (std::vector<std::string>::const_iterator attIt = schema_merged.begin(); attIt != schema_merged.end(); ++attIt){
 		// only for non-key attributes
 		if (key.find(*attIt) == key.end()){
-			assembling << ", " << "V" << i;
+			program << ", " << "V" << i;
 			query << (query.str().size() == 0 ? "" : ", ") << "fin_" << (*attIt) << "(merged, " << keyquery.str() << ", V" << (i++) << ")";
 		}
 	}
-	assembling << ") :- " << query.str() << ".";
-
-
-	// assemble subprogram
-	HexParserDriver hpd;
-	try{
-		hpd.parse(assembling, program, facts);
-	}catch(...){
-		throw IOperator::OperatorException("Error while assembling unification rules");
-	}
+	program << ") :- " << query.str() << "." << std::endl;
 }
 
 // writes rules that select all attributes that do not lead to contradictions
-void writeDefaultMappings(Program& program, int arity, std::vector<std::string>& key_ordered, std::vector<std::string>& schema_merged, std::map<std::string, std::string>& defvalues){
+static void writeDefaultMappings(int arity, const std::vector<std::string>& key_ordered, const std::vector<std::string>& schema_merged, const std::map<std::string, std::string>& defvalues, std::ostream& program){
 
 	std::stringstream keyquery;
 	int i = 1;
-	for (std::vector<std::string>::iterator keyIt = key_ordered.begin(); keyIt != key_ordered.end(); ++keyIt){
+	for (std::vector<std::string>::const_iterator keyIt = key_ordered.begin(); keyIt != key_ordered.end(); ++keyIt){
 		keyquery << (keyIt == key_ordered.begin() ? "" : ", ") << "K" << (i++);
 	}
 
-	std::stringstream defmappings;
-	for (std::vector<std::string>::iterator att = schema_merged.begin(); att != schema_merged.end(); ++att){
+	for (std::vector<std::string>::const_iterator att = schema_merged.begin(); att != schema_merged.end(); ++att){
 		// if we have no contradicting values for some attribute, we overtake it as it is
-		defmappings << "contradicting_" << (*att) << "(" << keyquery.str() << ") :- ";
-		defmappings << (*att) << "(I1, " << keyquery.str() << ", V1)";
-		defmappings << ", " << (*att) << "(I2, " << keyquery.str() << ", V2)";
-		defmappings << ", V1 != V2";
-		defmappings << ".";
-		defmappings << "def_" << (*att) << "(merged, " << keyquery.str() << ", V) :- " << (*att) << "(I, " << keyquery.str() << ", V), not contradicting_" << (*att) << "(" << keyquery.str() << ").";
+		program << "contradicting_" << (*att) << "(" << keyquery.str() << ") :- ";
+		program << (*att) << "(I1, " << keyquery.str() << ", V1)";
+		program << ", " << (*att) << "(I2, " << keyquery.str() << ", V2)";
+		program << ", V1 != V2";
+		program << "." << std::endl;
+		program << "def_" << (*att) << "(merged, " << keyquery.str() << ", V) :- " << (*att) << "(I, " << keyquery.str() << ", V), not contradicting_" << (*att) << "(" << keyquery.str() << ")." << std::endl;
 		// check if a user-defined rule for this attribute is defined
-		defmappings << "userdefined_" << (*att) << "(merged, " << keyquery.str() << ") :- " << (*att) << "(merged, " << keyquery.str() << ", V).";
+		program << "userdefined_" << (*att) << "(merged, " << keyquery.str() << ") :- " << (*att) << "(merged, " << keyquery.str() << ", V)." << std::endl;
 		// if this is the case, compute the final value using this rule
-		defmappings << "fin_" << (*att) << "(merged, " << keyquery.str() << ", V) :- " << (*att) << "(merged, " << keyquery.str() << ", V).";
+		program << "fin_" << (*att) << "(merged, " << keyquery.str() << ", V) :- " << (*att) << "(merged, " << keyquery.str() << ", V)." << std::endl;
 		// otherwise: take the default-value (exploiting nonmonotonic reasoning)
-		defmappings << "fin_" << (*att) << "(merged, " << keyquery.str() << ", DV) :- def_" << (*att) << "(merged, " << keyquery.str() << ", DV), not userdefined_" << (*att) << "(merged, " << keyquery.str() << ").";
+		program << "fin_" << (*att) << "(merged, " << keyquery.str() << ", DV) :- def_" << (*att) << "(merged, " << keyquery.str() << ", DV), not userdefined_" << (*att) << "(merged, " << keyquery.str() << ")." << std::endl;
 
 		// write existence predicates
 		for (int i = 0; i < arity; i++){
-			defmappings << "exists_" << (*att) << "(" << keyquery.str() << ") :- " << (*att) << "(" << (i + 1) << ", " << keyquery.str() << ", V).";
+			program << "exists_" << (*att) << "(" << keyquery.str() << ") :- " << (*att) << "(" << (i + 1) << ", " << keyquery.str() << ", V)." << std::endl;
 		}
 	}
 
-	HexParserDriver hpd;
-	AtomSet facts;	// empty
-	try{
-		hpd.parse(defmappings, program, facts);
-	}catch(...){
-		throw IOperator::OperatorException("Error while parsing default mapping rules");
+	// write default values (if present)
+	for (std::map<std::string, std::string>::const_iterator att = defvalues.begin(); att != defvalues.end(); ++att){
+		program << att->first << "(merged, " << keyquery.str() << ", " << att->second << ") :- not exists_" << att->first << "(" << keyquery.str() << "), individuals(" << keyquery.str() << ")." << std::endl;
 	}
+}
 
+// parses a default value as it would be parsed within the merging program
+static ID defaultTerm(RegistryPtr reg, const std::string& value){
+	if (value.size() > 0 && value.find_first_not_of("0123456789") == std::string::npos) return ID::termFromInteger(atoi(value.c_str()));
+	return storeConstant(reg, value);
+}
 
-	// write default values (if present)
-	std::stringstream defvaluesrules;
-	for (std::map<std::string, std::string>::iterator att = defvalues.begin(); att != defvalues.end(); ++att){
-		defvaluesrules << att->first << "(merged, " << keyquery.str() << ", " << att->second << ") :- not exists_" << att->first << "(" << keyquery.str() << "), individuals(" << keyquery.str() << ").";
+// computes the same result as the merging program with the built-in rules (see writeDefaultMappings) without ASP solver:
+// the tuples of all sources are joined in a hash table on the key; an attribute value is overtaken iff all sources agree upon it,
+// the default value is used iff no source provides one, and tuples with contradicting or missing values are dropped
+static void mergeNative(RegistryPtr reg, const std::vector<Source>& sources, const std::set<std::string>& key, const std::vector<std::string>& key_ordered, const std::vector<std::string>& schema_merged, const std::map<std::string, std::string>& defvalues, InterpretationPtr result){
+
+	// non-key attributes of the merged schema (in the order of the result tuples)
+	std::vector<std::string> attributes;
+	for (std::vector<std::string>::const_iterator attIt = schema_merged.begin(); attIt != schema_merged.end(); ++attIt){
+		if (key.find(*attIt) == key.end()) attributes.push_back(*attIt);
 	}
 
-	try{
-		hpd.parse(defvaluesrules, program, facts);
-	}catch(...){
-		throw IOperator::OperatorException("Error while writing default value rules");
+	// the values are compared by their IDs, thus the key tuples can be hashed directly
+	boost::unordered_map<Tuple, MergedTuple> merged;
+	for (int source = 0; source < sources.size(); source++){
+		std::vector<int> keyIndices_ordered;
+		findKeyIndices(sources[source].schema, key, key_ordered, keyIndices_ordered);
+
+		// column of each merged attribute in this source (or -1 if the source does not provide it)
+		const std::vector<std::string>& schema = sources[source].schema;
+		std::vector<int> columns;
+		for (std::vector<std::string>::const_iterator attIt = attributes.begin(); attIt != attributes.end(); ++attIt){
+			std::vector<std::string>::const_iterator col = std::find(schema.begin(), schema.end(), *attIt);
+			columns.push_back(col == schema.end() ? -1 : col - schema.begin());
+		}
+
+		if (merged.size() == 0) merged.rehash(sources[source].data.size());
+		BOOST_FOREACH (const Tuple& data, sources[source].data){
+			// tuples without a complete key cannot be merged
+			if (keyIndices_ordered.size() > 0 && keyIndices_ordered.back() >= data.size()) continue;
+			Tuple k;
+			for (std::vector<int>::iterator keyIt = keyIndices_ordered.begin(); keyIt != keyIndices_ordered.end(); ++keyIt){
+				k.push_back(data[*keyIt]);
+			}
+			MergedTuple& mt = merged[k];
+			if (mt.states.size() == 0){
+				mt.values.resize(attributes.size(), ID_FAIL);
+				mt.states.resize(attributes.size(), Unknown);
+			}
+
+			// all sources must agree upon the value
+			for (int att = 0; att < attributes.size(); att++){
+				if (columns[att] == -1 || columns[att] >= data.size()) continue;
+				ID value = data[columns[att]];
+				if (mt.states[att] == Unknown){
+					mt.values[att] = value;
+					mt.states[att] = Agreed;
+				}else if (mt.states[att] == Agreed && mt.values[att] != value){
+					mt.states[att] = Contradicting;
+				}
+			}
+		}
+	}
+
+	// emit the merged tuples with complete values
+	ID dataPredicate = storeConstant(reg, "data");
+	for (boost::unordered_map<Tuple, MergedTuple>::iterator it = merged.begin(); it != merged.end(); ++it){
+		Tuple args = it->first;
+		bool complete = true;
+		for (int att = 0; complete && att < attributes.size(); att++){
+			std::map<std::string, std::string>::const_iterator def = defvalues.find(attributes[att]);
+			if (it->second.states[att] == Agreed){
+				args.push_back(it->second.values[att]);
+			}else if (it->second.states[att] == Unknown && def != defvalues.end()){
+				args.push_back(defaultTerm(reg, def->second));
+			}else{
+				complete = false;
+			}
+		}
+		if (complete) result->setFact(storeAtom(reg, dataPredicate, args).address);
+	}
+}
+
+// solves the merging program by dlv and keeps only the atoms over "data"
+static void solveDLV(RegistryPtr reg, const std::string& program, HexAnswer& result){
+	std::stringstream input(program);
+	std::stringstream answer;
+	DLVOutputScanner scanner(answer);
+	std::ostream dlvoutput(&scanner);
+	ArbProcess dlv("dlv -silent -filter=data --");
+	int errcode = dlv.filter(input, dlvoutput);
+	scanner.finish();
+	if (errcode != 0){
+		throw IOperator::OperatorException("Error while executing merging subprogram");
 	}
+
+	DLVResultParser parser(reg);
+	parser.parse(answer, HexAnswerAdder(result));
+}
+
+
+// ---------- OpRelationMerging ----------
+
+std::string OpRelationMerging::getName(){
+	return "relationmerging";
+}
+
+std::string OpRelationMerging::getInfo(){
+	std::stringstream ss;
+	ss <<	"     relationmerging" << std::endl <<
+		"     ---------------" << std::endl << std::endl <<
+		"This operator is not thought to be used practically since it is buggy and only used for test purposes!" << std::endl <<
+		 "A(H1), ..., A(Hn)	... handles to n answers" << std::endl <<
+		 "			    each answer is expected to contain exactly one answer-set with data entries of kind" << std::endl <<
+		 "			    	data(a1,...,an)" << std::endl <<
+		 "			    where ai are the attribute values as well as a schema definition of kind" << std::endl <<
+		 "			    	schema(n1,...,nn)" << std::endl <<
+		 "			    where ni are the attribute names" << std::endl <<
+		 "K(schema, s)		... A list of kind" << std::endl <<
+		 "			    	s = \"a1,...,an\"" << std::endl <<
+		 "			    defines the arity and the attribute names of the merged schema" << std::endl <<
+		 "K(key, s)		... A list of kind" << std::endl <<
+		 "			    	s = \"k1,...,km\"" << std::endl <<
+		 "K(default, d)		... \"d\" is a string of kind \"a=v\" where \"a\" is some attribute and \"v\" some default value" << std::endl <<
+		 "K(rule, r)		... \"r\" is a rule of kind" << std::endl <<
+		 "			    	attribute(merged, PrimaryKey, Value) :- attribute(1, PrimaryKey, V1), ..., attribute(n, PrimaryKey, Vn)" << std::endl <<
+		 "			    in order to overwrite the built-in rule that states that attribute values are copied into the result iff" << std::endl <<
+		 "			    all sources agree upon it's value" << std::endl <<
+		 "			    that defines the key attributes in the merged schema (they must also be contained in each source)" << std::endl <<
+		 "			    Without such rules, the sources are joined natively (by a hash table on the key) instead of solving a merging program" << std::endl <<
+		 "A			... answer to the operator result";
+	return ss.str();
 }
 
+std::set<std::string> OpRelationMerging::getRecognizedParameters(){
+	std::set<std::string> list;
+	list.insert("schema");
+	list.insert("key");
+	list.insert("default");
+	list.insert("rule");
+	return list;
+}
+
+int OpRelationMerging::getCapabilities(const OperatorArguments& parameters){
+	return Pure;
+}
 
-HexAnswer OpRelationMerging::apply(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
+void OpRelationMerging::evaluate(bool debug, const std::vector<const HexAnswer*>& arguments, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException){
 
 	std::set<std::string> key;
 	std::vector<std::string> key_ordered;
 	std::vector<std::string> schema_merged;
-	std::vector<std::vector<std::string> > schema_sources;
 	std::map<std::string, std::string> defvalues;
 
 	// extract merged schema
 	std::stringstream mergingrules;
-	for (OperatorArguments::iterator arg = parameters.begin(); arg != parameters.end(); ++arg){
+	for (OperatorArguments::const_iterator arg = parameters.begin(); arg != parameters.end(); ++arg){
 		if (arg->first == std::string("schema")){
 			boost::split(schema_merged, arg->second, boost::is_any_of(","));
 		}
@@ -250,7 +395,7 @@ HexAnswer OpRelationMerging::apply(int arity, std::vector<HexAnswer*>& arguments
 			boost::split(key_ordered, arg->second, boost::is_any_of(","));
 		}
 		else if (arg->first == std::string("rule")){
-			mergingrules << arg->second;
+			mergingrules << arg->second << std::endl;
 		}
 
 		else if (arg->first == std::string("default")){
@@ -261,37 +406,37 @@ HexAnswer OpRelationMerging::apply(int arity, std::vector<HexAnswer*>& arguments
 		}
 	}
 
-	// rewrite sources
-	Program program;
-	AtomSet facts;
-	rewriteSources(arguments, key, key_ordered, schema_sources, facts);
-
-	// map result onto atoms over predicate "data"
-	resultExtraction(program, key, key_ordered, schema_merged);
-	HexParserDriver hpd;
-	try{
-		hpd.parse(mergingrules, program, facts);
-	}catch(...){
-		throw IOperator::OperatorException("Error while assembling merging rules");
+	if (arguments.size() == 0 || arguments[0]->size() == 0) return;
+	RegistryPtr reg = (*arguments[0])[0]->getRegistry();
+	std::vector<Source> sources;
+	extractSources(reg, arguments, sources);
+
+	// add schema of final result
+	Tuple t;
+	for (std::vector<std::string>::iterator it = schema_merged.begin(); it != schema_merged.end(); ++it) t.push_back(storeConstant(reg, *it));
+	ID schemaAtom = storeAtom(reg, storeConstant(reg, "schema"), t);
+
+	// without user-defined rules, the merged relation is computed natively
+	if (mergingrules.str().size() == 0){
+		InterpretationPtr merged(new Interpretation(reg));
+		mergeNative(reg, sources, key, key_ordered, schema_merged, defvalues, merged);
+		merged->setFact(schemaAtom.address);
+		result.add(merged);
+		return;
 	}
 
-	// write default mappings
-	writeDefaultMappings(program, arity, key_ordered, schema_merged, defvalues);
+	// rewrite sources, map result onto atoms over predicate "data" and add the merging rules and the default mappings
+	std::stringstream program;
+	rewriteSources(reg, sources, key, key_ordered, program);
+	resultExtraction(key, key_ordered, schema_merged, program);
+	program << mergingrules.str();
+	writeDefaultMappings(arguments.size(), key_ordered, schema_merged, defvalues, program);
 
 	// execute subprogram
-	try{
-		HexAnswer result;
-		ASPSolverManager& solver = ASPSolverManager::Instance();
-    typedef ASPSolverManager::SoftwareConfiguration<ASPSolver::DLVSoftware> DLVConfiguration;
-    DLVConfiguration dlv;
-		solver.solve(dlv, program, facts, result);
-
-		// add schema of final result
-		Tuple t;
-		for (std::vector<std::string>::iterator it = schema_merged.begin(); it != schema_merged.end(); ++it) t.push_back(Term(*it));
-		result.begin()->insert(AtomPtr(new Atom("schema", t)));
-		return result;
-	}catch(...){
-		throw OperatorException("Error while executing merging subprogram");
+	HexAnswer answer;
+	solveDLV(reg, program.str(), answer);
+	BOOST_FOREACH (InterpretationPtr intr, answer){
+		intr->setFact(schemaAtom.address);
 	}
+	result.addAll(answer);
 }
@@ -12,33 +12,29 @@ std::string OpSetminus::getInfo(){
 	std::stringstream ss;
 	ss <<	"     setminus" << std::endl <<
 		"     --------" << std::endl << std::endl <<
-		"Expects exactly two inputs" << std::endl <<
-		"Computes the pairwise difference of answer-sets of the first argument minus the second one.";
+		"Expects at least two inputs" << std::endl <<
+		"Computes the differences of answer-sets of the first argument minus one answer-set of each further argument" << std::endl <<
+		"(i.e. A1 \\ A2 \\ ... \\ An for all combinations)." << std::endl << std::endl <<
+		"Parameters:" << std::endl <<
+		"     memoize: \"true\" (default) stores combined answer-sets when they are accessed for the first time, \"false\" recomputes them";
 	return ss.str();
 }
 
 std::set<std::string> OpSetminus::getRecognizedParameters(){
 	std::set<std::string> list;
+	list.insert("memoize");
 	return list;
 }
 
-
-HexAnswer OpSetminus::apply(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
-	if (arity != 2){
-		throw IOperator::OperatorException("Error: The union operator expects exactly 2 arguments.");
+LazyAnswerPtr OpSetminus::applyLazy(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
+	if (arity < 2){
+		throw IOperator::OperatorException("Error: The setminus operator expects at least 2 arguments.");
 	}
 
-	HexAnswer result;
-	for (int answerSetNr1 = 0; answerSetNr1 < arguments[0]->size(); answerSetNr1++){
-		for (int answerSetNr2 = 0; answerSetNr2 < arguments[1]->size(); answerSetNr2++){
-			// Take the first answer-set
-			InterpretationPtr set = InterpretationPtr(new Interpretation(*(*arguments[0])[answerSetNr1]));
-
-			// Subtract the second one
-			set->getStorage() -= ((*arguments[1])[answerSetNr2])->getStorage();
+	// the combinations are only computed on access
+	return LazyAnswer::fromParameters(LazyAnswer::Setminus, arguments, parameters);
+}
 
-			result.push_back(set);
-		}
-	}
-	return result;
+HexAnswer OpSetminus::apply(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
+	return applyLazy(arity, arguments, parameters)->materialize();
 }
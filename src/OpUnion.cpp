@@ -13,32 +13,28 @@ std::string OpUnion::getInfo(){
 	std::stringstream ss;
 	ss <<	"     union" << std::endl <<
 		"     -----" << std::endl << std::endl <<
-		"Expects exactly two inputs" << std::endl <<
-		"Computes the pairwise union of answer-sets of its arguments.";
+		"Expects at least two inputs" << std::endl <<
+		"Computes the union of one answer-set of each argument for all combinations." << std::endl << std::endl <<
+		"Parameters:" << std::endl <<
+		"     memoize: \"true\" (default) stores combined answer-sets when they are accessed for the first time, \"false\" recomputes them";
 	return ss.str();
 }
 
 std::set<std::string> OpUnion::getRecognizedParameters(){
 	std::set<std::string> list;
+	list.insert("memoize");
 	return list;
 }
 
-HexAnswer OpUnion::apply(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
-	if (arity != 2){
-		throw IOperator::OperatorException("Error: The union operator expects exactly 2 arguments.");
+LazyAnswerPtr OpUnion::applyLazy(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
+	if (arity < 2){
+		throw IOperator::OperatorException("Error: The union operator expects at least 2 arguments.");
 	}
 
-	HexAnswer result;
-	for (int answerSetNr1 = 0; answerSetNr1 < arguments[0]->size(); answerSetNr1++){
-		for (int answerSetNr2 = 0; answerSetNr2 < arguments[1]->size(); answerSetNr2++){
-			// Take the first answer-set
-			InterpretationPtr set = InterpretationPtr(new Interpretation(*(*arguments[0])[answerSetNr1]));
-
-			// Add the second one
-			set->getStorage() |= ((*arguments[1])[answerSetNr2])->getStorage();
+	// the combinations are only computed on access
+	return LazyAnswer::fromParameters(LazyAnswer::Union, arguments, parameters);
+}
 
-			result.push_back(set);
-		}
-	}
-	return result;
+HexAnswer OpUnion::apply(int arity, std::vector<HexAnswer*>& arguments, OperatorArguments& parameters) throw (OperatorException){
+	return applyLazy(arity, arguments, parameters)->materialize();
 }
@@ -0,0 +1,34 @@
+#include <OperatorAdapter.h>
+
+using namespace dlvhex::merging::plugin;
+
+OperatorAdapter::OperatorAdapter(IOperator* o) : op(o){
+}
+
+IOperatorV2* OperatorAdapter::get(IOperator* op, OperatorAdapter& adapter){
+	IOperatorV2* v2 = dynamic_cast<IOperatorV2*>(op);
+	return v2 ? v2 : &adapter;
+}
+
+std::string OperatorAdapter::getName(){
+	return op->getName();
+}
+
+std::string OperatorAdapter::getInfo(){
+	return op->getInfo();
+}
+
+std::set<std::string> OperatorAdapter::getRecognizedParameters(){
+	return op->getRecognizedParameters();
+}
+
+void OperatorAdapter::evaluate(bool debug, const std::vector<const HexAnswer*>& answers, const OperatorArguments& parameters, AnswerSink& result) throw (OperatorException){
+	// the first generation interface takes non-const arguments, but operators are not supposed to modify them
+	std::vector<HexAnswer*> args;
+	for (std::vector<const HexAnswer*>::const_iterator it = answers.begin(); it != answers.end(); ++it){
+		args.push_back(const_cast<HexAnswer*>(*it));
+	}
+	OperatorArguments params(parameters);
+	HexAnswer answer = op->apply(debug, (int)args.size(), args, params);
+	result.addAll(answer);
+}
@@ -1,11 +1,14 @@
 #include <Operators.h>
 #include <IOperator.h>
+#include <CodeGenerator.h>
 
 #include <stdlib.h>
 #include <ltdl.h>
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <dirent.h>
 #include <pwd.h>
+#include <unistd.h>
 
 #include <fstream>
 #include <string>
@@ -30,15 +33,14 @@ void OperatorAtom::registerBuiltInOperators(){
 	// built-in operators
 	operators[_union.getName()] = &_union;
 	operators[_setminus.getName()] = &_setminus;
-/*
+	operators[_intersection.getName()] = &_intersection;
+	operators[_majorityselection.getName()] = &_majorityselection;
 	operators[_dalal.getName()] = &_dalal;
 	operators[_dbo.getName()] = &_dbo;
-	operators[_majorityselection.getName()] = &_majorityselection;
 	operators[_relationmerging.getName()] = &_relationmerging;
-*/
 }
 
-OperatorAtom::OperatorAtom(HexAnswerCache &rsCache) : PluginAtom("operator", 0), resultsetCache(rsCache)
+OperatorAtom::OperatorAtom(HexAnswerCache &rsCache) : PluginAtom("operator", 0), resultsetCache(rsCache), manifestChanged(false)
 {
 	addInputConstant();	// operator name
 	addInputPredicate();	// predicate containing all the answer indices which shall be passed to the operator
@@ -97,6 +99,7 @@ OperatorAtom::retrieve(const Query& query, Answer& answer) throw (PluginError)
 	// Extract the operator's key-value arguments
 	ID kvPred = params[2];
 	OperatorArguments parameters;
+	std::string label;
 
 	// go through all input atoms over this predicate
 	for(Interpretation::Storage::enumerator it =
@@ -109,17 +112,20 @@ OperatorAtom::retrieve(const Query& query, Answer& answer) throw (PluginError)
 		if (ogatom.tuple[0] == kvPred){
 			std::string key = reg->terms.getByID(ogatom.tuple[1]).getUnquotedString();
 			std::string value = reg->terms.getByID(ogatom.tuple[2]).getUnquotedString();
-			parameters.push_back(KeyValuePair(key, value));
+			// the result identifier which the merging plan compiler adds is not an operator parameter
+			if (key == dlvhex::merging::tools::mpcompiler::PlanNode::labelParameter()){
+				label = value;
+			}else{
+				parameters.push_back(KeyValuePair(key, value));
+			}
 		}
 	}
 
 	// If the operator name matches one of the loaded operators, it is executed
 	try{
-		// Search for the oprator
-		IOperator* op = getOperator(opname); // throws an OperatorException of not found
-
 		// Assemble unique identifier for this operator application (consisting of operator name and argument indices, see below)
-		HexCall hc(HexCall::OperatorCall, op, debug, silent, argumentsIndices, parameters);
+		HexCall hc = makeCall(opname, argumentsIndices, parameters); // throws an OperatorException of not found
+		hc.setLabel(label);
 
 		// request entry from cache (this will automatically add it if it's not contained yet)
 		Tuple out;
@@ -134,11 +140,138 @@ OperatorAtom::retrieve(const Query& query, Answer& answer) throw (PluginError)
 	}
 }
 
+HexCall OperatorAtom::makeCall(std::string opname, std::vector<int> arguments, OperatorArguments parameters){
+	// Search for the oprator
+	IOperator* op = getOperator(opname);
+
+	// results of external operators are only reused by the persistent cache as long as their library is unchanged
+	std::map<std::string, std::string>::iterator version = versions.find(opname);
+	return HexCall(HexCall::OperatorCall, op, debug, silent, arguments, parameters, version != versions.end() ? version->second : std::string(PersistentCache::BUILTIN_VERSION));
+}
+
 void OperatorAtom::setMode(bool silentMode, bool debugMode){
 	this->silent = silentMode;
 	this->debug = debugMode;
 }
 
+void OperatorAtom::setManifest(std::string file){
+	manifestFile = file;
+	manifest.clear();
+	manifestChanged = false;
+	if (manifestFile.length() == 0) return;
+
+	// one line per library: path, modification time, size and the names of its operators (separated by tabs)
+	std::ifstream in(manifestFile.c_str());
+	std::string line;
+	while (std::getline(in, line)){
+		std::vector<std::string> fields;
+		std::string::size_type start = 0, end;
+		while ((end = line.find('\t', start)) != std::string::npos){
+			fields.push_back(line.substr(start, end - start));
+			start = end + 1;
+		}
+		fields.push_back(line.substr(start));
+		if (fields.size() < 3) continue;
+
+		ManifestEntry entry;
+		entry.mtime = (time_t)atol(fields[1].c_str());
+		entry.size = (off_t)atol(fields[2].c_str());
+		for (int i = 3; i < fields.size(); i++){
+			if (fields[i].length() > 0) entry.operators.push_back(fields[i]);
+		}
+		manifest[fields[0]] = entry;
+	}
+}
+
+void OperatorAtom::saveManifest(){
+	if (manifestFile.length() == 0 || !manifestChanged) return;
+
+	// replace the file atomically since other dlvhex instances may read it concurrently
+	std::stringstream tmp;
+	tmp << manifestFile << ".tmp" << getpid();
+	std::ofstream out(tmp.str().c_str(), std::ios::out | std::ios::trunc);
+	if (!out.is_open()) return;
+	for (std::map<std::string, ManifestEntry>::iterator it = manifest.begin(); it != manifest.end(); ++it){
+		out << it->first << "\t" << (long)it->second.mtime << "\t" << (long)it->second.size;
+		for (std::vector<std::string>::iterator op = it->second.operators.begin(); op != it->second.operators.end(); ++op){
+			out << "\t" << *op;
+		}
+		out << std::endl;
+	}
+	out.close();
+	if (out.fail() || rename(tmp.str().c_str(), manifestFile.c_str()) != 0){
+		unlink(tmp.str().c_str());
+	}else{
+		manifestChanged = false;
+	}
+}
+
+void OperatorAtom::checkUnique(std::string opname, std::string lib){
+	std::map<std::string, std::string>::iterator def = deferred.find(opname);
+	if (operators.find(opname) != operators.end() || (def != deferred.end() && def->second != lib)){
+		// Name is not unique
+		throw PluginError((std::string("Operator name \"") + opname + std::string("\" in library \"") + lib + std::string("\" is not unique. A duplicate was find in library \"") + (def != deferred.end() ? def->second : lib) + std::string("\".")).c_str());
+	}
+}
+
+bool OperatorAtom::loadLibrary(std::string lib, std::vector<std::string>& names){
+
+	// Open the specified library
+	lt_dlhandle dlHandle = lt_dlopenext(lib.c_str());							// Absolute path
+
+	// Check if the operator library was found
+	if (dlHandle == 0){
+		if (!silent && debug){
+			std::cerr << std::string("mergingplugin: Operator library or directory \"") << lib << std::string("\" was specified but not found") << std::endl;
+		}
+		return false;
+	}
+
+	// check if the library contains an operator import function
+	t_operatorImportFunction operatorImportFunction = (t_operatorImportFunction) lt_dlsym(dlHandle, "OPERATORIMPORTFUNCTION");
+	if (operatorImportFunction == 0){
+		// The library does not contain any operators
+		if (!silent && debug){
+			std::cout << std::string("mergingplugin: Library \"") + lib + std::string("\" was found but does not contain operators since the operator import function (signature: \"std::vector<dlvhex::merging::IOperator*> OPERATORIMPORTFUNCTION()\") is not present.") << std::endl;
+		}
+		return true;
+	}
+
+	// yes: load the operators; since libraries in the manifest are opened during the evaluation, the message must not go to the answer-sets
+	if (!silent){
+		std::cerr << "mergingplugin: Loading operators from library \"" << lib << "\"" << std::endl;
+	}
+
+	// call the operator import function to retrieve the operators in this library
+	std::vector<IOperator*> externalOperators = operatorImportFunction();
+
+	// the version of the operators is the library they are loaded from and its modification time
+	std::stringstream version;
+	struct stat st;
+	version << lib;
+	if (stat(lib.c_str(), &st) == 0) version << "@" << (long)st.st_mtime;
+
+	// finally add the operators to the operator list
+	int opcount = 0;
+	for (std::vector<IOperator*>::iterator it = externalOperators.begin(); it != externalOperators.end(); it++){
+		// Check if the operator name is unique
+		checkUnique((*it)->getName(), lib);
+		if (!silent && debug){
+			std::cout << "mergingplugin:    Found operator \"" << (*it)->getName() << "\"" << std::endl;
+		}
+		operators[(*it)->getName()] = *it;
+		versions[(*it)->getName()] = version.str();
+		deferred.erase((*it)->getName());
+		names.push_back((*it)->getName());
+		opcount++;
+	}
+
+	if (!silent && debug){
+		std::cout << "mergingplugin: " << opcount << " operators loaded from library \"" << lib << "\"" << std::endl;
+	}
+	return true;
+}
+
 void OperatorAtom::addOperators(std::string lib){
 
 	// Check if lib specifies a directory or a file
@@ -166,57 +299,56 @@ void OperatorAtom::addOperators(std::string lib){
 	}else{
 		// File
 
-		// Open the specified library
-		lt_dlhandle dlHandle = lt_dlopenext(lib.c_str());							// Absolute path
-
-		// Check if the operator library was found
-		if (dlHandle == 0){
-			if (!silent && debug){
-				std::cerr << std::string("mergingplugin: Operator library or directory \"") << lib << std::string("\" was specified but not found") << std::endl;
-			}
-		}else{
-			// check if the library contains an operator import function
-			t_operatorImportFunction operatorImportFunction = (t_operatorImportFunction) lt_dlsym(dlHandle, "OPERATORIMPORTFUNCTION");
-			if (operatorImportFunction == 0){
-				// The library does not contain any operators
-				if (!silent && debug){
-					std::cout << std::string("mergingplugin: Library \"") + lib + std::string("\" was found but does not contain operators since the operator import function (signature: \"std::vector<dlvhex::merging::IOperator*> OPERATORIMPORTFUNCTION()\") is not present.") << std::endl;
-				}
-			}else{
-				// yes: load the operators
-				if (!silent){
-					std::cout << "mergingplugin: Loading operators form library \"" << lib << "\"" << std::endl;
-				}
-
-				// call the operator import function to retrieve the operators in this library
-				std::vector<IOperator*> externalOperators = operatorImportFunction();
-
-				// finally add the operators to the operator list
-				int opcount = 0;
-				for (std::vector<IOperator*>::iterator it = externalOperators.begin(); it != externalOperators.end(); it++){
-					// Check if the operator name is unique
-					if (operators.find((*it)->getName()) != operators.end()){
-						// Name is not unique
-						throw PluginError((std::string("Operator name \"") + (*it)->getName() + std::string("\" in library \"") + lib + std::string("\" is not unique. A duplicate was find in library \"") + lib + std::string("\".")).c_str());
-					}else{
-						if (!silent && debug){
-							std::cout << "mergingplugin:    Found operator \"" << (*it)->getName() << "\"" << std::endl;
-						}
-						operators[(*it)->getName()] = *it;
-						opcount++;
+		// Libraries listed in the manifest are only opened when one of their operators is requested
+		struct stat st;
+		char* resolved = realpath(lib.c_str(), NULL);
+		std::string path = resolved ? std::string(resolved) : std::string();
+		free(resolved);
+		bool known = manifestFile.length() > 0 && path.length() > 0 && stat(path.c_str(), &st) == 0;
+
+		if (known){
+			std::map<std::string, ManifestEntry>::iterator entry = manifest.find(path);
+			if (entry != manifest.end() && entry->second.mtime == st.st_mtime && entry->second.size == st.st_size){
+				for (std::vector<std::string>::iterator it = entry->second.operators.begin(); it != entry->second.operators.end(); ++it){
+					checkUnique(*it, path);
+					if (!silent && debug){
+						std::cout << "mergingplugin:    Found operator \"" << *it << "\" in library \"" << path << "\" (loaded on first use)" << std::endl;
 					}
+					deferred[*it] = path;
 				}
-
-				if (!silent && debug){
-					std::cout << "mergingplugin: " << opcount << " operators loaded from library \"" << lib << "\"" << std::endl;
-				}
+				return;
 			}
 		}
+
+		// Unknown or modified library: load it now and remember its operators
+		std::vector<std::string> names;
+		if (loadLibrary(known ? path : lib, names) && known){
+			ManifestEntry entry;
+			entry.mtime = st.st_mtime;
+			entry.size = st.st_size;
+			entry.operators = names;
+			manifest[path] = entry;
+			manifestChanged = true;
+		}
 	}
 }
 
 IOperator* OperatorAtom::getOperator(std::string opname){
 
+	// Open the library of the operator if this was deferred
+	std::map<std::string, std::string>::iterator def = deferred.find(opname);
+	if (def != deferred.end()){
+		std::string lib = def->second;
+		std::vector<std::string> names;
+		loadLibrary(lib, names);
+
+		// the library does not contain the operators listed in the manifest anymore
+		for (std::map<std::string, std::string>::iterator it = deferred.begin(); it != deferred.end(); ){
+			if (it->second == lib) deferred.erase(it++);
+			else ++it;
+		}
+	}
+
 	// Search for the oprator
 	std::map<std::string, IOperator*>::const_iterator itOp = operators.find(opname);
 	if (itOp != operators.end()){
@@ -0,0 +1,192 @@
+#include <PersistentCache.h>
+
+#include <AnswerFormat.h>
+#include <BinaryAnswer.h>
+#include <dlvhex2/Interpretation.h>
+#include <dlvhex2/PluginInterface.h>
+
+#include <boost/unordered_map.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <errno.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+// FNV-1a (64 bit) with a custom offset basis
+static uint64_t fnv1a(const std::string& data, uint64_t basis){
+	uint64_t h = basis;
+	for (std::string::const_iterator it = data.begin(); it != data.end(); ++it){
+		h ^= (unsigned char)*it;
+		h *= 1099511628211ULL;
+	}
+	return h;
+}
+
+static bool readFile(const std::string& filename, std::string& content){
+	std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+	if (!file.is_open()) return false;
+	std::stringstream ss;
+	ss << file.rdbuf();
+	content = ss.str();
+	return !file.bad();
+}
+
+// separates the parts of a key such that different splits of the same characters lead to different keys
+static void appendField(std::string& key, const std::string& field){
+	std::stringstream ss;
+	ss << field.length() << ":" << field << ";";
+	key += ss.str();
+}
+
+
+// ---------- PersistentCache ----------
+
+// increase whenever a built-in operator changes its results
+const char* const PersistentCache::BUILTIN_VERSION = "builtin/1";
+
+boost::unordered_map<std::string, PersistentCache::FileFingerprint> PersistentCache::files;
+
+PersistentCache::PersistentCache(){
+}
+
+void PersistentCache::setDirectory(std::string dir){
+	if (dir.length() > 0 && mkdir(dir.c_str(), 0777) != 0 && errno != EEXIST){
+		throw PluginError("Could not create operator cache directory \"" + dir + "\"");
+	}
+	directory = dir;
+}
+
+bool PersistentCache::enabled() const{
+	return directory.length() > 0;
+}
+
+std::string PersistentCache::path(const std::string& key) const{
+	return directory + "/" + key + ".hxa";
+}
+
+std::string PersistentCache::key(const std::string& operatorName, const std::string& operatorVersion, const OperatorArguments& parameters, const std::vector<std::string>& dependencies, const std::vector<const HexAnswer*>& answers, RegistryPtr reg) const{
+	std::string data;
+	appendField(data, operatorName);
+	appendField(data, operatorVersion);
+
+	OperatorArguments sorted(parameters);
+	std::sort(sorted.begin(), sorted.end());
+	for (OperatorArguments::const_iterator it = sorted.begin(); it != sorted.end(); ++it){
+		appendField(data, it->first);
+		appendField(data, it->second);
+	}
+
+	for (std::vector<std::string>::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it){
+		appendField(data, fingerprintFile(*it));
+	}
+	for (std::vector<const HexAnswer*>::const_iterator it = answers.begin(); it != answers.end(); ++it){
+		appendField(data, fingerprintAnswer(reg, **it));
+	}
+	return fingerprint(data);
+}
+
+bool PersistentCache::load(const std::string& key, RegistryPtr reg, HexAnswer& answer) const{
+	std::string data;
+	if (!readFile(path(key), data)) return false;
+
+	// decode into a separate answer such that corrupt entries do not leave partial results
+	HexAnswer entry;
+	try{
+		BinaryAnswerReader(data).read(reg, entry);
+	}catch(PluginError&){
+		return false;
+	}
+	answer.insert(answer.end(), entry.begin(), entry.end());
+	return true;
+}
+
+void PersistentCache::store(const std::string& key, RegistryPtr reg, const HexAnswer& answer) const{
+	std::string data;
+	BinaryAnswerWriter writer(reg);
+	writer.add(answer);
+	writer.write(data);
+
+	std::stringstream tmp;
+	tmp << path(key) << ".tmp" << getpid();
+	std::ofstream file(tmp.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open()) return;
+	file.write(data.data(), data.size());
+	file.close();
+	if (file.fail() || rename(tmp.str().c_str(), path(key).c_str()) != 0){
+		unlink(tmp.str().c_str());
+	}
+}
+
+std::string PersistentCache::fingerprint(const std::string& data){
+	char hex[33];
+	snprintf(hex, sizeof(hex), "%016llx%016llx",
+		(unsigned long long)fnv1a(data, 14695981039346656037ULL),
+		(unsigned long long)fnv1a(data, 0x9ae16a3b2f90404fULL ^ data.length()));
+	return std::string(hex);
+}
+
+std::string PersistentCache::fingerprintFile(const std::string& filename){
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0) return "missing";
+
+	// the contents are only read again if the file was modified since its last fingerprint
+	boost::unordered_map<std::string, FileFingerprint>::iterator it = files.find(filename);
+	if (it != files.end() && it->second.mtime == st.st_mtime && it->second.size == st.st_size){
+		return it->second.fingerprint;
+	}
+
+	std::string content;
+	if (!readFile(filename, content)) return "missing";
+	FileFingerprint& entry = files[filename];
+	entry.mtime = st.st_mtime;
+	entry.size = st.st_size;
+	entry.fingerprint = fingerprint(content);
+	return entry.fingerprint;
+}
+
+std::string PersistentCache::stampFile(const std::string& filename){
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0) return "missing";
+	std::stringstream ss;
+	ss << (long)st.st_mtime << ":" << (long)st.st_size;
+	return ss.str();
+}
+
+std::string PersistentCache::fingerprintAnswer(RegistryPtr reg, const HexAnswer& answer){
+	// atoms are identified by their textual representation; the answer-sets of an answer usually share most of their atoms
+	boost::unordered_map<IDAddress, std::string> atoms;
+	std::vector<std::string> answersets;
+	for (HexAnswer::const_iterator it = answer.begin(); it != answer.end(); ++it){
+		std::vector<std::string> set;
+		for (Interpretation::Storage::enumerator en = (*it)->getStorage().first(); en != (*it)->getStorage().end(); ++en){
+			boost::unordered_map<IDAddress, std::string>::iterator atom = atoms.find(*en);
+			if (atom == atoms.end()){
+				std::stringstream ss;
+				AnswerFormat::printAtom(reg, ss, reg->ogatoms.getIDByAddress(*en));
+				atom = atoms.insert(std::make_pair(*en, ss.str())).first;
+			}
+			if (atom->second.length() > 0) set.push_back(atom->second);
+		}
+		std::sort(set.begin(), set.end());
+
+		std::string data;
+		for (std::vector<std::string>::iterator a = set.begin(); a != set.end(); ++a) appendField(data, *a);
+		answersets.push_back(fingerprint(data));
+	}
+	std::sort(answersets.begin(), answersets.end());
+
+	std::string data;
+	for (std::vector<std::string>::iterator s = answersets.begin(); s != answersets.end(); ++s) data += *s;
+	return fingerprint(data);
+}
@@ -0,0 +1,372 @@
+#include <PlanScheduler.h>
+
+#include <Operators.h>
+#include <IOperatorV2.h>
+#include <LazyAnswer.h>
+#include <dlvhex2/Interpretation.h>
+
+#include <algorithm>
+#include <iostream>
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+using dlvhex::merging::tools::mpcompiler::PlanNode;
+
+
+// -------------------- Util (local functions!) --------------------
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+namespace{
+	// threads report the nodes they have finished to the main thread
+	struct Completion{
+		pthread_mutex_t mutex;
+		pthread_cond_t cond;
+		std::vector<int> finished;
+	};
+
+	struct Task{
+		enum State{
+			Waiting,
+			Running,
+			Done,
+			Failed,
+		};
+
+		State state;
+		HexCall* call;
+		int index;			// cache index of the result
+		int slot;			// worker slot of belief bases evaluated by the worker pool (-1 otherwise)
+		OperatorApplication* app;
+		pthread_t thread;
+		bool failed;			// set by the thread
+		int node;
+		Completion* completion;
+		double start;
+		double duration;
+	};
+
+	void* evaluateTask(void* arg){
+		Task* task = (Task*)arg;
+		try{
+			task->app->evaluate(true);
+		}catch(...){
+			task->failed = true;
+		}
+
+		pthread_mutex_lock(&task->completion->mutex);
+		task->completion->finished.push_back(task->node);
+		pthread_cond_signal(&task->completion->cond);
+		pthread_mutex_unlock(&task->completion->mutex);
+		return NULL;
+	}
+
+	void waitForCompletion(Completion& completion, int ms){
+		struct timeval tv;
+		gettimeofday(&tv, NULL);
+		struct timespec until;
+		long usec = tv.tv_usec + ms * 1000L;
+		until.tv_sec = tv.tv_sec + usec / 1000000L;
+		until.tv_nsec = (usec % 1000000L) * 1000L;
+
+		pthread_mutex_lock(&completion.mutex);
+		if (completion.finished.size() == 0) pthread_cond_timedwait(&completion.cond, &completion.mutex, &until);
+		pthread_mutex_unlock(&completion.mutex);
+	}
+}
+
+
+// ---------- PlanScheduler ----------
+
+PlanScheduler::PlanScheduler() : ctx(NULL), operatorAtom(NULL), profiler(NULL), debug(false){
+	threads = std::max(1, (int)sysconf(_SC_NPROCESSORS_ONLN));
+}
+
+void PlanScheduler::setProgramCtx(ProgramCtx& ctx){
+	this->ctx = &ctx;
+}
+
+void PlanScheduler::setOperatorAtom(OperatorAtom* operatorAtom){
+	this->operatorAtom = operatorAtom;
+}
+
+void PlanScheduler::setThreads(int threads){
+	this->threads = threads;
+}
+
+void PlanScheduler::setProfiler(Profiler* profiler){
+	this->profiler = profiler;
+}
+
+void PlanScheduler::setDebug(bool debug){
+	this->debug = debug;
+}
+
+void PlanScheduler::setPlan(const std::vector<PlanNode>& plan){
+	if (threads > 0) this->plan = plan;
+}
+
+bool PlanScheduler::hasPlan(){
+	return plan.size() > 0;
+}
+
+HexCall PlanScheduler::makeCall(const PlanNode& node, const std::vector<int>& arguments){
+	switch (node.type){
+		case PlanNode::Program:
+			// &callhex0 and &callhexfile0 receive no input predicates, hence an empty interpretation
+			return HexCall(HexCall::HexProgram, node.source, "", InterpretationPtr(new Interpretation(ctx->registry())));
+		case PlanNode::File:
+			return HexCall(HexCall::HexFile, node.source, "", InterpretationPtr(new Interpretation(ctx->registry())));
+		default:
+			OperatorArguments parameters;
+			for (std::vector<std::pair<std::string, std::string> >::const_iterator it = node.parameters.begin(); it != node.parameters.end(); ++it){
+				parameters.push_back(KeyValuePair(it->first, it->second));
+			}
+			HexCall call = operatorAtom->makeCall(node.operatorname, arguments, parameters);
+			call.setLabel(node.id);
+			return call;
+	}
+}
+
+void PlanScheduler::run(HexAnswerCache& cache){
+	assert(ctx && operatorAtom);
+
+	// the plan is evaluated only once (the nodes evaluated inline look up the cache, which would start it again)
+	std::vector<PlanNode> nodes;
+	nodes.swap(plan);
+
+	Completion completion;
+	pthread_mutex_init(&completion.mutex, NULL);
+	pthread_cond_init(&completion.cond, NULL);
+
+	std::vector<Task> tasks(nodes.size());
+	for (int i = 0; i < nodes.size(); i++){
+		tasks[i].state = Task::Waiting;
+		tasks[i].call = NULL;
+		tasks[i].index = -1;
+		tasks[i].slot = -1;
+		tasks[i].app = NULL;
+		tasks[i].failed = false;
+		tasks[i].node = i;
+		tasks[i].completion = &completion;
+		tasks[i].start = 0;
+		tasks[i].duration = 0;
+	}
+
+	// Operator threads only read the registry. Everything which may add atoms (collecting the results of workers, evaluating nodes
+	// inline and preparing operator applications, which may reload evicted arguments) and everything which may fork (submitting jobs
+	// to the worker pool) is done in the main thread while no operator thread is running.
+	double started = now();
+	int open = nodes.size();
+	int running = 0;	// threads
+	int submitted = 0;	// worker pool jobs
+	while (open > 0){
+		bool progress = false;
+
+		// finished threads
+		std::vector<int> finished;
+		pthread_mutex_lock(&completion.mutex);
+		finished.swap(completion.finished);
+		pthread_mutex_unlock(&completion.mutex);
+		for (std::vector<int>::iterator it = finished.begin(); it != finished.end(); ++it){
+			Task& task = tasks[*it];
+			pthread_join(task.thread, NULL);
+			running--;
+			task.duration = now() - task.start;
+			task.state = task.failed ? Task::Failed : Task::Done;
+			progress = true;
+		}
+		if (running == 0){
+			for (int i = 0; i < tasks.size(); i++){
+				Task& task = tasks[i];
+				if (task.state == Task::Done && task.app){
+					try{
+						task.index = cache.finish(*task.app);
+					}catch(...){
+						task.state = Task::Failed;
+					}
+				}else if (task.state == Task::Failed && task.app){
+					cache.abort(*task.app);
+				}
+				delete task.app;
+				task.app = NULL;
+			}
+		}
+
+		// finished worker pool jobs
+		if (running == 0){
+			for (int i = 0; i < tasks.size(); i++){
+				Task& task = tasks[i];
+				if (task.state != Task::Running || task.slot < 0 || !cache.ready(task.slot, 0)) continue;
+				try{
+					task.index = cache.collect(*task.call, task.slot);
+					task.state = Task::Done;
+				}catch(...){
+					task.state = Task::Failed;
+				}
+				task.slot = -1;
+				task.duration = now() - task.start;
+				submitted--;
+				progress = true;
+			}
+		}
+
+		// nodes whose arguments are available
+		int inlineNode = -1;
+		std::vector<int> parallel;
+		for (int i = 0; i < tasks.size(); i++){
+			Task& task = tasks[i];
+			if (task.state != Task::Waiting) continue;
+
+			bool available = true;
+			std::vector<int> arguments;
+			for (std::vector<int>::const_iterator arg = nodes[i].arguments.begin(); arg != nodes[i].arguments.end(); ++arg){
+				if (*arg < 0 || tasks[*arg].state == Task::Failed){
+					task.state = Task::Failed;
+					break;
+				}
+				if (tasks[*arg].state != Task::Done || tasks[*arg].app){
+					available = false;
+				}else{
+					arguments.push_back(tasks[*arg].index);
+				}
+			}
+			if (task.state == Task::Failed){
+				progress = true;
+				continue;
+			}
+			if (!available) continue;
+
+			if (!task.call){
+				try{
+					task.call = new HexCall(makeCall(nodes[i], arguments));
+				}catch(...){
+					task.state = Task::Failed;
+					progress = true;
+					continue;
+				}
+			}
+
+			// results of previous plans or of equivalent nodes
+			int index = cache.find(*task.call);
+			if (index >= 0){
+				task.index = index;
+				task.state = Task::Done;
+				progress = true;
+				continue;
+			}
+
+			if (task.call->getType() != HexCall::OperatorCall){
+				// a forked worker would inherit the locks held by operator threads; submit after the current batch
+				if (running > 0) continue;
+				task.start = now();
+				task.slot = cache.submit(*task.call);
+				if (task.slot >= 0){
+					task.state = Task::Running;
+					submitted++;
+					progress = true;
+				}else if (inlineNode < 0){
+					inlineNode = i;
+				}
+			}else{
+				IOperatorV2* op = dynamic_cast<IOperatorV2*>(task.call->getOperator());
+				if (op && !dynamic_cast<LazyOperator*>(op) && (op->getCapabilities(task.call->getKvParams()) & IOperatorV2::ParallelSafe)){
+					if (running == 0 && parallel.size() < threads) parallel.push_back(i);
+				}else if (inlineNode < 0){
+					inlineNode = i;
+				}
+			}
+		}
+
+		// start a batch of concurrent operator applications
+		for (std::vector<int>::iterator it = parallel.begin(); it != parallel.end(); ++it){
+			Task& task = tasks[*it];
+			task.start = now();
+			task.app = new OperatorApplication(*task.call);
+			progress = true;
+			try{
+				cache.prepare(*task.app);
+			}catch(...){
+				delete task.app;
+				task.app = NULL;
+				task.state = Task::Failed;
+				continue;
+			}
+			task.state = Task::Running;
+			if (pthread_create(&task.thread, NULL, evaluateTask, &task) == 0){
+				running++;
+			}else{
+				// no more threads available: evaluate in the main thread (other threads of the batch may still run)
+				try{
+					task.app->evaluate(true);
+					task.state = Task::Done;
+				}catch(...){
+					task.state = Task::Failed;
+				}
+				task.duration = now() - task.start;
+			}
+		}
+
+		// evaluate one of the remaining nodes inline
+		if (!progress && running == 0 && inlineNode >= 0){
+			Task& task = tasks[inlineNode];
+			task.start = now();
+			try{
+				task.index = cache[*task.call];
+				task.state = Task::Done;
+			}catch(...){
+				task.state = Task::Failed;
+			}
+			task.duration = now() - task.start;
+			progress = true;
+		}
+
+		// count the nodes which were completed in this round
+		open = 0;
+		for (int i = 0; i < tasks.size(); i++){
+			if ((tasks[i].state != Task::Done && tasks[i].state != Task::Failed) || tasks[i].app) open++;
+		}
+
+		if (!progress && open > 0){
+			if (running == 0 && submitted == 0){
+				// cannot happen since arguments precede the nodes using them; avoid hanging anyway
+				break;
+			}
+			waitForCompletion(completion, 2);
+		}
+	}
+	double elapsed = now() - started;
+
+	for (int i = 0; i < tasks.size(); i++){
+		// name the results in the profile as in the translated plan
+		if (profiler && tasks[i].state == Task::Done && tasks[i].index >= 0) profiler->setLabel(tasks[i].index, nodes[i].id);
+		delete tasks[i].call;
+	}
+	pthread_cond_destroy(&completion.cond);
+	pthread_mutex_destroy(&completion.mutex);
+
+	if (debug){
+		// critical path: longest chain of dependent nodes
+		std::vector<double> path(nodes.size(), 0);
+		double work = 0;
+		double critical = 0;
+		for (int i = 0; i < nodes.size(); i++){
+			double longest = 0;
+			for (std::vector<int>::const_iterator arg = nodes[i].arguments.begin(); arg != nodes[i].arguments.end(); ++arg){
+				if (*arg >= 0) longest = std::max(longest, path[*arg]);
+			}
+			path[i] = longest + tasks[i].duration;
+			work += tasks[i].duration;
+			critical = std::max(critical, path[i]);
+		}
+		std::cerr << "mergingplugin: plan of " << nodes.size() << " nodes: total work " << work << " s, critical path " << critical << " s, elapsed " << elapsed << " s" << std::endl;
+	}
+}
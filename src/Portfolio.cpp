@@ -0,0 +1,178 @@
+#include <Portfolio.h>
+
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+// Members write a one-byte status ('R' = result, 'X' = error message) followed by the payload and terminate.
+
+static void writeAll(int fd, const char* buf, size_t len){
+	while (len > 0){
+		ssize_t written = write(fd, buf, len);
+		if (written < 0){
+			if (errno == EINTR) continue;
+			return;
+		}
+		buf += written;
+		len -= written;
+	}
+}
+
+
+// ---------- Portfolio ----------
+
+Portfolio::Portfolio() : channel(-1){
+}
+
+Portfolio::~Portfolio(){
+	// members which are still running are no longer needed
+	if (channel == -1){
+		for (int i = 0; i < members.size(); i++){
+			if (members[i].pid > 0) terminate(i);
+		}
+	}
+}
+
+bool Portfolio::start(const std::string& name) throw (PluginError){
+	assert(channel == -1);
+
+	int fds[2];
+	if (pipe(fds) != 0){
+		throw PluginError("Could not create communication channel for portfolio member");
+	}
+
+	// the member inherits the stream buffers
+	std::cout.flush();
+	std::cerr.flush();
+
+	pid_t pid = fork();
+	if (pid < 0){
+		close(fds[0]);
+		close(fds[1]);
+		throw PluginError("Could not fork portfolio member");
+	}
+	if (pid == 0){
+		// member: own process group, such that spawned solvers can be killed together with it
+		setpgid(0, 0);
+		close(fds[0]);
+		for (int i = 0; i < members.size(); i++){
+			if (members[i].fd >= 0) close(members[i].fd);
+		}
+		members.clear();
+		channel = fds[1];
+		return true;
+	}
+
+	// also set the process group here to avoid a race with terminate
+	setpgid(pid, pid);
+	close(fds[1]);
+	Member m;
+	m.name = name;
+	m.pid = pid;
+	m.fd = fds[0];
+	members.push_back(m);
+	return false;
+}
+
+void Portfolio::deliver(const std::string& result){
+	assert(channel != -1);
+	writeAll(channel, "R", 1);
+	writeAll(channel, result.data(), result.size());
+	close(channel);
+
+	// never return into dlvhex and do not run the destructors of static objects
+	_exit(0);
+}
+
+void Portfolio::fail(const std::string& message){
+	assert(channel != -1);
+	writeAll(channel, "X", 1);
+	writeAll(channel, message.data(), message.size());
+	close(channel);
+	_exit(1);
+}
+
+void Portfolio::terminate(int member){
+	assert(members[member].pid > 0);
+
+	kill(-members[member].pid, SIGKILL);
+	if (members[member].fd >= 0){
+		close(members[member].fd);
+		members[member].fd = -1;
+	}
+	int status;
+	while (waitpid(members[member].pid, &status, 0) < 0 && errno == EINTR);
+	members[member].pid = 0;
+}
+
+int Portfolio::wait(std::string& result) throw (PluginError){
+	assert(channel == -1);
+
+	std::stringstream errors;
+	int running = members.size();
+	while (running > 0){
+		std::vector<struct pollfd> fds;
+		std::vector<int> index;
+		for (int i = 0; i < members.size(); i++){
+			if (members[i].fd < 0) continue;
+			struct pollfd p;
+			p.fd = members[i].fd;
+			p.events = POLLIN;
+			p.revents = 0;
+			fds.push_back(p);
+			index.push_back(i);
+		}
+		if (poll(&fds[0], fds.size(), -1) < 0){
+			if (errno == EINTR) continue;
+			throw PluginError("Error while waiting for portfolio members");
+		}
+
+		for (int f = 0; f < fds.size(); f++){
+			if (fds[f].revents == 0) continue;
+			Member& m = members[index[f]];
+
+			char buf[65536];
+			ssize_t r = read(m.fd, buf, sizeof(buf));
+			if (r < 0 && errno == EINTR) continue;
+			if (r > 0){
+				m.output.append(buf, r);
+				continue;
+			}
+
+			// member finished
+			close(m.fd);
+			m.fd = -1;
+			int status;
+			while (waitpid(m.pid, &status, 0) < 0 && errno == EINTR);
+			m.pid = 0;
+			running--;
+
+			if (m.output.length() > 0 && m.output[0] == 'R' && WIFEXITED(status) && WEXITSTATUS(status) == 0){
+				// first result: stop the others
+				for (int i = 0; i < members.size(); i++){
+					if (members[i].pid > 0) terminate(i);
+				}
+				result = m.output.substr(1);
+				return index[f];
+			}
+			errors << " " << m.name << ": " << (m.output.length() > 1 && m.output[0] == 'X' ? m.output.substr(1) : std::string("crashed")) << ";";
+		}
+	}
+	throw PluginError("All portfolio members failed:" + errors.str());
+}
+
+std::string Portfolio::getName(int member){
+	return members[member].name;
+}
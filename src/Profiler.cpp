@@ -0,0 +1,232 @@
+#include <Profiler.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+static double now(){
+	struct timeval tv;
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+static double threadCpuTime(){
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return -1;
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+static long peakMemory(){
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+	return usage.ru_maxrss;
+}
+
+static long countAtoms(const HexAnswer& answer){
+	long atoms = 0;
+	for (HexAnswer::const_iterator it = answer.begin(); it != answer.end(); ++it){
+		atoms += (*it)->getStorage().count();
+	}
+	return atoms;
+}
+
+static bool slower(const ProfileRecord& a, const ProfileRecord& b){
+	return a.wall > b.wall;
+}
+
+static std::string jsonString(const std::string& s){
+	std::stringstream ss;
+	ss << "\"";
+	for (std::string::const_iterator it = s.begin(); it != s.end(); ++it){
+		if (*it == '\"' || *it == '\\'){
+			ss << '\\' << *it;
+		}else if ((unsigned char)*it < 0x20){
+			char escaped[7];
+			snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char)*it);
+			ss << escaped;
+		}else{
+			ss << *it;
+		}
+	}
+	ss << "\"";
+	return ss.str();
+}
+
+// threads which have measured something (index = lane)
+static pthread_mutex_t threadsMutex = PTHREAD_MUTEX_INITIALIZER;
+static std::vector<pthread_t> threads;
+
+
+// ---------- ProfileRecord ----------
+
+ProfileRecord::ProfileRecord(bool a) : active(a), index(-1), thread(Profiler::MainThread), start(0), wall(-1), cpu(-1), memory(-1), answersetsIn(0), answersetsOut(-1), atomsIn(0), atomsOut(-1){
+}
+
+void ProfileRecord::begin(){
+	if (!active) return;
+	thread = Profiler::getThread();
+	start = now();
+	cpu = threadCpuTime();
+	memory = peakMemory();
+}
+
+void ProfileRecord::end(){
+	if (!active) return;
+	wall = now() - start;
+	if (cpu >= 0) cpu = threadCpuTime() - cpu;
+	if (memory >= 0) memory = peakMemory() - memory;
+}
+
+void ProfileRecord::addInputs(const std::vector<HexAnswer*>& answers){
+	if (!active) return;
+	for (std::vector<HexAnswer*>::const_iterator it = answers.begin(); it != answers.end(); ++it){
+		answersetsIn += (*it)->size();
+		atomsIn += countAtoms(**it);
+	}
+}
+
+void ProfileRecord::addFacts(InterpretationConstPtr facts){
+	if (!active || !facts) return;
+	atomsIn += facts->getStorage().count();
+}
+
+void ProfileRecord::setOutput(const HexAnswer& answer){
+	if (!active) return;
+	answersetsOut = answer.size();
+	atomsOut = countAtoms(answer);
+}
+
+
+// ---------- Profiler ----------
+
+Profiler::Profiler(){
+	pthread_mutex_init(&mutex, NULL);
+}
+
+Profiler::~Profiler(){
+	write();
+	pthread_mutex_destroy(&mutex);
+}
+
+void Profiler::setFile(std::string file){
+	this->file = file;
+}
+
+bool Profiler::enabled(){
+	return file.length() > 0;
+}
+
+void Profiler::add(const ProfileRecord& record){
+	if (!enabled() || !record.active) return;
+	pthread_mutex_lock(&mutex);
+	records.push_back(record);
+	pthread_mutex_unlock(&mutex);
+}
+
+void Profiler::setLabel(int index, std::string label){
+	if (!enabled()) return;
+	pthread_mutex_lock(&mutex);
+	labels[index] = label;
+	pthread_mutex_unlock(&mutex);
+}
+
+std::string Profiler::getLabel(const ProfileRecord& record){
+	if (record.label.length() > 0) return record.label;
+	std::map<int, std::string>::iterator it = labels.find(record.index);
+	if (it != labels.end()) return it->second;
+	std::stringstream ss;
+	ss << "#" << record.index;
+	return ss.str();
+}
+
+int Profiler::getThread(){
+	pthread_mutex_lock(&threadsMutex);
+	int lane = 0;
+	while (lane < threads.size() && !pthread_equal(threads[lane], pthread_self())) lane++;
+	if (lane == threads.size()) threads.push_back(pthread_self());
+	pthread_mutex_unlock(&threadsMutex);
+	return MainThread + lane;
+}
+
+void Profiler::writeTable(std::ostream& os, std::vector<ProfileRecord> sorted){
+	std::stable_sort(sorted.begin(), sorted.end(), slower);
+
+	double total = 0;
+	for (std::vector<ProfileRecord>::iterator it = sorted.begin(); it != sorted.end(); ++it) total += it->wall;
+
+	os << std::left << std::setw(40) << "label" << std::setw(20) << "name" << std::right
+	   << std::setw(10) << "wall[s]" << std::setw(8) << "wall%" << std::setw(10) << "cpu[s]" << std::setw(10) << "mem[KB]"
+	   << std::setw(9) << "sets in" << std::setw(9) << "sets out" << std::setw(11) << "atoms in" << std::setw(11) << "atoms out" << std::endl;
+	os << std::fixed << std::setprecision(4);
+	for (std::vector<ProfileRecord>::iterator it = sorted.begin(); it != sorted.end(); ++it){
+		os << std::left << std::setw(40) << getLabel(*it) << std::setw(20) << it->name << std::right << std::setw(10) << it->wall;
+		os << std::setw(8) << std::setprecision(1) << (total > 0 ? 100 * it->wall / total : 0) << std::setprecision(4);
+		if (it->cpu >= 0) os << std::setw(10) << it->cpu; else os << std::setw(10) << "-";
+		if (it->memory >= 0) os << std::setw(10) << it->memory; else os << std::setw(10) << "-";
+		os << std::setw(9) << it->answersetsIn;
+		if (it->answersetsOut >= 0) os << std::setw(9) << it->answersetsOut; else os << std::setw(9) << "-";
+		os << std::setw(11) << it->atomsIn;
+		if (it->atomsOut >= 0) os << std::setw(11) << it->atomsOut; else os << std::setw(11) << "-";
+		os << std::endl;
+	}
+	os << std::left << std::setw(60) << "total" << std::right << std::setw(10) << total << std::endl;
+}
+
+void Profiler::writeTrace(std::ostream& os){
+	double origin = 0;
+	std::map<int, std::string> lanes;
+	for (std::vector<ProfileRecord>::iterator it = records.begin(); it != records.end(); ++it){
+		if (origin == 0 || it->start < origin) origin = it->start;
+		std::stringstream lane;
+		if (it->thread >= WorkerLane){
+			lane << "worker " << (it->thread - WorkerLane);
+		}else if (it->thread == MainThread){
+			lane << "main";
+		}else{
+			lane << "thread " << it->thread;
+		}
+		lanes[it->thread] = lane.str();
+	}
+
+	os << "{\"traceEvents\":[" << std::endl;
+	bool first = true;
+	for (std::map<int, std::string>::iterator it = lanes.begin(); it != lanes.end(); ++it){
+		os << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << getpid() << ",\"tid\":" << it->first << ",\"args\":{\"name\":" << jsonString(it->second) << "}}";
+		first = false;
+	}
+	for (std::vector<ProfileRecord>::iterator it = records.begin(); it != records.end(); ++it){
+		os << (first ? "" : ",\n") << "{\"name\":" << jsonString(getLabel(*it)) << ",\"cat\":" << jsonString(it->name) << ",\"ph\":\"X\""
+		   << ",\"ts\":" << (long long)((it->start - origin) * 1000000) << ",\"dur\":" << (long long)(it->wall * 1000000)
+		   << ",\"pid\":" << getpid() << ",\"tid\":" << it->thread
+		   << ",\"args\":{\"cpu\":" << it->cpu << ",\"memory\":" << it->memory
+		   << ",\"answersetsIn\":" << it->answersetsIn << ",\"answersetsOut\":" << it->answersetsOut
+		   << ",\"atomsIn\":" << it->atomsIn << ",\"atomsOut\":" << it->atomsOut << "}}";
+		first = false;
+	}
+	os << std::endl << "]}" << std::endl;
+}
+
+void Profiler::write(){
+	if (!enabled()) return;
+	pthread_mutex_lock(&mutex);
+
+	std::ofstream table(file.c_str());
+	if (table.is_open()) writeTable(table, records);
+	std::ofstream trace((file + ".trace.json").c_str());
+	if (trace.is_open()) writeTrace(trace);
+
+	pthread_mutex_unlock(&mutex);
+}
@@ -0,0 +1,391 @@
+#include <WorkerPool.h>
+#include <BinaryAnswer.h>
+#include <AnswerFormat.h>
+#include <DynamicAtoms.h>
+
+#include <dlvhex2/InputProvider.h>
+#include <dlvhex2/DLVresultParserDriver.h>
+#include <dlvhex2/PluginInterface.h>
+
+#include <boost/foreach.hpp>
+
+#include <cassert>
+#include <sstream>
+#include <iostream>
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+using namespace dlvhex;
+using namespace dlvhex::merging::plugin;
+
+
+// -------------------- Util (local functions!) --------------------
+
+// Frames consist of a one-byte tag, the payload length (4 bytes, network byte order) and the payload
+//	Parent to worker:	'P' or 'F' (program source or path; 'p' and 'f' request a binary answer), followed by a frame 'I' (input facts);
+//				'Q' terminates the worker
+//	Worker to parent:	'A' (one answer-set in text format), 'E' (end of a textual answer), 'B' (complete answer in binary format),
+//				'X' (error message)
+
+static bool writeAll(int fd, const char* buf, size_t len){
+	while (len > 0){
+		// MSG_NOSIGNAL: a crashed worker must not kill dlvhex with SIGPIPE
+		ssize_t written = send(fd, buf, len, MSG_NOSIGNAL);
+		if (written < 0){
+			if (errno == EINTR) continue;
+			return false;
+		}
+		buf += written;
+		len -= written;
+	}
+	return true;
+}
+
+static bool readAll(int fd, char* buf, size_t len){
+	while (len > 0){
+		ssize_t r = read(fd, buf, len);
+		if (r < 0){
+			if (errno == EINTR) continue;
+			return false;
+		}
+		if (r == 0) return false;	// peer closed the connection
+		buf += r;
+		len -= r;
+	}
+	return true;
+}
+
+static bool writeFrame(int fd, char tag, const std::string& payload){
+	char header[5];
+	header[0] = tag;
+	uint32_t len = htonl((uint32_t)payload.size());
+	memcpy(header + 1, &len, 4);
+	return writeAll(fd, header, 5) && writeAll(fd, payload.data(), payload.size());
+}
+
+static bool readFrame(int fd, char& tag, std::string& payload){
+	char header[5];
+	if (!readAll(fd, header, 5)) return false;
+	tag = header[0];
+	uint32_t len;
+	memcpy(&len, header + 1, 4);
+	payload.resize(ntohl(len));
+	return payload.size() == 0 || readAll(fd, &payload[0], payload.size());
+}
+
+namespace{
+	// collects the answer-sets delivered by DLVResultParser
+	struct HexAnswerAdder{
+		HexAnswer& answer;
+		HexAnswerAdder(HexAnswer& a) : answer(a){}
+		void operator()(AnswerSet::Ptr as){
+			answer.push_back(as->interpretation);
+		}
+	};
+}
+
+
+// ---------- WorkerPool ----------
+
+WorkerPool::WorkerPool() : ctx(NULL), atoms(NULL), poolSize(0), maxJobsPerWorker(100), nextWorker(0), binaryProtocol(true){
+}
+
+WorkerPool::~WorkerPool(){
+	for (int i = 0; i < workers.size(); i++){
+		if (workers[i].pid > 0) stopWorker(i, workers[i].busy);
+	}
+}
+
+void WorkerPool::setProgramCtx(ProgramCtx& ctx){
+	this->ctx = &ctx;
+}
+
+void WorkerPool::setSize(int size){
+	// stop workers that are no longer needed
+	for (int i = size; i < workers.size(); i++){
+		if (workers[i].pid > 0) stopWorker(i, workers[i].busy);
+	}
+
+	Worker idle;
+	idle.pid = 0;
+	idle.fd = -1;
+	idle.jobs = 0;
+	idle.busy = false;
+	idle.type = Program;
+	idle.binary = false;
+	workers.resize(size, idle);
+	poolSize = size;
+	nextWorker = 0;
+}
+
+int WorkerPool::getSize(){
+	return poolSize;
+}
+
+bool WorkerPool::enabled(){
+	return poolSize > 0;
+}
+
+bool WorkerPool::idle(){
+	for (int slot = 0; slot < poolSize; slot++){
+		if (!workers[slot].busy) return true;
+	}
+	return false;
+}
+
+bool WorkerPool::ready(int slot, int timeout){
+	assert(slot >= 0 && slot < poolSize && workers[slot].busy);
+
+	// a crashed worker is ready as well (collect restarts it)
+	struct pollfd pfd;
+	pfd.fd = workers[slot].fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	return poll(&pfd, 1, timeout) != 0;
+}
+
+void WorkerPool::setBinaryProtocol(bool binary){
+	binaryProtocol = binary;
+}
+
+void WorkerPool::setDynamicAtoms(DynamicAtoms* atoms){
+	this->atoms = atoms;
+}
+
+void WorkerPool::spawnWorker(int slot){
+	assert(ctx != NULL);
+	assert(workers[slot].pid == 0);
+
+	int fds[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0){
+		throw PluginError("Could not create communication channel for solver worker");
+	}
+
+	// the worker inherits the stream buffers
+	std::cout.flush();
+	std::cerr.flush();
+
+	pid_t pid = fork();
+	if (pid < 0){
+		close(fds[0]);
+		close(fds[1]);
+		throw PluginError("Could not fork solver worker");
+	}
+	if (pid == 0){
+		// worker: drop the channels of the other workers
+		close(fds[0]);
+		for (int i = 0; i < workers.size(); i++){
+			if (workers[i].pid > 0) close(workers[i].fd);
+		}
+		// nested calls within the worker are evaluated in-process
+		workers.clear();
+		poolSize = 0;
+		serve(fds[1]);
+
+		// never return into dlvhex and do not run the destructors of static objects
+		_exit(0);
+	}
+
+	close(fds[1]);
+	workers[slot].pid = pid;
+	workers[slot].fd = fds[0];
+	workers[slot].jobs = 0;
+	workers[slot].busy = false;
+}
+
+void WorkerPool::stopWorker(int slot, bool kill){
+	assert(workers[slot].pid > 0);
+
+	if (kill){
+		::kill(workers[slot].pid, SIGKILL);
+	}else{
+		writeFrame(workers[slot].fd, 'Q', "");
+	}
+	close(workers[slot].fd);
+	int status;
+	while (waitpid(workers[slot].pid, &status, 0) < 0 && errno == EINTR);
+
+	workers[slot].pid = 0;
+	workers[slot].fd = -1;
+	workers[slot].busy = false;
+}
+
+// main loop of a worker process
+void WorkerPool::serve(int fd){
+	char tag, factstag;
+	std::string program, facts;
+
+	while (readFrame(fd, tag, program) && tag != 'Q'){
+		if (!readFrame(fd, factstag, facts) || factstag != 'I') return;
+
+		try{
+			// each job is evaluated in a fresh subprogram context
+			// the worker may have been forked before the atoms referenced by this program were registered
+			InputProviderPtr ip(new InputProvider());
+			if (tag == 'F' || tag == 'f'){
+				if (atoms) atoms->requireFile(program);
+				ip->addFileInput(program);
+			}else{
+				if (atoms) atoms->require(program);
+				ip->addStringInput(program, "pooledprog");
+			}
+			if (facts.length() > 0){
+				ip->addStringInput(facts, "pooledfacts");
+			}
+
+			std::vector<InterpretationPtr> answer = ctx->evaluateSubprogram(ip, InterpretationConstPtr(new Interpretation(ctx->registry())));
+			if (tag == 'p' || tag == 'f'){
+				BinaryAnswerWriter writer(ctx->registry());
+				writer.add(answer);
+				std::string encoded;
+				writer.write(encoded);
+				if (!writeFrame(fd, 'B', encoded)) return;
+			}else{
+				BOOST_FOREACH (InterpretationPtr intr, answer){
+					if (!writeFrame(fd, 'A', AnswerFormat::formatAnswerSet(intr))) return;
+				}
+				if (!writeFrame(fd, 'E', "")) return;
+			}
+		}catch(std::exception& e){
+			if (!writeFrame(fd, 'X', e.what())) return;
+		}catch(...){
+			if (!writeFrame(fd, 'X', "Nested program failed")) return;
+		}
+	}
+}
+
+void WorkerPool::sendJob(int slot){
+	if (workers[slot].pid == 0) spawnWorker(slot);
+
+	Worker& w = workers[slot];
+	char tag = w.type == File ? (w.binary ? 'f' : 'F') : (w.binary ? 'p' : 'P');
+	if (!writeFrame(w.fd, tag, w.program) || !writeFrame(w.fd, 'I', w.facts)){
+		// worker died in the meantime: restart it once
+		stopWorker(slot, true);
+		spawnWorker(slot);
+		if (!writeFrame(w.fd, tag, w.program) || !writeFrame(w.fd, 'I', w.facts)){
+			stopWorker(slot, true);
+			throw PluginError("Could not send program to solver worker");
+		}
+	}
+	w.busy = true;
+}
+
+// reads all frames of one answer; returns false if the worker crashed
+bool WorkerPool::receiveAnswer(int slot, std::string& answer, std::string& error){
+	std::stringstream ss;
+	char tag;
+	std::string payload;
+	while (readFrame(workers[slot].fd, tag, payload)){
+		switch (tag){
+			case 'A':
+				ss << payload << std::endl;
+				break;
+			case 'E':
+				answer = ss.str();
+				return true;
+			case 'B':
+				answer.swap(payload);
+				return true;
+			case 'X':
+				error = payload;
+				return true;
+			default:
+				return false;
+		}
+	}
+	return false;
+}
+
+int WorkerPool::submit(JobType type, std::string program, InterpretationConstPtr facts){
+	return submitJob(type, program, facts, binaryProtocol);
+}
+
+int WorkerPool::submitJob(JobType type, std::string program, InterpretationConstPtr facts, bool binary){
+	assert(enabled());
+
+	// round robin over the idle workers
+	for (int i = 0; i < poolSize; i++){
+		int slot = (nextWorker + i) % poolSize;
+		if (!workers[slot].busy){
+			nextWorker = (slot + 1) % poolSize;
+			workers[slot].type = type;
+			workers[slot].binary = binary;
+			workers[slot].program = program;
+			// facts are sent as program text since atoms added to the registry after the fork are unknown to the worker
+			workers[slot].facts = AnswerFormat::formatFacts(facts);
+			sendJob(slot);
+			return slot;
+		}
+	}
+	throw PluginError("All solver workers are busy");
+}
+
+// waits for the answer of a job in the worker's format; returns true if the answer is binary
+bool WorkerPool::finishJob(int slot, std::string& result){
+	assert(slot >= 0 && slot < poolSize && workers[slot].busy);
+
+	std::string error;
+	if (!receiveAnswer(slot, result, error)){
+		// worker crashed: restart it and repeat the job once
+		stopWorker(slot, true);
+		sendJob(slot);
+		if (!receiveAnswer(slot, result, error)){
+			stopWorker(slot, true);
+			throw PluginError("Solver worker crashed while evaluating a nested program");
+		}
+	}
+	bool binary = workers[slot].binary;
+	workers[slot].busy = false;
+	workers[slot].program.clear();
+	workers[slot].facts.clear();
+
+	// recycle workers after some jobs to keep their registries small
+	if (++workers[slot].jobs >= maxJobsPerWorker){
+		stopWorker(slot, false);
+	}
+
+	if (error.length() > 0){
+		throw PluginError(std::string("Nested program failed in solver worker: ") + error);
+	}
+	return binary;
+}
+
+void WorkerPool::collectText(int slot, std::ostream& answer){
+	std::string result;
+	if (finishJob(slot, result)){
+		HexAnswer decoded;
+		BinaryAnswerReader(result).read(ctx->registry(), decoded);
+		BOOST_FOREACH (InterpretationPtr intr, decoded){
+			answer << AnswerFormat::formatAnswerSet(intr) << std::endl;
+		}
+	}else{
+		answer << result;
+	}
+}
+
+void WorkerPool::collect(int slot, HexAnswer& answer){
+	std::string result;
+	if (finishJob(slot, result)){
+		BinaryAnswerReader(result).read(ctx->registry(), answer);
+	}else{
+		std::stringstream text(result);
+		DLVResultParser parser(ctx->registry());
+		parser.parse(text, HexAnswerAdder(answer));
+	}
+}
+
+void WorkerPool::solveText(JobType type, std::string program, std::ostream& answer){
+	collectText(submitJob(type, program, InterpretationConstPtr(), false), answer);
+}
+
+void WorkerPool::solve(JobType type, std::string program, InterpretationConstPtr facts, HexAnswer& answer){
+	collect(submit(type, program, facts), answer);
+}